@@ -8,6 +8,16 @@
 #include "SessionController.h"
 #include "MenuController.h"
 #include "Buzzer.h"
+#include "ProfileStore.h"
+#include "ResumeJournal.h"
+#include "TelemetryRecorder.h"
+#include "SessionArchive.h"
+#include "ConfigStore.h"
+#include "WriteBehind.h"
+#include "NetService.h"
+#include "LoopHistogram.h"
+#include "ModuleProfiler.h"
+#include "Scheduler.h"
 
 class App {
 public:
@@ -16,8 +26,13 @@ public:
   
   static App* instance;
   static void buzzerTestCallback();
+  static void resumeCallback(bool accept);
+  static void sessionEndCallback(const SessionSummary& s);
+  static void fillStatus(Status& st);
 
 private:
+  friend struct AppBench;   // host benchmarks (test/test_bench)
+
   Inputs _in;
   Ui _ui;
   TempSensor _temp;
@@ -25,6 +40,31 @@ private:
   SessionController _session;
   MenuController _menu;
   Buzzer _buzzer;
+  ProfileStore _profiles;
+  ResumeJournal _journal;
+  TelemetryRecorder _telemetry;
+  SessionArchive _archive;
+  ConfigStore _config;
+  PersistentConfig _cfg;
+  WriteBehind _writeBehind;
+  int8_t _profileIdx = -1;       // active profile _profileCrc belongs to
+  uint32_t _profileCrc = 0;
+  NetService _net;
+
+  // Loop pass period (start to start) - what the motor ramp and UI see
+  LoopHistogram _loopHist;
+  uint64_t _lastTickUs = 0;
+  // ...what it is spent on, and the tasks that make it up
+  ModuleProfiler _prof;
+  Scheduler _sched;
+  InputsSnapshot _inputs;        // latest, for the menu and the UI
+
+  // Serial console
+  char _cmd[24] = "";
+  uint8_t _cmdLen = 0;
+  bool _csvExport = false;
+  TelemetryCursor _csvCursor;
+  static constexpr uint16_t CSV_LINES_PER_TICK = 4;  // keep the loop responsive
 
   UiModel _uiModel{};
   
@@ -32,7 +72,23 @@ private:
   int8_t _prevStep = -1;
   bool _prevRunning = false;
   bool _prevPaused = false;
+  bool _prevInProgress = false;
 
+  void addTasks();
+  void runSession();
+  void runMenu();
+  void runTemp();
+  void runRecord();
+  void runUi();
   void updateUiModel(const InputsSnapshot& s);
+  void applyDeviceSettings();
+  void noteSettingsEdits();
+  void flushSettings();
+  void applyCommands();
+  CmdError applyCommand(const Command& c);
   void checkBuzzerEvents();
+  void recordTelemetry();
+  void pollSerial();
+  void runCommand(const char* cmd);
+  void printHistory(const char* arg);
 };
@@ -1,5 +1,8 @@
 #pragma once
 #include <Arduino.h>
+#include "Clock.h"
+#include "HardwareSettings.h"
+#include "ToneBackend.h"
 
 enum class AlertType : uint8_t {
   None = 0,
@@ -8,20 +11,17 @@ enum class AlertType : uint8_t {
   TempWarning     // Fast intermittent beeping (repeating)
 };
 
-struct BuzzerSettings {
-  bool enabled = true;           // Master enable
-  bool onStepFinished = true;    // Beep when step ends
-  bool onProcessEnded = true;    // Beep when process ends
-  bool onTempWarning = true;     // Beep on temp alarm
-  uint16_t freqHz = 2200;        // Tone frequency (800-4000)
-};
-
+// Alert patterns on an active (on/off) or passive (driven tone) buzzer. The
+// tone comes from the target's hardware backend (LEDC on ESP32); tones it
+// can't make, and every tone on ESP8266, are toggled in software from tick().
 class Buzzer {
 public:
   struct Config {
     uint8_t pin = 255;
     bool activeHigh = true;
     uint16_t freqHz = 2200;     // for passive buzzer
+    uint8_t dutyPct = 50;       // passive: share of the period driven
+    uint8_t warnDutyPct = 25;   // TempWarning: harsher, thinner tone
     uint16_t shortMs = 50;      // short beep duration
     uint16_t longMs = 300;      // long beep duration
     uint16_t gapMs = 100;       // gap between beeps
@@ -31,18 +31,31 @@ public:
 
   void begin(const Config& cfg) {
     _cfg = cfg;
-    if (_cfg.pin == 255) return;
-    pinMode(_cfg.pin, OUTPUT);
-    off();
+    if (!_tone) _tone = defaultBackend();
+    setupPin();
   }
 
+  // Before begin(); the default is the target's hardware backend
+  void setBackend(ToneBackend* tone) { _tone = tone; }
+
   void setSettings(const BuzzerSettings& s) {
     _settings = s;
     _cfg.freqHz = s.freqHz;
   }
   
-  void setActiveHigh(bool high) { _cfg.activeHigh = high; }
+  void setActiveHigh(bool high) {
+    if (high == _cfg.activeHigh) return;
+    _cfg.activeHigh = high;
+    setupPin();
+  }
   bool activeHigh() const { return _cfg.activeHigh; }
+
+  void setType(BuzzerType type) {
+    if (type == _type) return;
+    off();
+    _type = type;
+  }
+  BuzzerType type() const { return _type; }
   
   BuzzerSettings& settings() { return _settings; }
   const BuzzerSettings& settings() const { return _settings; }
@@ -57,7 +70,7 @@ public:
     
     _alertType = type;
     _alertStep = 0;
-    _nextActionMs = millis();
+    _nextActionMs = sysClock.nowMs();
   }
   
   void stopAlert() {
@@ -71,25 +84,15 @@ public:
     on();
     _alertType = AlertType::StepFinished;
     _alertStep = 1;  // Already on, next tick will turn off
-    _nextActionMs = millis() + _cfg.shortMs;
+    _nextActionMs = sysClock.nowMs() + _cfg.shortMs;
   }
 
   void tick() {
-    // Handle software PWM for passive buzzer on ESP8266
-#if !defined(ESP32)
-    if (_toneOn) {
-      uint32_t now = micros();
-      if ((int32_t)(now - _nextToggleUs) >= 0) {
-        _pinHigh = !_pinHigh;
-        digitalWrite(_cfg.pin, _pinHigh ? HIGH : LOW);
-        _nextToggleUs = now + _halfPeriodUs;
-      }
-    }
-#endif
+    if (_active && _active->needsPoll()) _active->poll();
 
     if (_alertType == AlertType::None) return;
     
-    uint32_t now = millis();
+    uint32_t now = sysClock.nowMs();
     if ((int32_t)(now - _nextActionMs) < 0) return;
     
     switch (_alertType) {
@@ -125,7 +128,7 @@ public:
       case AlertType::TempWarning:
         // Fast repeating beeps (continues until stopAlert)
         if (_alertStep % 2 == 0) {
-          on();
+          on(_cfg.warnDutyPct);
           _nextActionMs = now + _cfg.fastMs;
         } else {
           off();
@@ -144,25 +147,40 @@ public:
   AlertType currentAlert() const { return _alertType; }
 
 private:
-  void on() {
-#if defined(ESP32)
-    digitalWrite(_cfg.pin, _cfg.activeHigh ? HIGH : LOW);
-#else
-    // Software PWM for ESP8266 - avoids Timer1 conflict with StepperISR
-    _halfPeriodUs = 500000UL / _cfg.freqHz;  // half period in microseconds
-    _nextToggleUs = micros();
-    _pinHigh = true;
-    _toneOn = true;
-    digitalWrite(_cfg.pin, HIGH);
-#endif
+  void setupPin() {
+    if (_cfg.pin == 255) return;
+    _active = nullptr;
+    _tone->begin(_cfg.pin, _cfg.activeHigh);
+    if (_tone != &_soft) _soft.begin(_cfg.pin, _cfg.activeHigh);
+    off();
+  }
+
+  void on() { on(_cfg.dutyPct); }
+  void on(uint8_t dutyPct) {
+    if (_type == BuzzerType::Active) {
+      digitalWrite(_cfg.pin, _cfg.activeHigh ? HIGH : LOW);
+      return;
+    }
+    if (_active) _active->stop();
+    if (_tone->start(_cfg.freqHz, dutyPct)) _active = _tone;
+    else if (_tone != &_soft && _soft.start(_cfg.freqHz, dutyPct)) _active = &_soft;
+    else _active = nullptr;
   }
 
   void off() {
+    if (_active) {
+      _active->stop();
+      _active = nullptr;
+    } else {
+      digitalWrite(_cfg.pin, _cfg.activeHigh ? LOW : HIGH);
+    }
+  }
+
+  ToneBackend* defaultBackend() {
 #if defined(ESP32)
-    digitalWrite(_cfg.pin, _cfg.activeHigh ? LOW : HIGH);
+    return &_hw;
 #else
-    _toneOn = false;
-    digitalWrite(_cfg.pin, _cfg.activeHigh ? LOW : HIGH);
+    return &_soft;
 #endif
   }
 
@@ -172,11 +190,12 @@ private:
   uint8_t _alertStep = 0;
   uint32_t _nextActionMs = 0;
   
-  // Software PWM state for ESP8266
-#if !defined(ESP32)
-  bool _toneOn = false;
-  bool _pinHigh = false;
-  uint32_t _halfPeriodUs = 227;  // ~2200Hz default
-  uint32_t _nextToggleUs = 0;
+  BuzzerType _type = BuzzerType::Passive;
+
+  SoftTone _soft;             // fallback, and the only backend on ESP8266
+#if defined(ESP32)
+  LedcTone _hw;
 #endif
+  ToneBackend* _tone = nullptr;     // preferred backend
+  ToneBackend* _active = nullptr;   // the one sounding now
 };
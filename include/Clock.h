@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+#if defined(ESP32)
+  #include <esp_timer.h>
+#endif
+
+// Monotonic time, sampled once per App::tick. Every module reads the same
+// timestamp for the whole pass instead of calling millis()/micros() itself.
+class Clock {
+public:
+  // Read the hardware counter - call once at the top of the loop
+  void tick() {
+    _nowUs = readUs();
+    _nowMs = (uint32_t)(_nowUs / 1000);
+  }
+
+  // Live counter, for budgets and measurements inside a pass
+  static uint64_t readUs() {
+#if defined(ESP32)
+    return (uint64_t)esp_timer_get_time();
+#else
+    return micros64();  // ESP8266 core (and the native mock)
+#endif
+  }
+
+  uint64_t nowUs() const { return _nowUs; }
+  // 32-bit views for the existing (wrap-safe) interval arithmetic
+  uint32_t nowMs() const { return _nowMs; }
+  uint32_t nowUs32() const { return (uint32_t)_nowUs; }
+
+private:
+  uint64_t _nowUs = 0;
+  uint32_t _nowMs = 0;
+};
+
+extern Clock sysClock;
@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+#include "SessionController.h"
+
+// Remote commands ({"type":"cmd","cmd":"...","id":n,...} on the WebSocket)
+enum class CmdType : uint8_t {
+  Unknown,      // not parsed; only ever acked as bad_args
+  Start,        // start / resume / continue after a step
+  Pause,
+  Next,         // next step (while paused)
+  Stop,
+  SetRpm,       // rpm
+  EditStep,     // step, any of duration, rpm, name
+  LoadProfile   // index
+};
+
+enum class CmdError : uint8_t {
+  Ok,
+  Busy,         // queue full
+  BadArgs,
+  NotAllowed,   // not in this session state
+  Failed
+};
+
+// Command::fields - what an edit_step carries
+static constexpr uint8_t CF_DURATION = 0x01;
+static constexpr uint8_t CF_RPM = 0x02;
+static constexpr uint8_t CF_NAME = 0x04;
+
+struct Command {
+  CmdType type = CmdType::Unknown;
+  uint8_t client = 0;
+  uint8_t fields = 0;         // CF_*
+  int8_t step = -1;
+  int8_t index = -1;          // profile
+  uint32_t id = 0;            // client's id, echoed in the ack
+  uint64_t rxUs = 0;          // when it arrived, for the ack latency
+  int32_t rpm = 0;
+  int32_t durationSec = 0;
+  char name[STEP_NAME_LEN] = "";
+};
+
+// Fixed ring between the WebSocket handler and App::applyCommands()
+class CommandQueue {
+public:
+  static constexpr uint8_t DEPTH = 8;
+
+  bool push(const Command& c) {
+    if (_count >= DEPTH) return false;
+    _items[(_head + _count) % DEPTH] = c;
+    _count++;
+    return true;
+  }
+
+  bool pop(Command& out) {
+    if (_count == 0) return false;
+    out = _items[_head];
+    _head = (_head + 1) % DEPTH;
+    _count--;
+    return true;
+  }
+
+  uint8_t size() const { return _count; }
+
+private:
+  Command _items[DEPTH];
+  uint8_t _head = 0;
+  uint8_t _count = 0;
+};
@@ -3,6 +3,7 @@
 
 // Device
 constexpr const char* DEVICE_NAME = "DIY-JOBO";
+constexpr const char* FW_VERSION = "0.5.0";
 
 // WiFi AP fallback
 constexpr const char* WIFI_AP_SSID = "DIY-JOBO";
@@ -57,3 +58,7 @@ constexpr uint16_t UI_UPDATE_MS    = 100;   // OLED refresh rate
 constexpr uint16_t TEMP_PERIOD_MS  = 1000;  // temp read cycle
 constexpr uint16_t TEMP_CONV_MS    = 800;   // DS18B20 conversion time
 constexpr uint16_t UI_FPS_MS = 50;
+constexpr uint32_t NET_BUDGET_US = 3000;    // network servicing per loop pass
+constexpr uint32_t SLACK_CUTOFF_US = 4000;  // UI/network start only this early in a pass
+constexpr uint16_t STATUS_PUSH_MS = 1000;   // WebSocket status broadcast
+constexpr uint32_t STA_FALLBACK_MS = 20000; // STA mode: open the AP if not connected by then
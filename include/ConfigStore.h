@@ -1,6 +1,13 @@
 #pragma once
 #include "Types.h"
 
+// Device config as a binary record in two alternating slots. Each slot is
+// a header (sequence number, CRC32) plus PersistentConfig as is; save()
+// writes the slot not holding the newest copy, so a torn write leaves the
+// previous config intact. load() is one read per slot plus a memcpy.
+// Fields may only be appended to PersistentConfig (older, shorter records
+// load over the defaults); any other layout change needs FORMAT_VER bumped.
+// A /config.json from older firmware is converted on the first load.
 class ConfigStore {
 public:
   bool begin();
@@ -8,6 +15,25 @@ public:
   bool save(const PersistentConfig& cfg);
   void setDefaults(PersistentConfig& cfg);
 
+  uint32_t seq() const { return _seq; }     // of the newest record, 0 = none
+  uint32_t saves() const { return _saves; }
+
 private:
-  const char* _path = "/config.json";
+  static constexpr uint32_t MAGIC = 0x4643424A;  // "JBCF"
+  static constexpr uint16_t FORMAT_VER = 1;
+
+  struct SlotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;       // payload bytes
+    uint32_t seq;
+    uint32_t crc;        // CRC32 of seq + payload
+  };
+
+  uint32_t _seq = 0;
+  int8_t _slot = -1;     // slot holding _seq
+  uint32_t _saves = 0;
+
+  bool readSlot(uint8_t slot, PersistentConfig& out, uint32_t& seq);
+  bool loadLegacyJson(PersistentConfig& out);
 };
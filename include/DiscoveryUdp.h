@@ -1,15 +1,31 @@
 #pragma once
 #include <Arduino.h>
-#include <WiFiUdp.h>
+#if defined(ESP32)
+  #include <AsyncUDP.h>
+#else
+  #include <ESPAsyncUDP.h>
+#endif
 
+// UDP broadcast discovery plus an mDNS/DNS-SD responder. The announcement
+// is rendered once and only rebuilt when the address or name changes.
+// Probes arrive by callback (lwIP / async_udp context) and are only queued
+// there; tick() answers them, so nothing here touches state mid-update.
+// Once WebSocket clients are connected the broadcast interval doubles after
+// every announcement up to MAX_INTERVAL_MS.
 class DiscoveryUdp {
 public:
+  static constexpr uint32_t BASE_INTERVAL_MS = 1000;
+  static constexpr uint32_t MAX_INTERVAL_MS = 60000;
+
   void begin(uint16_t port, const char* deviceName, uint16_t httpPort, uint16_t wsPort, const char* fw);
   void tick();
-  void setIntervalMs(uint32_t ms) { _intervalMs = ms; }
+  void setDeviceName(const char* name);
+  // Backoff while someone is connected; back to BASE_INTERVAL_MS when none
+  void setClientsConnected(bool any);
+  uint32_t intervalMs() const { return _intervalMs; }
 
 private:
-  WiFiUDP _udp;
+  AsyncUDP _udp;
   uint16_t _port = 0;
 
   const char* _deviceName = "DIY-JOBO";
@@ -17,11 +33,33 @@ private:
   uint16_t _httpPort = 80;
   uint16_t _wsPort   = 81;
 
-  uint32_t _intervalMs = 1000;
+  // Pre-rendered announcement and the address it was rendered for
+  char _msg[96] = "";
+  uint8_t _msgLen = 0;
+  IPAddress _msgIp;
+  bool _msgDirty = true;
+
+  uint32_t _intervalMs = BASE_INTERVAL_MS;
   uint32_t _lastMs = 0;
+  bool _backoff = false;
+
+  // Probes waiting for a reply, filled by the receive callback
+  struct Probe {
+    IPAddress ip;
+    uint16_t port;
+  };
+  static constexpr uint8_t PROBES = 4;
+  Probe _probes[PROBES];
+  volatile uint8_t _probeHead = 0;   // written by the callback
+  volatile uint8_t _probeTail = 0;   // written by tick()
+
+  bool _mdns = false;
 
-  void sendAnnounce();
-  void handleIncoming();
+  void onPacket(AsyncUDPPacket& packet);
+  void sendAnnounce(const IPAddress& bc);
+  void answerProbes();
+  void refreshMessage(const IPAddress& ip);
+  void startMdns();
 
   bool getActiveIpAndBroadcast(IPAddress& ip, IPAddress& bc);
 };
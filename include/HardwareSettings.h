@@ -30,3 +30,12 @@ struct HardwareSettings {
     return (uint32_t)stepsPerRev * microsteps;
   }
 };
+
+// Buzzer events (menu: Buzzer)
+struct BuzzerSettings {
+  bool enabled = true;           // Master enable
+  bool onStepFinished = true;    // Beep when step ends
+  bool onProcessEnded = true;    // Beep when process ends
+  bool onTempWarning = true;     // Beep on temp alarm
+  uint16_t freqHz = 2200;        // Tone frequency (800-4000)
+};
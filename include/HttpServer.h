@@ -0,0 +1,87 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#if defined(ESP32)
+  #include <WiFi.h>
+#else
+  #include <ESP8266WiFi.h>
+#endif
+#include "TelemetryRecorder.h"
+
+// Minimal static file server for the web UI. Serves only the pre-gzipped
+// assets under /www (packed by scripts/pack_www.py) with Content-Encoding:
+// gzip and a strong ETag (CRC32 of the file, computed once at begin()), so
+// a repeat load is a 304. Connections are state machines advanced by
+// service(): the file goes out in CHUNK-byte pieces only when the socket
+// has room, so a page load never holds the loop or buffers a file in RAM.
+// GET /telemetry.csv streams the session recording the same way, a few
+// lines per pass.
+class HttpServer {
+public:
+  static constexpr uint8_t MAX_CONN = 2;
+  static constexpr uint8_t MAX_ASSETS = 12;
+  static constexpr uint16_t CHUNK = 512;
+  static constexpr uint16_t REQUEST_TIMEOUT_MS = 3000;
+  static constexpr uint16_t SEND_TIMEOUT_MS = 30000;
+  // HTML is always revalidated (a firmware update shows up on reload);
+  // scripts and styles are reused for a day without asking
+  static constexpr uint32_t ASSET_MAX_AGE_S = 86400;
+  // Room a CSV line needs: a row with a "# gap" before it, or the header
+  static constexpr uint8_t CSV_LINE_BYTES = 96;
+
+  HttpServer(uint16_t port) : _server(port) {}
+  void begin();      // LittleFS must be mounted
+  void service();
+  void setTelemetry(TelemetryRecorder* t) { _telemetry = t; }  // enables /telemetry.csv
+
+  uint8_t assets() const { return _assetCount; }
+  uint32_t served() const { return _served; }
+  uint32_t notModified() const { return _notModified; }
+
+private:
+  struct Asset {
+    char url[24];           // "/index.html"; the file is /www<url>.gz
+    uint32_t etag;          // CRC32 of the gzipped file
+    uint32_t size;
+  };
+
+  enum class State : uint8_t { Idle, Request, Sending };
+  struct Conn {
+    State state = State::Idle;
+    WiFiClient client;
+    File file;
+    uint32_t startMs = 0;
+    uint32_t left = 0;      // file bytes still to send
+    bool csv = false;       // streaming the recording instead of a file
+    TelemetryCursor cursor;
+    char line[96];
+    uint8_t lineLen = 0;
+    bool firstLine = true;
+    bool isGet = false;
+    char path[24];
+    uint32_t ifNoneMatch = 0;
+    bool hasIfNoneMatch = false;
+  };
+
+  WiFiServer _server;
+  Conn _conn[MAX_CONN];
+  Asset _assets[MAX_ASSETS];
+  uint8_t _assetCount = 0;
+  uint8_t _buf[CHUNK];      // shared: one chunk is read and written at a time
+  uint32_t _served = 0;
+  uint32_t _notModified = 0;
+  TelemetryRecorder* _telemetry = nullptr;
+
+  void addAsset(const char* name, File& f);
+  void accept();
+  void readRequest(Conn& c);
+  void parseLine(Conn& c);
+  void respond(Conn& c);
+  void sendFile(Conn& c);
+  void sendCsv(Conn& c);
+  void sendEmpty(Conn& c, const char* status);
+  void close(Conn& c);
+  const Asset* find(const char* path) const;
+  static const char* contentType(const char* url);
+  static size_t writable(WiFiClient& client);
+};
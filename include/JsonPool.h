@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// ArduinoJson allocator over a caller-owned buffer, for documents that are
+// parsed, used and dropped in one go. Blocks are handed out bottom-up; only
+// the newest one can grow or be given back in place, the rest is reclaimed
+// by reset(). When the buffer is full allocate() fails and the parse ends
+// with NoMemory instead of touching the heap.
+class JsonPool : public ArduinoJson::Allocator {
+public:
+  JsonPool(uint8_t* buf, size_t size) : _buf(buf), _size(size) {}
+
+  void* allocate(size_t size) override;
+  void deallocate(void* ptr) override;
+  void* reallocate(void* ptr, size_t newSize) override;
+
+  // Drops every block; only once no document uses the pool any more
+  void reset() { _used = 0; _last = nullptr; }
+
+  size_t used() const { return _used; }
+  size_t peak() const { return _peak; }        // high-water mark since boot
+  uint32_t failures() const { return _failures; }
+
+private:
+  static constexpr size_t ALIGN = 8;
+  static constexpr size_t HEADER = ALIGN;      // block size, kept in front
+
+  uint8_t* _buf;
+  size_t _size;
+  size_t _used = 0;
+  size_t _peak = 0;
+  uint32_t _failures = 0;
+  uint8_t* _last = nullptr;                    // newest block, grows in place
+
+  static size_t round(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+  static size_t& blockSize(void* p) { return *(size_t*)((uint8_t*)p - HEADER); }
+};
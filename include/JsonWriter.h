@@ -0,0 +1,47 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Builds JSON into a caller-owned buffer. No heap, no printf: numbers are
+// formatted by hand, floats as fixed point. Writing past the end sets the
+// overflow flag and drops the rest - check ok() before sending.
+class JsonWriter {
+public:
+  JsonWriter(char* buf, size_t cap);
+
+  JsonWriter& beginObject(const char* key = nullptr) { return open('{', key); }
+  JsonWriter& endObject() { return close('}'); }
+  JsonWriter& beginArray(const char* key = nullptr) { return open('[', key); }
+  JsonWriter& endArray() { return close(']'); }
+  JsonWriter& item(const char* v);   // array element
+
+  JsonWriter& field(const char* key, const char* v);   // nullptr -> null
+  JsonWriter& field(const char* key, bool v);
+  JsonWriter& field(const char* key, int v) { return field(key, (long)v); }
+  JsonWriter& field(const char* key, unsigned v) { return field(key, (unsigned long)v); }
+  JsonWriter& field(const char* key, long v);
+  JsonWriter& field(const char* key, unsigned long v);
+  JsonWriter& field(const char* key, float v, uint8_t decimals = 2);  // NAN -> null
+
+  bool ok() const { return !_overflow; }
+  size_t length() const { return _len; }
+  const char* c_str() const { return _buf; }
+
+private:
+  char* _buf;
+  size_t _cap;
+  size_t _len = 0;
+  bool _overflow = false;
+  uint8_t _depth = 0;
+  uint16_t _hasItems = 0;   // bit per nesting level: a comma is due
+
+  void put(char c);
+  void put(const char* s);
+  void putString(const char* s);
+  void putUnsigned(unsigned long v);
+  void key(const char* k);
+  JsonWriter& open(char bracket, const char* k);
+  JsonWriter& close(char bracket);
+
+  static constexpr uint8_t MAX_DEPTH = 15;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <Arduino.h>
+
+// Distribution of loop pass times, power-of-two buckets from <64 us to
+// >=64 ms. Recording is a shift loop and an increment.
+class LoopHistogram {
+public:
+  static constexpr uint8_t BUCKETS = 12;
+  static constexpr uint8_t FIRST_SHIFT = 6;  // bucket 0: < 64 us
+
+  void record(uint32_t us);
+  void reset();
+  void print(Print& out) const;
+
+  uint32_t count() const { return _count; }
+  uint32_t maxUs() const { return _maxUs; }
+  // Smallest bucket bound that covers the given share (0..1) of the passes
+  uint32_t percentileUs(float p) const;
+
+private:
+  uint32_t _buckets[BUCKETS] = {0};
+  uint32_t _count = 0;
+  uint32_t _maxUs = 0;
+  uint64_t _sumUs = 0;
+
+  static uint32_t upperBoundUs(uint8_t b) { return 1UL << (FIRST_SHIFT + b); }
+};
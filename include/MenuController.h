@@ -3,12 +3,13 @@
 #include "Inputs.h"
 #include "SessionController.h"
 #include "HardwareSettings.h"
+#include "ProfileStore.h"
 
 enum class Screen : uint8_t {
   Main,
   Menu,
   // Profile submenu (development profile)
-  ProfileMenu,         // Profile selection (Custom for now, future: Default, Profile1, etc.)
+  ProfileMenu,         // Profile library: current settings, saved profiles, save
   ProfileEditMenu,     // Settings/Steps for selected profile
   ProfileSettingsMenu, // Profile-level settings (TempCoef, TempLimits, etc.)
   StepsMenu,           // List of steps
@@ -57,12 +58,17 @@ enum class Screen : uint8_t {
   EditMotorInvert,
   EditBuzzerType,
   EditBuzzerActiveHigh,
-  EditTempOffset
+  EditTempOffset,
+  // Hidden: long press in the hardware menu
+  Diagnostics,
+  // Boot: interrupted session found
+  ResumePrompt
 };
 
 class MenuController {
 public:
   void begin(SessionController* session);
+  void setProfileStore(ProfileStore* store) { _profiles = store; }
   
   bool handleInput(const InputsSnapshot& s);
   
@@ -70,6 +76,8 @@ public:
   Screen screen() const { return _screen; }
   int8_t menuIdx() const { return _menuIdx; }
   int8_t subMenuIdx() const { return _subMenuIdx; }
+  int8_t activeProfile() const { return _activeProfile; }  // -1 = unsaved
+  void setActiveProfile(int8_t idx) { _activeProfile = idx; }  // loaded from elsewhere
   
   // Edit values for UI display
   int32_t editStepDuration() const { return _editStepDuration; }
@@ -106,17 +114,27 @@ public:
   BuzzerType editBuzzerType() const { return _editBuzzerType; }
   bool editBuzzerActiveHigh() const { return _editBuzzerActiveHigh; }
   float editTempOffset() const { return _editTempOffset; }
+  // Diagnostics: first profiler section shown
+  int8_t diagScroll() const { return _diagScroll; }
+  static constexpr int8_t DIAG_ROWS = 5;
   
-  // Hardware settings storage (owned by MenuController for now)
+  // Hardware settings storage (owned by MenuController, persisted by App)
   HardwareSettings& hwSettings() { return _hwSettings; }
   const HardwareSettings& hwSettings() const { return _hwSettings; }
+  BuzzerSettings buzzerSettings() const;
+  void setBuzzerSettings(const BuzzerSettings& bs);
   
   // Callback for buzzer test (set by App)
   void setBuzzerTestCallback(void (*cb)()) { _buzzerTestCb = cb; }
   void setHardwareChangedCallback(void (*cb)()) { _hwChangedCb = cb; }
+  // Resume prompt answer (true = resume)
+  void setResumeCallback(void (*cb)(bool)) { _resumeCb = cb; }
+  void showResumePrompt() { _screen = Screen::ResumePrompt; }
 
 private:
   SessionController* _session = nullptr;
+  ProfileStore* _profiles = nullptr;
+  int8_t _activeProfile = -1;  // library index the settings came from
   
   Screen _screen = Screen::Main;
   int8_t _menuIdx = 0;
@@ -160,6 +178,7 @@ private:
   BuzzerType _editBuzzerType = BuzzerType::Passive;
   bool _editBuzzerActiveHigh = true;
   float _editTempOffset = 0.0f;
+  int8_t _diagScroll = 0;
 
   static constexpr int RPM_MIN = 1;
   static constexpr int RPM_MAX = 80;
@@ -170,6 +189,7 @@ private:
   void handleProfileMenu(const InputsSnapshot& s);
   void handleProfileEditMenu(const InputsSnapshot& s);
   void handleProfileSettingsMenu(const InputsSnapshot& s);
+  void saveCurrentProfile();
   void handleStepsMenu(const InputsSnapshot& s);
   void handleStepDetailMenu(const InputsSnapshot& s);
   bool handleEditStepDuration(const InputsSnapshot& s);
@@ -218,7 +238,11 @@ private:
   bool handleEditBuzzerType(const InputsSnapshot& s);
   bool handleEditBuzzerActiveHigh(const InputsSnapshot& s);
   bool handleEditTempOffset(const InputsSnapshot& s);
+  // Boot
+  void handleResumePrompt(const InputsSnapshot& s);
+  void handleDiagnostics(const InputsSnapshot& s);
   
   void (*_buzzerTestCb)() = nullptr;
   void (*_hwChangedCb)() = nullptr;
+  void (*_resumeCb)(bool) = nullptr;
 };
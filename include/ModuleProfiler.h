@@ -0,0 +1,81 @@
+#pragma once
+#include <Arduino.h>
+#include "Clock.h"
+
+// Sections of App::tick, in loop order
+enum ProfSection : uint8_t {
+  PS_INPUT,     // Inputs
+  PS_MENU,      // MenuController + remote commands
+  PS_TEMP,      // TempSensor
+  PS_SESSION,   // SessionController
+  PS_RECORD,    // journal + telemetry
+  PS_BUZZER,
+  PS_STORE,     // settings apply / write-behind flush
+  PS_UI,        // model + draw + frame push
+  PS_CONSOLE,   // Serial console
+  PS_NET,
+  PS_COUNT
+};
+
+// Where the loop time goes, per section, from the CPU cycle counter. The
+// scheduler hands in the cycles of every task run (it reads the counter
+// once per task anyway). Each section keeps min/mean/max and a power-of-two
+// histogram (< 2 us .. >= 32 ms) of its runs in the current window; a window
+// closes after WINDOW_MS (or MAX_RUNS) and is then what stats() and print()
+// report, so the figures always cover the last few seconds.
+class ModuleProfiler {
+public:
+  static constexpr uint8_t BUCKETS = 16;
+  static constexpr uint32_t WINDOW_MS = 5000;
+  static constexpr uint16_t MAX_RUNS = 60000;   // bucket counts are 16-bit
+
+  struct Stats {
+    uint32_t runs = 0;
+    uint32_t minUs = 0;
+    uint32_t meanUs = 0;
+    uint32_t p99Us = 0;
+    uint32_t maxUs = 0;
+  };
+
+  void begin();
+
+  void record(ProfSection s, uint32_t cyc);
+  void endPass();   // closes the window when it is due
+
+  // Last complete window
+  Stats stats(ProfSection s) const;
+  uint32_t windowMs() const { return _lastWindowMs; }
+  uint32_t windowPasses() const { return _lastPasses; }
+  bool ready() const { return _lastWindowMs != 0; }
+  void print(Print& out) const;
+
+  uint32_t cyclesToUs(uint64_t cyc) const { return (uint32_t)(cyc / _cyclesPerUs); }
+  static const char* name(ProfSection s);
+  static uint32_t cycles() {
+#if defined(ESP32) || defined(ESP8266)
+    return ESP.getCycleCount();
+#else
+    return (uint32_t)Clock::readUs();   // host: 1 "cycle" per us
+#endif
+  }
+
+private:
+  struct Section {
+    uint32_t runs = 0;
+    uint32_t minCyc = UINT32_MAX;
+    uint32_t maxCyc = 0;
+    uint64_t sumCyc = 0;
+    uint16_t buckets[BUCKETS] = {0};
+  };
+
+  Section _cur[PS_COUNT];
+  Section _last[PS_COUNT];
+  uint32_t _cyclesPerUs = 1;
+  uint32_t _windowStartMs = 0;
+  uint32_t _lastWindowMs = 0;
+  uint32_t _passes = 0;
+  uint32_t _lastPasses = 0;
+  uint32_t _maxRuns = 0;    // busiest section in the current window
+
+  static uint32_t upperBoundUs(uint8_t b) { return 2UL << b; }
+};
@@ -18,6 +18,7 @@ public:
   void setTargetRpm(float rpm);     // 0..clamped
   void setReverseEnabled(bool en);
   void setReverseEverySec(float sec);
+  void setStartDir(bool fwd) { _startFwd = fwd; }  // next start only (resume)
   
   // Hardware config
   void setStepsPerRev(int steps) { _cfg.stepsPerRev = steps; }
@@ -29,23 +30,26 @@ public:
 
   float currentRpm() const { return _currentRpm; }
   bool  dirFwd() const { return _dirFwd; }
+  uint32_t reversals() const { return _reversals; }  // since boot
 
 private:
   MotorConfig _cfg{};
 
   bool  _run = false;
   bool  _dirFwd = true;
+  bool  _startFwd = true;
 
   float _targetRpm  = 0.0f; // user target
   float _currentRpm = 0.0f; // ramped
 
-  uint32_t _lastUs = 0;
+  uint64_t _lastUs = 0;
 
   // soft reverse state machine
   enum RevState { RS_RUN, RS_RAMP_DOWN, RS_SWITCH_DIR, RS_RAMP_UP };
   RevState _rs = RS_RUN;
   float _savedTarget = 0.0f;
   uint32_t _lastReverseMs = 0;
+  uint32_t _reversals = 0;
 
   float rpmToSps(float rpm) const;
 };
@@ -0,0 +1,114 @@
+#pragma once
+#include <Arduino.h>
+#include <WebSocketsServer.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+#include "Clock.h"
+#include "Types.h"
+#include "Protocol.h"
+#include "WsServer.h"
+#include "DiscoveryUdp.h"
+#include "HttpServer.h"
+#include "CommandQueue.h"
+#include "TelemetryStream.h"
+#include "JsonPool.h"
+
+// WiFi (per WifiConfig), WebSocket server, web UI and discovery, serviced in
+// round-robin slices. Frames are queued per client and written by the TX
+// task only when the socket has room. service() runs tasks until the budget is used up and
+// the next call starts with the task that was cut off, so networking never
+// holds the loop for much longer than one task.
+class NetService {
+public:
+  NetService() : _wsServer(WS_PORT), _ws(_wsServer), _http(HTTP_PORT) {}
+
+  void begin(const WifiConfig& cfg, void (*fillStatus)(Status&));
+  void service(uint32_t budgetUs);
+
+  bool staConnected() const { return _staUp; }
+  bool apActive() const { return _apUp; }
+  uint8_t clients() const;
+  uint32_t yields() const { return _yields; }        // passes cut short by the budget
+  uint32_t maxTaskUs() const { return _maxTaskUs; }  // longest single task
+  void resetStats() { _yields = 0; _maxTaskUs = 0; }
+  // Per-client send queue metrics
+  bool clientConnected(uint8_t num) const { return num < MAX_CLIENTS && _clients[num].connected; }
+  const WsServer::QueueStats& queueStats(uint8_t num) const { return _ws.stats(num); }
+  static constexpr uint8_t maxClients() { return MAX_CLIENTS; }
+
+  // Remote commands, applied by App at one point of the loop pass; each
+  // popped command must be answered with ackCommand()
+  bool popCommand(Command& out) { return _cmds.pop(out); }
+  void ackCommand(const Command& c, CmdError err);
+
+  // Telemetry stream for clients that sent {"type":"tlm","hz":n}; App
+  // samples when due and the frames go out as they fill
+  bool telemetryDue() const { return _tlm.due(sysClock.nowMs()); }
+  void addTelemetry(const TelemetrySample& s);
+  uint8_t telemetryHz() const { return _tlm.rateHz(); }
+  // Session recording served as /telemetry.csv
+  void setRecorder(TelemetryRecorder* rec) { _http.setTelemetry(rec); }
+  const HttpServer& http() const { return _http; }
+
+private:
+  enum Task : uint8_t { T_WIFI, T_WS, T_DISCOVERY, T_STATUS, T_TX, T_HTTP, T_COUNT };
+  static constexpr uint8_t MAX_CLIENTS = WsServer::MAX_CLIENTS;
+
+  struct Client {
+    bool connected = false;
+    WireEnc enc = WireEnc::Json;  // chosen in the client's hello
+    // Subscription; groups == 0 = full status every STATUS_PUSH_MS
+    uint8_t groups = 0;
+    bool needKey = true;
+    uint16_t periodMs = 0;
+    uint32_t lastSentMs = 0;
+    uint32_t lastKeyMs = 0;
+    uint32_t seq = 0;
+    StatusValues sent;            // values as of the last frame
+    uint8_t tlmHz = 0;            // telemetry stream requested, 0 = off
+  };
+
+  WsTransport _wsServer;
+  WsServer _ws;
+  DiscoveryUdp _discovery;
+  HttpServer _http;
+  WifiConfig _cfg;
+  void (*_fillStatus)(Status&) = nullptr;
+
+  uint8_t _next = T_WIFI;
+  bool _started = false;
+  bool _staUp = false;
+  bool _apUp = false;
+  Client _clients[MAX_CLIENTS];
+  CommandQueue _cmds;
+  TelemetryStream _tlm;
+  JsonDocument _filter;           // built once in begin()
+  // Incoming messages are parsed into a fixed pool, never the heap: room
+  // for one pool of ArduinoJson slots plus the strings the filter keeps
+  static constexpr size_t RX_POOL_BYTES = ARDUINOJSON_POOL_CAPACITY * 4 * sizeof(void*) + 512;
+  alignas(8) uint8_t _rxBuf[RX_POOL_BYTES];
+  JsonPool _rxPool{_rxBuf, sizeof(_rxBuf)};
+  uint32_t _staStartMs = 0;
+  uint32_t _lastWifiMs = 0;
+  uint32_t _lastStatusMs = 0;
+  uint32_t _yields = 0;
+  uint32_t _maxTaskUs = 0;
+
+  void runTask(uint8_t t);
+  void startAp();
+  void checkWifi();
+  void pushStatus();
+  void sendStatus(const Status& st, int8_t only);  // full status; -1 = unsubscribed clients
+  void sendDeltas(const Status& st, uint32_t now);
+  void handleText(uint8_t num, const uint8_t* payload, size_t len);
+  void updateTelemetryRate();
+  void handleCommand(uint8_t num, JsonDocument& doc, uint64_t rxUs);
+
+  static NetService* s_self;
+  static void onWsEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t len);
+
+  static constexpr uint16_t WIFI_CHECK_MS = 500;
+  static constexpr uint16_t MIN_SUB_PERIOD_MS = 100;   // 10 Hz max
+  static constexpr uint16_t MAX_SUB_PERIOD_MS = 60000;
+  static constexpr uint32_t KEYFRAME_MS = 10000;       // full frame for resync
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <Arduino.h>
+#include "SessionController.h"
+
+static constexpr uint8_t MAX_PROFILES = 8;
+
+// Directory entry: what the profile list shows, without the step table
+struct ProfileHeader {
+  char name[PROFILE_NAME_LEN] = "";
+  uint8_t slot = 0;              // file /profileN.bin
+  int8_t stepCount = 0;
+  int32_t totalDurationSec = 0;
+  uint32_t crc = 0;              // CRC32 of the profile record
+};
+
+// Profile library on LittleFS. Each profile is one fixed-layout binary file
+// (header + packed record, CRC32); /profiles.idx holds the headers so the
+// menu can list profiles without opening every file.
+class ProfileStore {
+public:
+  bool begin();  // mount + read the index (rebuilt from the files if damaged)
+
+  uint8_t count() const { return _count; }
+  const ProfileHeader& header(uint8_t idx) const { return _index[idx]; }
+
+  // One file read + CRC check; out is untouched on failure
+  bool load(uint8_t idx, SessionSettings& out);
+  // idx < 0 adds a new profile. Returns the index, or -1 if full / write failed
+  int8_t save(const SessionSettings& set, int8_t idx = -1);
+  bool remove(uint8_t idx);
+
+  // Same record format for a file outside the library (resume snapshot)
+  bool saveFile(const char* path, const SessionSettings& set, uint32_t* crcOut = nullptr);
+  bool loadFile(const char* path, SessionSettings& out, uint32_t* crcOut = nullptr);
+  // CRC32 of the record set would be saved as: padding, unused steps and
+  // anything past a name's terminator don't count
+  static uint32_t recordCrc(const SessionSettings& set);
+
+  // Timings of the last operations (micros)
+  uint32_t indexLoadUs() const { return _indexLoadUs; }
+  uint32_t lastLoadUs() const { return _lastLoadUs; }
+  uint32_t lastSaveUs() const { return _lastSaveUs; }
+
+#ifdef PROFILE_BENCH
+  // Save/load the same settings through ArduinoJson and the binary format,
+  // print both timings
+  void benchJson(const SessionSettings& set);
+#endif
+
+private:
+  ProfileHeader _index[MAX_PROFILES];
+  uint8_t _count = 0;
+  bool _mounted = false;
+
+  uint32_t _indexLoadUs = 0;
+  uint32_t _lastLoadUs = 0;
+  uint32_t _lastSaveUs = 0;
+
+  bool readIndex();
+  bool writeIndex();
+  void rebuildIndex();
+  int8_t freeSlot() const;
+};
@@ -1,6 +1,7 @@
 #pragma once
-#include <ArduinoJson.h>
 #include "Types.h"
+#include "JsonWriter.h"
+#include "CommandQueue.h"
 
 const char* stateToStr(ProcState s);
 const char* autoRevModeToStr(AutoRevMode m);
@@ -9,6 +10,144 @@ AutoRevMode autoRevModeFromStr(const char* s);
 const char* wifiModeToStr(WifiMode m);
 WifiMode wifiModeFromStr(const char* s);
 
-void buildHello(JsonDocument& doc, const char* fw);
-void buildStatus(JsonDocument& doc, const Status& st);
-void buildConfig(JsonDocument& doc, const PersistentConfig& cfg);
+// Status/config encodings; the client picks one with its own hello:
+// {"type":"hello","enc":"bin"}. Default is JSON.
+enum class WireEnc : uint8_t { Json, Bin };
+const char* wireEncToStr(WireEnc e);
+WireEnc wireEncFromStr(const char* s);
+
+// Complete messages into a caller buffer (see WsServer::writer())
+void writeHello(JsonWriter& w, const char* fw);
+void writeEncAck(JsonWriter& w, WireEnc e);
+void writeStatus(JsonWriter& w, const Status& st);
+void writeConfig(JsonWriter& w, const PersistentConfig& cfg);
+
+// Field-group subscriptions: {"type":"sub","groups":["motor","temp"],"max_hz":2}.
+// Subscribed JSON clients get {"type":"delta","seq":n,"key":false,...} with
+// only the fields that changed since their previous frame; "key":true
+// frames carry every subscribed field. Binary clients get the same as a
+// BinDelta frame.
+enum StatusGroup : uint8_t {
+  SG_MOTOR = 0x01,    // state, rpm, rpm_actual, dir, rev
+  SG_TIMER = 0x02,    // timer, step, steps, step_left, total_left
+  SG_TEMP = 0x04,     // temp
+  SG_ALARMS = 0x08,   // temp_alarm, temp_low, temp_high
+  SG_ALL = 0x0F
+};
+uint8_t statusGroupFromStr(const char* s);  // 0 = unknown
+
+enum StatusField : uint8_t {
+  SF_STATE, SF_RPM, SF_RPM_ACTUAL, SF_DIR, SF_REV,
+  SF_TIMER, SF_STEP, SF_STEPS, SF_STEP_LEFT, SF_TOTAL_LEFT,
+  SF_TEMP,
+  SF_ALARM, SF_TEMP_LOW, SF_TEMP_HIGH,
+  SF_COUNT
+};
+
+// Status quantized to what goes on the wire, for cheap change detection
+struct StatusValues {
+  int32_t v[SF_COUNT];
+};
+void captureStatus(const Status& st, StatusValues& out);
+uint32_t groupFields(uint8_t groups);  // bit per StatusField
+uint32_t changedFields(const StatusValues& a, const StatusValues& b);
+
+void writeStatusDelta(JsonWriter& w, const StatusValues& vals, uint32_t fields, uint32_t seq, bool key);
+void writeSubAck(JsonWriter& w, uint8_t groups, uint16_t periodMs);
+// {"type":"tlm","hz":n,"period_ms":n} - hz 0 = stream off
+void writeTlmAck(JsonWriter& w, uint8_t hz, uint16_t periodMs);
+
+const char* cmdTypeToStr(CmdType t);
+bool cmdTypeFromStr(const char* s, CmdType& out);
+const char* cmdErrorToStr(CmdError e);
+// {"type":"ack","id":n,"cmd":"start","ok":true,"latency_us":n} (+ "err" on failure)
+void writeCmdAck(JsonWriter& w, uint32_t id, const char* cmd, CmdError err, uint32_t latencyUs);
+
+// Binary encoding: WebSocket binary frames holding one packed little-endian
+// struct, first byte = message type. Fixed point instead of floats.
+constexpr uint8_t BIN_MSG_STATUS = 1;
+constexpr uint8_t BIN_MSG_CONFIG = 2;
+constexpr uint8_t BIN_MSG_TELEMETRY = 3;
+constexpr uint8_t BIN_MSG_DELTA = 4;
+constexpr uint8_t BIN_VERSION = 1;
+constexpr int16_t BIN_TEMP_NONE = INT16_MIN;
+
+// BinStatus::flags
+constexpr uint8_t BS_DIR_FWD = 0x01;
+constexpr uint8_t BS_REVERSING = 0x02;
+constexpr uint8_t BS_TIMER_ACTIVE = 0x04;
+constexpr uint8_t BS_TEMP_ALARM = 0x08;
+
+// BinDelta::flags
+constexpr uint8_t BD_KEY = 0x01;
+
+#pragma pack(push, 1)
+struct BinStatus {
+  uint8_t type;             // BIN_MSG_STATUS
+  uint8_t version;          // BIN_VERSION
+  uint8_t state;            // ProcState
+  uint8_t flags;            // BS_*
+  int16_t rpm;
+  uint16_t revRampMs;
+  uint16_t revPauseMs;
+  uint16_t startRampMs;
+  uint16_t stopRampMs;
+  uint8_t autoRevMode;      // AutoRevMode
+  uint8_t reserved;
+  uint16_t autoRevInterval;
+  int16_t tempCenti;        // 0.01 C, BIN_TEMP_NONE = no reading
+};
+
+struct BinConfig {
+  uint8_t type;             // BIN_MSG_CONFIG
+  uint8_t version;
+  uint8_t wifiMode;         // WifiMode
+  uint8_t apSubnet;
+  char staSsid[33];
+  int16_t rpm;
+  uint8_t dirFwd;
+  uint8_t autoRevMode;
+  uint16_t autoRevInterval;
+  uint16_t revRampMs;
+  uint16_t revPauseMs;
+  uint16_t startRampMs;
+  uint16_t stopRampMs;
+};
+
+// Telemetry stream frame: this header carries the first sample in absolute
+// values, then count-1 delta records follow (TelemetryRecorder coding).
+// Sample i is at t0Ms + i * periodMs.
+struct BinTelemetry {
+  uint8_t type;             // BIN_MSG_TELEMETRY
+  uint8_t version;
+  uint8_t count;            // samples incl. the first
+  uint8_t state;            // TS_* bits of the first sample
+  uint16_t periodMs;
+  uint32_t seq;             // frame counter - a jump means frames were dropped
+  uint32_t t0Ms;            // ms since boot
+  int16_t temp;             // 1/16 C, INT16_MIN = no reading
+  int16_t rpmTarget;        // 0.5 rpm
+  int16_t rpmActual;        // 0.5 rpm
+  int8_t step;
+  uint8_t reserved;
+};
+// Status delta: the header, then the value of each field set in fields,
+// lowest StatusField first, little-endian at the field's own width:
+// step_left and total_left int32 (s); rpm int16; rpm_actual int16 (0.1
+// rpm); temp int16 (0.01 C, BIN_TEMP_NONE = no reading); state, step,
+// steps int8; dir (1 = fwd) and the flags uint8 0/1.
+struct BinDelta {
+  uint8_t type;             // BIN_MSG_DELTA
+  uint8_t version;
+  uint8_t flags;            // BD_*
+  uint8_t reserved;
+  uint32_t seq;
+  uint16_t fields;          // bit per StatusField
+};
+#pragma pack(pop)
+
+// Return the frame length, 0 if cap is too small
+size_t encodeStatus(uint8_t* out, size_t cap, const Status& st);
+size_t encodeConfig(uint8_t* out, size_t cap, const PersistentConfig& cfg);
+size_t encodeStatusDelta(uint8_t* out, size_t cap, const StatusValues& vals, uint32_t fields,
+                         uint32_t seq, bool key);
@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+#include "SessionController.h"
+#include "ProfileStore.h"
+
+// Progress of an in-progress session, 32 bytes (RTC memory is word-addressed)
+struct JournalRecord {
+  uint32_t magic = 0;
+  uint32_t snapshotCrc = 0;   // settings snapshot this progress belongs to
+  uint64_t devUs = 0;         // development progress inside the step
+  uint32_t stampMs = 0;       // clock when written
+  int8_t step = 0;
+  uint8_t flags = 0;          // JF_* below
+  uint16_t flashWrites = 0;   // flash writes so far this session
+  uint32_t reserved = 0;
+  uint32_t crc = 0;           // CRC32 of everything above
+};
+
+// Power-loss resume. Progress goes to RTC user memory every second (survives
+// WDT/exception/brown-out resets, free to write); flash gets a checkpoint only
+// when a session starts and at step boundaries, plus a settings snapshot when
+// the settings changed since the last one. Settings edited mid-step get their
+// snapshot once the edits settle, if the budget still covers the remaining
+// step boundaries. Flash writes per session are bounded by MAX_FLASH_WRITES.
+class ResumeJournal {
+public:
+  static constexpr uint8_t JF_RUNNING = 0x01;
+  static constexpr uint8_t JF_PAUSED = 0x02;   // paused between steps
+  static constexpr uint8_t JF_DIR_FWD = 0x04;
+
+  // Looks for an interrupted session. On success the snapshot is loaded into
+  // settings and pending() holds where to continue.
+  bool begin(ProfileStore* store, SessionSettings& settings);
+  void tick(const SessionController& session, bool dirFwd);
+
+  bool hasPending() const { return _hasPending; }
+  const JournalRecord& pending() const { return _pending; }
+  // User answered the resume prompt
+  void accept(const SessionController& session);  // after SessionController::resumeAt()
+  void discard();
+
+  uint16_t flashWrites() const { return _flashWrites; }
+
+private:
+  ProfileStore* _store = nullptr;
+  JournalRecord _pending;
+  bool _hasPending = false;
+
+  bool _active = false;
+  int8_t _lastStep = -1;
+  uint32_t _snapVersion = UINT32_MAX;
+  uint32_t _snapCrc = 0;
+  uint32_t _editVersion = UINT32_MAX;  // mid-step edit waiting for a snapshot
+  uint32_t _editMs = 0;
+  uint16_t _flashWrites = 0;
+  uint32_t _lastRtcMs = 0;
+
+  void fill(JournalRecord& r, const SessionController& s, bool dirFwd) const;
+  void checkpoint(const SessionController& s, bool dirFwd);
+  void clear();
+  static void seal(JournalRecord& r);
+  static bool valid(const JournalRecord& r);
+  static bool readRtc(JournalRecord& r);
+  static void writeRtc(const JournalRecord& r);
+
+  static constexpr uint32_t RTC_PERIOD_MS = 1000;
+  static constexpr uint32_t SNAPSHOT_SETTLE_MS = 5000;  // after the last mid-step edit
+  static constexpr uint16_t MAX_FLASH_WRITES = 2 * MAX_STEPS + 1;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+#include "ModuleProfiler.h"
+
+enum class TaskPrio : uint8_t {
+  Motion,   // every due pass, first, whatever the pass has cost so far
+  Normal,   // when due
+  Slack     // when due and the pass is still under the slack cut-off
+};
+
+// Cooperative scheduler for the loop pass. Tasks (one per profiler section)
+// register a priority, a period (0 = every pass), a time budget and a
+// deadline - how late after falling due a task may start before it counts
+// as a miss. Motion tasks run first; slack tasks (UI, network) only start
+// while the pass is under the cut-off, unless they are already past their
+// deadline. So a pass runs at most one slow slack task and the motion tick
+// waits for that, not for everything at once.
+class Scheduler {
+public:
+  struct TaskStats {
+    uint32_t runs = 0;
+    uint32_t misses = 0;     // started past the deadline
+    uint32_t overruns = 0;   // ran longer than the budget
+    uint32_t deferred = 0;   // slack task held over to a later pass
+    uint32_t maxLateUs = 0;  // start after falling due
+    uint32_t maxRunUs = 0;
+  };
+
+  void begin(ModuleProfiler* prof, uint32_t slackCutoffUs);
+  void add(ProfSection id, void (*fn)(void*), void* ctx, TaskPrio prio,
+           uint32_t periodUs, uint32_t budgetUs, uint32_t deadlineUs);
+
+  // One loop pass; sysClock must have been ticked
+  void runPass();
+
+  const TaskStats& stats(ProfSection id) const { return _tasks[id].st; }
+  uint32_t idlePasses() const { return _idlePasses; }  // nothing periodic was due
+  void resetStats();
+  void print(Print& out) const;
+
+private:
+  struct Task {
+    void (*fn)(void*) = nullptr;
+    void* ctx = nullptr;
+    TaskPrio prio = TaskPrio::Normal;
+    uint32_t periodUs = 0;
+    uint32_t budgetUs = 0;
+    uint32_t deadlineUs = 0;
+    uint64_t dueUs = 0;      // periodic: next start; every pass: last start
+    TaskStats st;
+  };
+
+  Task _tasks[PS_COUNT];
+  uint8_t _order[PS_COUNT];  // by priority, then registration
+  uint8_t _count = 0;
+  ModuleProfiler* _prof = nullptr;
+  uint32_t _cutoffUs = 0;
+  uint32_t _idlePasses = 0;
+};
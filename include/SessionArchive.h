@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+#include "SessionController.h"
+
+// Index entry: enough for the history list without touching the log
+struct ArchiveEntry {
+  uint32_t id = 0;
+  uint32_t offset = 0;        // record position in the log
+  uint32_t startEpoch = 0;    // 0 = no wall clock at the time
+  int32_t actualSec = 0;      // sum of the per-step actual times
+  uint16_t size = 0;          // record bytes incl. header
+  int8_t stepsDone = 0;
+  uint8_t end = 0;            // SessionEnd
+  char name[PROFILE_NAME_LEN] = "";
+};
+
+// History of finished sessions on LittleFS. Records are appended to a log
+// (header + CRC32 + SessionSummary); a parallel index of fixed-size entries
+// is appended with each record. Ids are sequential, so an id maps straight
+// to an index position: fetch() is one index read + one log read and
+// listRecent() reads only the tail of the index. When the log passes
+// MAX_LOG_BYTES the log/index pair becomes the previous generation (the one
+// before that is deleted). Records carry magic, id and CRC, so a lost index
+// is rebuilt from its log.
+class SessionArchive {
+public:
+  static constexpr uint32_t MAX_LOG_BYTES = 16 * 1024;  // ~110 sessions per generation
+
+  bool begin();  // LittleFS must be mounted
+
+  // Returns the new id, 0 if the write failed
+  uint32_t append(const SessionSummary& s);
+
+  // Newest first, up to n entries (both generations)
+  uint8_t listRecent(ArchiveEntry* out, uint8_t n);
+  bool fetch(uint32_t id, SessionSummary& out);
+
+  uint32_t count() const { return _gen[0].count + _gen[1].count; }
+  uint32_t lastId() const { return _nextId - 1; }
+  uint32_t logBytes() const { return _gen[0].logBytes; }
+
+private:
+  // 0 = current, 1 = previous
+  struct Generation {
+    uint32_t firstId = 1;
+    uint32_t count = 0;
+    uint32_t logBytes = 0;
+  };
+  Generation _gen[2];
+  uint32_t _nextId = 1;
+  bool _ready = false;
+
+  bool openGeneration(uint8_t g);
+  bool rebuildIndex();            // current generation, from its log
+  bool startGeneration(uint32_t firstId);
+  bool rollOver();
+  bool trimIndex(uint8_t g);      // back to header + _gen[g].count entries
+  static uint32_t indexBytes(uint32_t count);
+  bool readEntry(uint8_t g, uint32_t pos, ArchiveEntry& e);
+};
@@ -85,6 +85,46 @@ struct SessionSettings {
   }
 };
 
+// Step settings resolved once (step override vs profile) plus the values
+// that depend on the current temperature. See SessionController::refreshSchedule().
+struct CompiledStep {
+  int32_t baseDurationSec = 0;
+  int32_t adjustedDurationSec = 0;
+  float timerRate = 1.0f;        // development units per real second
+  uint32_t timerRateQ16 = 1UL << 16;  // same, 16.16 fixed point for the integrator
+  bool rpmAdjusted = false;      // coefficient targets RPM for this step
+  float rpmMult = 1.0f;
+  float rpm = 0.0f;              // step RPM with the coefficient applied
+  TempAlarmAction alarmAction = TempAlarmAction::Beep;
+};
+
+// Why a session ended
+enum class SessionEnd : uint8_t {
+  Completed = 0,   // last step ran out
+  Stopped = 1,     // user stop
+  Alarm = 2        // temperature alarm with the Stop action
+};
+
+// What actually happened in one session, handed to the end callback.
+// Fixed-width fields only - SessionArchive stores it as is.
+struct SessionSummary {
+  char profileName[PROFILE_NAME_LEN] = "";
+  uint32_t startMs = 0;                     // uptime at start
+  uint32_t startEpoch = 0;                  // wall clock, 0 = no time source
+  int32_t stepPlannedSec[MAX_STEPS] = {0};  // durations as set
+  int32_t stepActualSec[MAX_STEPS] = {0};   // real running time per step
+  float tempMinC = NAN;                     // NAN = no reading while running
+  float tempMaxC = NAN;
+  float tempMeanC = NAN;                    // time-weighted
+  uint32_t reversals = 0;
+  uint16_t alarms = 0;                      // temperature alarm onsets
+  int8_t stepCount = 0;
+  int8_t stepsDone = 0;                     // steps that ran to the end
+  SessionEnd end = SessionEnd::Completed;
+  bool resumed = false;                     // continued after a reset
+  uint8_t reserved[2] = {0, 0};
+};
+
 struct SessionState {
   bool running = false;
   bool timerActive = false;
@@ -101,6 +141,10 @@ public:
   void stop();
   void toggleRun();  // start/pause
   void nextStep();   // advance to next step (after pause)
+  // Restore progress saved by ResumeJournal
+  void resumeAt(int8_t step, uint64_t devUs, bool running, bool paused);
+  // Called once per session from the stop/completion paths
+  void setSessionEndCallback(void (*cb)(const SessionSummary&)) { _endCb = cb; }
 
   // Settings access
   SessionSettings& settings() { return _settings; }
@@ -111,16 +155,33 @@ public:
   bool isPaused() const { return _paused; }
   bool isTimerActive() const { return _timerActive; }
   int8_t currentStep() const { return _currentStep; }
-  int32_t stepRemainingSec() const;
-  int32_t totalRemainingSec() const;
+  // Started and not yet finished or stopped (includes a mid-step pause)
+  bool inProgress() const { return _running || _paused || _currentStep > 0 || _devUs > 0; }
+  // Projections cached by tick() - O(1)
+  int32_t stepRemainingSec() const { return _stepRemainingSec; }
+  int32_t totalRemainingSec() const { return _stepRemainingSec + _futureRemainingSec; }
+  // Development progress of the current step, in seconds at base temperature
+  float stepDevUnits() const { return _devUs / 1000000.0f; }
+  uint64_t stepDevUs() const { return _devUs; }
+
+  // Bumped on every settings edit; the compiled schedule is rebuilt when it moves
+  void bumpSettingsVersion() { _settingsVersion++; }
+  uint32_t settingsVersion() const { return _settingsVersion; }
+  uint32_t scheduleRebuilds() const { return _scheduleRebuilds; }
 
   // Apply settings to motor
   void applyToMotor();
 
-  // Temperature for coefficient calculation
+  // Temperature for coefficient calculation (filtered estimate, NAN if stale)
   void setCurrentTemp(float tempC) { _currentTempC = tempC; }
   float currentTemp() const { return _currentTempC; }
+  // Limit breach seen by the sensor itself (TH/TL alarm + exact read)
+  void setTempBreach(bool low, bool high) { _breachLow = low; _breachHigh = high; }
   
+  // RPM for the rest of the current step only (remote set_rpm); the step
+  // table is left alone. Cleared at the step boundary, 0 = none
+  void setRpmOverride(int32_t rpm) { _rpmOverride = rpm; }
+
   // Get adjusted values (with temp coefficient applied)
   float adjustedRpm() const;
   int32_t adjustedStepDurationSec(int8_t stepIdx) const;
@@ -139,16 +200,57 @@ private:
   bool _paused = false;       // paused between steps
   bool _timerActive = false;
   int8_t _currentStep = 0;    // current step index (0-based)
-  uint32_t _stepStartMs = 0;
-  uint32_t _stepPausedMs = 0;
+  int32_t _rpmOverride = 0;
+
+  // Development integrator: the step ends when _devUs reaches its
+  // durationSec. Advances at _stepRateQ16 (temp coefficient) per real
+  // microsecond of the shared clock; integer so nothing drifts or truncates.
+  uint64_t _devUs = 0;
+  uint32_t _devFracQ16 = 0;
+  uint32_t _stepRateQ16 = 1UL << 16;
+  uint64_t _lastIntegrateUs = 0;
+
+  // Compiled schedule and the inputs it was built from
+  CompiledStep _schedule[MAX_STEPS];
+  int32_t _remainingAfter[MAX_STEPS] = {0};  // adjusted time of steps after i
+  uint32_t _settingsVersion = 0;
+  uint32_t _schedVersion = UINT32_MAX;
+  int16_t _schedTempBucket = INT16_MIN;
+  int8_t _schedStepCount = -1;
+  uint32_t _scheduleRebuilds = 0;
+
+  int32_t _stepRemainingSec = 0;
+  int32_t _futureRemainingSec = 0;
   float _currentTempC = NAN;
   bool _tempAlarm = false;
   bool _tempLow = false;
   bool _tempHigh = false;
+  bool _breachLow = false;
+  bool _breachHigh = false;
+
+  // Summary of the session in progress
+  void (*_endCb)(const SessionSummary&) = nullptr;
+  bool _summaryActive = false;
+  SessionSummary _summary;
+  uint64_t _stepRunUs[MAX_STEPS] = {0};
+  int64_t _tempSum = 0;        // centi-C x us
+  uint64_t _tempUs = 0;
+  uint32_t _revStart = 0;
 
   void checkTempLimits();
-  float calcTempCoefMultiplier() const;
+  void beginSummary(bool resumed);
+  void endSession(SessionEnd why);
   float calcTempCoefMultiplierForStep(int8_t stepIdx) const;
+  void compileStep(int8_t stepIdx, CompiledStep& out) const;
+  void startTimer();
+  void pauseTimer();
+  void integrate();
+  void refreshSchedule();
+  void updateStepRemaining();
   void updateTimer();
   void resetTimer();
+  void resetDev() { _devUs = 0; _devFracQ16 = 0; }
+
+  static constexpr float MIN_TIMER_RATE = 0.1f;  // never stall a step
+  static constexpr uint64_t US_PER_SEC = 1000000ULL;
 };
@@ -0,0 +1,107 @@
+#pragma once
+#include <Arduino.h>
+
+// One row of the recording, as handed in by App
+struct TelemetrySample {
+  float tempC = NAN;
+  float rpmTarget = 0.0f;
+  float rpmActual = 0.0f;
+  bool dirFwd = true;
+  int8_t step = 0;
+  bool tempLow = false;
+  bool tempHigh = false;
+  bool tempAlarm = false;
+};
+
+// Fixed-point copy used for storage and delta coding
+struct TelemetryQ {
+  int16_t temp = 0;        // 1/16 C, TEMP_NONE = no reading
+  int16_t rpmTarget = 0;   // 0.5 rpm - a full 0..60 swing still fits an int8 delta
+  int16_t rpmActual = 0;   // 0.5 rpm
+  int8_t step = 0;
+  uint8_t state = 0;       // TS_* bits
+};
+
+// Export position; keeps the decoder state so CSV can be streamed a few
+// lines at a time while recording goes on
+struct TelemetryCursor {
+  bool started = false;
+  uint32_t seq = 0;        // block being exported
+  uint16_t sample = 0;     // samples of that block already written
+  uint16_t offset = 0;     // byte offset into the block data
+  TelemetryQ q;
+};
+
+// In-session recorder: a RAM ring of fixed-size blocks. Each block opens
+// with a keyframe (absolute values in the header); the samples after it
+// are delta-coded, 2-3 bytes when nothing but temperature and RPM moved.
+// When the ring is full the oldest block is dropped.
+class TelemetryRecorder {
+public:
+  static constexpr uint8_t TS_DIR_FWD = 0x01;
+  static constexpr uint8_t TS_TEMP_LOW = 0x02;
+  static constexpr uint8_t TS_TEMP_HIGH = 0x04;
+  static constexpr uint8_t TS_ALARM = 0x08;
+  static constexpr int16_t TEMP_NONE = INT16_MIN;
+
+  void start();   // clears the ring; time 0 = now
+  void stop();    // keeps the data for export
+  bool recording() const { return _recording; }
+
+  void setPeriodMs(uint16_t ms);
+  uint16_t periodMs() const { return _periodMs; }
+
+  // Cheap check for the loop; record() only when it returns true
+  bool due() const;
+  void record(const TelemetrySample& s);
+
+  // Writes up to maxLines CSV lines (header first) and returns true when the
+  // newest sample has been written. Blocks overwritten meanwhile are
+  // reported as a "# gap" line.
+  bool exportCsv(Print& out, TelemetryCursor& c, uint16_t maxLines);
+
+  uint32_t sampleCount() const;
+  uint32_t bytesUsed() const;
+  uint32_t droppedBlocks() const { return _dropped; }
+  static constexpr uint32_t capacityBytes() { return sizeof(_blocks); }
+
+  // Sample codec, shared with the WebSocket stream (TelemetryStream)
+  static constexpr uint8_t MAX_SAMPLE_BYTES = 9;
+  static TelemetryQ quantize(const TelemetrySample& s);
+  static uint8_t encode(const TelemetryQ& prev, const TelemetryQ& q, uint8_t* out);
+  static uint8_t decode(const uint8_t* in, TelemetryQ& q);
+
+private:
+  struct BlockHeader {
+    uint32_t seq;
+    uint32_t startMs;      // keyframe time, ms since start()
+    uint16_t periodMs;
+    uint16_t count;        // samples incl. keyframe
+    uint16_t used;         // bytes of data[]
+    TelemetryQ key;        // keyframe
+  };
+  static constexpr uint16_t BLOCK_BYTES = 256;
+  static constexpr uint16_t DATA_BYTES = BLOCK_BYTES - sizeof(BlockHeader);
+  static constexpr uint8_t BLOCKS = 24;            // 6 KB
+  static constexpr uint16_t DEFAULT_PERIOD_MS = 2000;  // 1 h ~ 4.5 KB
+
+  struct Block {
+    BlockHeader h;
+    uint8_t data[DATA_BYTES];
+  };
+
+  Block _blocks[BLOCKS];
+  uint32_t _oldestSeq = 0;
+  uint32_t _nextSeq = 0;      // seq of the next block to open
+  uint32_t _dropped = 0;
+  bool _recording = false;
+  bool _newBlock = true;      // next sample opens a block (start / period change)
+  uint16_t _periodMs = DEFAULT_PERIOD_MS;
+  uint32_t _startMs = 0;
+  uint32_t _nextDueMs = 0;
+  TelemetryQ _last;
+
+  Block* blockFor(uint32_t seq);
+  void openBlock(uint32_t t, const TelemetryQ& q);
+  static void printRow(Print& out, uint32_t t, const TelemetryQ& q);
+};
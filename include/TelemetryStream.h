@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+#include "Protocol.h"
+#include "TelemetryRecorder.h"
+
+// High-rate samples (10-50 Hz) for the web UI graphs, batched into one
+// binary frame per MAX_AGE_MS: a BinTelemetry header with the first sample,
+// then delta records of 2-3 bytes each. Built in place in a fixed buffer.
+class TelemetryStream {
+public:
+  static constexpr uint8_t MIN_HZ = 10;
+  static constexpr uint8_t MAX_HZ = 50;
+  static constexpr uint16_t FRAME_BYTES = 160;
+  static constexpr uint8_t MAX_SAMPLES = 40;
+  static constexpr uint16_t MAX_AGE_MS = 500;
+
+  // 0 = off; otherwise clamped to MIN_HZ..MAX_HZ. Drops a partial frame.
+  void setRate(uint8_t hz);
+  uint8_t rateHz() const { return _hz; }
+  uint16_t periodMs() const { return _periodMs; }
+
+  bool due(uint32_t nowMs) const { return _hz && (int32_t)(nowMs - _nextDueMs) >= 0; }
+  // Returns true when a frame is complete (size, sample count or age);
+  // send frame()/frameLen(), then call next()
+  bool add(const TelemetrySample& s, uint32_t nowMs);
+  const uint8_t* frame() const { return _buf; }
+  size_t frameLen() const { return _len; }
+  void next();
+
+  uint32_t frames() const { return _seq; }
+
+private:
+  uint8_t _buf[FRAME_BYTES];
+  size_t _len = 0;            // 0 = no frame open
+  uint8_t _hz = 0;
+  uint16_t _periodMs = 0;
+  uint32_t _nextDueMs = 0;
+  uint32_t _seq = 0;
+  TelemetryQ _last;
+  // A sample after a stall can't share the frame's time base - it opens
+  // the next frame instead
+  bool _carry = false;
+  TelemetryQ _carryQ;
+  uint32_t _carryMs = 0;
+
+  void open(const TelemetryQ& q, uint32_t t);
+  BinTelemetry& header() { return *(BinTelemetry*)_buf; }
+};
@@ -12,10 +12,29 @@ public:
   bool hasSensor() const { return _hasSensor; }
   float tempC() const { return _tempC + _offset; }
   float rawTempC() const { return _tempC; }
-  
-  void setOffset(float offset) { _offset = offset; }
+
+  void setOffset(float offset) {
+    if (offset != _offset) _alarmDirty = _alarmArmed;
+    _offset = offset;
+  }
   float offset() const { return _offset; }
 
+  // Filtered estimate (alpha-beta filter), extrapolated to now using the
+  // tracked slope. NAN if no sensor or the last reading is too old.
+  float estimateC() const;
+  float slopeCPerMin() const { return _slopeCPerSec * 60.0f; }
+  uint32_t estimateAgeMs() const;  // age of the last reading behind the estimate
+  uint8_t resolution() const { return _resolution; }
+
+  // Temperature limits mirrored into the sensor's TH/TL alarm registers.
+  // Cheap to call every tick - the scratchpad is only written on change.
+  void setAlarmLimits(bool enabled, float minC, float maxC);
+  // Limit breach from the latest (unfiltered) reading
+  bool alarmLow() const { return _alarmLow; }
+  bool alarmHigh() const { return _alarmHigh; }
+  uint32_t fullReads() const { return _fullReads; }
+  uint32_t alarmChecks() const { return _alarmChecks; }
+
 private:
   OneWire* _ow = nullptr;
   DallasTemperature* _dt = nullptr;
@@ -32,6 +51,52 @@ private:
   uint32_t _lastCycleMs = 0;
   uint32_t _phaseTsMs = 0;
 
-  static constexpr uint32_t PERIOD_MS = 1200;
-  static constexpr uint32_t CONV_WAIT_MS = 800;
+  // Scratchpad config (written without COPY SCRATCHPAD - no EEPROM wear)
+  uint8_t _resolution = 12;
+  uint8_t _th = 0x7F;
+  uint8_t _tl = 0x80;
+
+  // Filter state
+  bool _filterValid = false;
+  float _estC = NAN;
+  float _slopeCPerSec = 0.0f;
+  uint32_t _sampleMs = 0;     // when the last reading was taken
+  uint8_t _stableCount = 0;   // consecutive slow readings (back to 12-bit)
+
+  // Alarm registers
+  bool _alarmArmed = false;
+  bool _alarmDirty = false;   // TH/TL need rewriting once the bus is idle
+  float _alarmMinC = 0.0f;
+  float _alarmMaxC = 0.0f;
+  bool _alarmLow = false;
+  bool _alarmHigh = false;
+  uint8_t _skippedReads = 0;
+  uint32_t _fullReads = 0;
+  uint32_t _alarmChecks = 0;
+
+  void detect();
+  bool writeScratch(uint8_t resolution);
+  bool readSample(float& out);
+  void updateFilter(float t, uint32_t nowMs);
+  void adaptResolution(float residual);
+  void alarmRegisters(uint8_t& th, uint8_t& tl) const;
+  void applyAlarmRegisters();
+  bool alarmSearch();
+  uint32_t periodMs() const { return _resolution >= 12 ? PERIOD_MS : FAST_PERIOD_MS; }
+  uint32_t convWaitMs() const { return _resolution >= 12 ? CONV_WAIT_MS : FAST_CONV_WAIT_MS; }
+
+  static constexpr uint32_t PERIOD_MS = 1000;
+  static constexpr uint32_t CONV_WAIT_MS = 800;       // 12-bit: 750ms max
+  static constexpr uint32_t FAST_PERIOD_MS = 300;
+  static constexpr uint32_t FAST_CONV_WAIT_MS = 200;  // 10-bit: 187.5ms max
+
+  static constexpr float ALPHA = 0.5f;                 // level gain
+  static constexpr float BETA = 0.03f;                 // slope gain
+  static constexpr float FAST_SLOPE_C_PER_SEC = 0.04f; // ~2.4C/min -> 10-bit
+  static constexpr float FAST_RESIDUAL_C = 0.4f;       // step change -> 10-bit
+  static constexpr float SLOW_SLOPE_C_PER_SEC = 0.015f;// back to 12-bit when below...
+  static constexpr uint8_t SLOW_READINGS = 5;          // ...for this many readings
+  static constexpr uint32_t MAX_EXTRAPOLATE_MS = 3000;
+  static constexpr uint32_t MAX_ESTIMATE_AGE_MS = 10000;
+  static constexpr uint8_t FULL_READ_EVERY = 3;        // stable + armed: 1 in 3 reads
 };
@@ -0,0 +1,87 @@
+#pragma once
+#include <Arduino.h>
+#include "Clock.h"
+
+// Square-wave source for a passive buzzer. Buzzer picks the hardware
+// backend of the target and falls back to SoftTone when it can't make the
+// requested tone. ESP8266 has no spare hardware for this (Timer1 drives the
+// stepper; the sigma-delta modulator only makes fixed ~0.4 % pulses at a
+// pitch, far too quiet), so it always uses SoftTone.
+class ToneBackend {
+public:
+  virtual ~ToneBackend() {}
+  virtual void begin(uint8_t pin, bool activeHigh) = 0;
+  // dutyPct: share of each period at the active level. False = can't do it
+  // (nothing was changed on the pin)
+  virtual bool start(uint16_t freqHz, uint8_t dutyPct) = 0;
+  virtual void stop() = 0;   // pin back to the inactive level
+  // Only the software toggle needs servicing from the loop
+  virtual bool needsPoll() const { return false; }
+  virtual void poll() {}
+};
+
+// Pin toggled from Buzzer::tick - pitch is only as good as the loop period
+class SoftTone : public ToneBackend {
+public:
+  void begin(uint8_t pin, bool activeHigh) override {
+    _pin = pin;
+    _activeHigh = activeHigh;
+    pinMode(_pin, OUTPUT);
+    stop();
+  }
+
+  bool start(uint16_t freqHz, uint8_t dutyPct) override {
+    if (freqHz == 0 || dutyPct == 0 || dutyPct >= 100) return false;
+    uint32_t periodUs = 1000000UL / freqHz;
+    _highUs = periodUs * dutyPct / 100;
+    _lowUs = periodUs - _highUs;
+    _on = true;
+    _level = true;
+    write(true);
+    _nextUs = sysClock.nowUs32() + _highUs;
+    return true;
+  }
+
+  void stop() override {
+    _on = false;
+    write(false);
+  }
+
+  bool needsPoll() const override { return true; }
+  void poll() override {
+    if (!_on) return;
+    uint32_t now = sysClock.nowUs32();
+    if ((int32_t)(now - _nextUs) < 0) return;
+    _level = !_level;
+    write(_level);
+    _nextUs = now + (_level ? _highUs : _lowUs);
+  }
+
+private:
+  uint8_t _pin = 255;
+  bool _activeHigh = true;
+  bool _on = false;
+  bool _level = false;
+  uint32_t _highUs = 0;
+  uint32_t _lowUs = 0;
+  uint32_t _nextUs = 0;
+
+  void write(bool active) { digitalWrite(_pin, active == _activeHigh ? HIGH : LOW); }
+};
+
+#if defined(ESP32)
+// LEDC channel: exact frequency and duty, no loop involvement
+class LedcTone : public ToneBackend {
+public:
+  void begin(uint8_t pin, bool activeHigh) override;
+  bool start(uint16_t freqHz, uint8_t dutyPct) override;
+  void stop() override;
+
+private:
+  static constexpr uint8_t CHANNEL = 0;
+  static constexpr uint8_t RES_BITS = 8;
+  uint8_t _pin = 255;
+  bool _activeHigh = true;
+  bool _attached = false;
+};
+#endif
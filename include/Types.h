@@ -1,5 +1,6 @@
 #pragma once
 #include <Arduino.h>
+#include "HardwareSettings.h"
 
 enum class ProcState : uint8_t { Idle, Running, Paused, Stopping };
 enum class RevPhase  : uint8_t { None, RampDown, Pause, RampUp };
@@ -62,6 +63,10 @@ struct PersistentConfig {
   int rpm = 10;
   bool dirFwd = true;
   uint16_t processTimeSec = 300;  // Default 5 minutes
+
+  // Edited in the menu (Hardware / Buzzer)
+  HardwareSettings hw;
+  BuzzerSettings buzzer;
 };
 
 struct Status {
@@ -84,4 +89,13 @@ struct Status {
   
   // Temperature alarm
   bool tempAlarm = false;         // True when temp deviates beyond threshold
+  bool tempLow = false;
+  bool tempHigh = false;
+
+  // Session progress
+  float rpmActual = 0.0f;         // ramped motor speed
+  int8_t step = 0;                // 0-based
+  int8_t stepCount = 0;
+  int32_t stepRemainingSec = 0;
+  int32_t totalRemainingSec = 0;
 };
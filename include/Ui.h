@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include <U8g2lib.h>
+#include "ModuleProfiler.h"
 
 // Forward declare Screen enum
 enum class Screen : uint8_t;
@@ -14,6 +15,7 @@ struct UiModel {
   int8_t subMenuIdx = 0;
   
   bool run = false;
+  bool savePending = false;  // settings edits not yet written to flash
   int32_t rpm = 0;
   float adjustedRpm = 0.0f;  // RPM after temp coefficient applied
   float currentRpm = 0.0f;
@@ -49,6 +51,20 @@ struct UiModel {
   char profileName[16] = "";
   int32_t currentStepRpm = 30;
 
+  // Profile library (filled while the profile list is shown)
+  uint8_t profileCount = 0;
+  int8_t activeProfile = -1;
+  char profileNames[8][16] = {};
+  int8_t profileStepCounts[8] = {0};
+  int32_t profileTotalSec[8] = {0};
+
+  // Resume prompt
+  int8_t resumeStep = 0;
+  char resumeStepName[12] = "";
+  int32_t resumeDoneSec = 0;     // development time already done in the step
+  int32_t resumeStepSec = 0;     // step duration
+  bool resumeRunning = false;
+
   // Temperature coefficient
   bool tempCoefEnabled = false;
   float tempCoefBase = 20.0f;
@@ -83,6 +99,14 @@ struct UiModel {
   bool hasTemp = false;
   float tempC = NAN;
 
+  // Diagnostics (filled while the screen is shown)
+  int8_t diagScroll = 0;
+  uint32_t diagWindowMs = 0;   // 0 = no complete window yet
+  uint32_t diagPasses = 0;
+  uint32_t diagMeanUs[PS_COUNT] = {0};
+  uint32_t diagP99Us[PS_COUNT] = {0};
+  uint32_t diagMaxUs[PS_COUNT] = {0};
+
   // live states (debug)
   bool okDown = false;
   bool backDown = false;
@@ -106,7 +130,6 @@ public:
 
 private:
   U8G2_SSD1306_128X64_NONAME_F_HW_I2C _u8g2{U8G2_R0, U8X8_PIN_NONE};
-  uint32_t _lastDraw = 0;
 
   void draw(const UiModel& m);
   void drawMain(const UiModel& m);
@@ -158,4 +181,7 @@ private:
   void drawEditBuzzerType(const UiModel& m);
   void drawEditBuzzerActiveHigh(const UiModel& m);
   void drawEditTempOffset(const UiModel& m);
+  void drawDiagnostics(const UiModel& m);
+  // Boot
+  void drawResumePrompt(const UiModel& m);
 };
@@ -0,0 +1,41 @@
+#pragma once
+#include <Arduino.h>
+
+// Sections that are written to flash behind the edits
+enum WriteSection : uint8_t {
+  WS_CONFIG = 0x01,    // device config (hardware, buzzer, ...)
+  WS_PROFILE = 0x02,   // the library profile the settings were loaded from
+};
+
+// Coalesces settings edits: sections are marked dirty as edits happen and
+// written once, after QUIET_MS without further edits or when the menu is
+// left - never while the motor turns. App does the actual writes.
+class WriteBehind {
+public:
+  static constexpr uint32_t QUIET_MS = 5000;
+
+  struct Stats {
+    uint32_t edits = 0;         // markDirty() calls
+    uint32_t flushes = 0;       // section writes
+    uint32_t failed = 0;
+    uint32_t deferred = 0;      // flushes held back by a running motor
+  };
+
+  void markDirty(uint8_t sections);
+  // Sections to write now (0 = none); call once per pass
+  uint8_t due(bool menuOpen, bool motorRunning);
+  // Report the writes App made for due()'s sections
+  void flushed(uint8_t sections, bool ok);
+
+  bool pending() const { return _dirty != 0; }
+  uint8_t dirty() const { return _dirty; }
+  const Stats& stats() const { return _stats; }
+
+private:
+  uint8_t _dirty = 0;
+  uint32_t _lastEditMs = 0;
+  bool _menuWasOpen = false;
+  bool _leftMenu = false;     // menu closed with edits pending
+  bool _heldBack = false;     // counted in deferred already
+  Stats _stats;
+};
@@ -1,22 +1,89 @@
 #pragma once
 #include <WebSocketsServer.h>
-#include <ArduinoJson.h>
+#include "JsonWriter.h"
 
+// WebSocketsServer that can tell how much a client's socket takes without
+// blocking, so nothing is written that would make the library wait
+class WsTransport : public WebSocketsServer {
+public:
+  using WebSocketsServer::WebSocketsServer;
+  size_t writable(uint8_t num);
+};
+
+// What may happen to a queued frame when the client falls behind
+enum class FrameClass : uint8_t {
+  Status,    // superseded by the next one: oldest dropped first
+  Reliable   // acks/replies: never dropped (client is disconnected instead)
+};
+
+// Outgoing frames go into a bounded per-client queue and are written only
+// when that client's socket has room, so a slow client never stalls the
+// loop. Messages are built once in a preallocated buffer that keeps
+// WEBSOCKETS_MAX_HEADER_SIZE bytes free in front; the library then writes
+// the frame header in place (headerToPayload) instead of malloc'ing a copy.
 class WsServer {
 public:
-  WsServer(WebSocketsServer& ws): _ws(ws) {}
+  static constexpr size_t TX_BYTES = 512;
+  static constexpr uint8_t MAX_CLIENTS = WEBSOCKETS_SERVER_CLIENT_MAX;
+  static constexpr uint16_t QUEUE_BYTES = 768;   // per client
+
+  struct QueueStats {
+    uint16_t frames = 0;      // queued now
+    uint16_t bytes = 0;
+    uint16_t maxBytes = 0;    // high-water mark
+    uint32_t sent = 0;
+    uint32_t dropped = 0;     // status frames dropped
+  };
+
+  WsServer(WsTransport& ws): _ws(ws) {}
   void begin(void (*handler)(uint8_t, WStype_t, uint8_t*, size_t)) {
     _ws.begin();
     _ws.onEvent(handler);
   }
   void loop() { _ws.loop(); }
 
-  void broadcastDoc(ArduinoJson::JsonDocument& doc) {
-    String msg;
-    serializeJson(doc, msg);
-    _ws.broadcastTXT(msg);
-  }
+  // Writer over the build buffer; the previous message is overwritten
+  JsonWriter writer() { return JsonWriter((char*)payload(), TX_BYTES); }
+  // Binary frames: encode into payload() (TX_BYTES), then queue len bytes
+  uint8_t* payload() { return _tx + WEBSOCKETS_MAX_HEADER_SIZE; }
+
+  // Copy the built message into the client's queue. False if dropped.
+  bool queue(uint8_t num, const JsonWriter& w, FrameClass cls);
+  bool queueBin(uint8_t num, size_t len, FrameClass cls);
+
+  // Writes queued frames while sockets have room; never waits
+  void flush();
+
+  void reset(uint8_t num);           // on connect/disconnect
+  bool takeGap(uint8_t num);         // a status frame was dropped since the last call
+  const QueueStats& stats(uint8_t num) const { return _q[num].stats; }
 
 private:
-  WebSocketsServer& _ws;
+  struct Queue {
+    uint8_t buf[QUEUE_BYTES];
+    uint16_t head = 0;        // oldest record
+    uint16_t used = 0;
+    bool gap = false;
+    QueueStats stats;
+  };
+
+  // Record header in the ring; the frame bytes follow
+  struct Record {
+    uint16_t len;
+    uint8_t flags;            // REC_*
+    uint8_t reserved;
+  };
+  static constexpr uint8_t REC_BIN = 0x01;
+  static constexpr uint8_t REC_RELIABLE = 0x02;
+
+  WsTransport& _ws;
+  uint8_t _tx[WEBSOCKETS_MAX_HEADER_SIZE + TX_BYTES];
+  Queue _q[MAX_CLIENTS];
+  uint8_t _nextFlush = 0;
+
+  bool push(uint8_t num, size_t len, uint8_t flags);
+  bool dropOldestStatus(Queue& q);
+  void ringWrite(Queue& q, uint16_t pos, const void* src, uint16_t len);
+  void ringRead(const Queue& q, uint16_t pos, void* dst, uint16_t len) const;
+  bool flushClient(uint8_t num);
 };
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+# Compare two benchmark runs (env:bench output: BENCH_OUT files or the
+# captured "BENCH {...}" lines of pio test -v).
+#
+#   python scripts/bench_compare.py base.jsonl new.jsonl [--threshold 2]
+#
+# esp_us comes from instruction/float-op counts and doesn't depend on host
+# load, so a small threshold works; host_ns is only used when a run has no
+# counts. Exits 1 when something got slower than the threshold.
+import argparse
+import json
+import sys
+
+HOST_THRESHOLD = 15.0  # percent; host timings are noisy
+
+
+def load(path):
+    meta, rows = {}, {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("BENCH "):
+                line = line[6:]
+            if not line.startswith("{"):
+                continue
+            rec = json.loads(line)
+            if "name" in rec:
+                rows[rec["name"]] = rec
+            else:
+                meta = rec
+    return meta, rows
+
+
+def change(a, b):
+    if a is None or b is None or a == 0:
+        return None
+    return (b - a) * 100.0 / a
+
+
+def fmt(v, digits):
+    return "-" if v is None else "%.*f" % (digits, v)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("base")
+    ap.add_argument("new")
+    ap.add_argument("--threshold", type=float, default=2.0,
+                    help="esp_us increase in percent that counts as a regression")
+    args = ap.parse_args()
+
+    base_meta, base = load(args.base)
+    new_meta, new = load(args.new)
+    for key in ("model", "compiler"):
+        if base_meta.get(key) != new_meta.get(key):
+            print("note: %s differs (%s vs %s), counts are not comparable 1:1"
+                  % (key, base_meta.get(key), new_meta.get(key)))
+
+    print("%-26s %10s %10s %8s %10s %10s %8s" %
+          ("benchmark", "esp_us", "new", "", "host_ns", "new", ""))
+    regressions = 0
+    for name in sorted(set(base) | set(new)):
+        a, b = base.get(name, {}), new.get(name, {})
+        esp = change(a.get("esp_us"), b.get("esp_us"))
+        host = change(a.get("host_ns"), b.get("host_ns"))
+        slower = (esp is not None and esp > args.threshold) or \
+                 (esp is None and host is not None and host > HOST_THRESHOLD)
+        regressions += slower
+        print("%-26s %10s %10s %7s%% %10s %10s %7s%%%s" % (
+            name,
+            fmt(a.get("esp_us"), 2), fmt(b.get("esp_us"), 2), fmt(esp, 1),
+            fmt(a.get("host_ns"), 1), fmt(b.get("host_ns"), 1), fmt(host, 1),
+            "  SLOWER" if slower else ""))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,37 @@
+# PlatformIO pre-script: gzip web/ into data/www/ before the filesystem
+# image is built (pio run -t buildfs / uploadfs). Output is deterministic
+# (no mtime/name in the gzip header), so unchanged files keep their ETag.
+import gzip
+import os
+
+Import("env")  # noqa: F821
+
+SRC = os.path.join(env["PROJECT_DIR"], "web")  # noqa: F821
+DST = os.path.join(env["PROJECT_DIR"], "data", "www")  # noqa: F821
+
+
+def pack_www():
+    if not os.path.isdir(SRC):
+        return
+    os.makedirs(DST, exist_ok=True)
+    for name in os.listdir(DST):
+        if name.endswith(".gz"):
+            os.remove(os.path.join(DST, name))
+    total = 0
+    for name in sorted(os.listdir(SRC)):
+        path = os.path.join(SRC, name)
+        if not os.path.isfile(path):
+            continue
+        with open(path, "rb") as f:
+            raw = f.read()
+        with open(os.path.join(DST, name + ".gz"), "wb") as out:
+            with gzip.GzipFile(filename="", mode="wb", fileobj=out, compresslevel=9, mtime=0) as gz:
+                gz.write(raw)
+        packed = os.path.getsize(os.path.join(DST, name + ".gz"))
+        total += packed
+        print("pack_www: %s %d -> %d bytes" % (name, len(raw), packed))
+    print("pack_www: %d bytes in data/www" % total)
+
+
+if any(t in COMMAND_LINE_TARGETS for t in ("buildfs", "uploadfs", "uploadfsota")):  # noqa: F821
+    pack_www()
@@ -0,0 +1,181 @@
+#pragma once
+// Host simulation of the ESP8266 Arduino core: virtual time, a pin table,
+// captured Serial. Driven from tests through Sim.h.
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+#include <cstdarg>
+#include <cstdlib>
+#include <string>
+
+using std::isnan;
+using std::isinf;
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define DEC 10
+#define HEX 16
+
+// NodeMCU / D1 mini pin names
+#define A0 17
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Time (virtual - only Sim advances it)
+uint32_t millis();
+uint32_t micros();
+uint64_t micros64();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// GPIO
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int irq, void (*isr)(), int mode);
+void detachInterrupt(int irq);
+void noInterrupts();
+void interrupts();
+
+// timer1 (StepperISR): single shot, TIM_DIV16 = 5 ticks per us
+#define TIM_DIV1 0
+#define TIM_DIV16 1
+#define TIM_DIV256 3
+#define TIM_EDGE 0
+#define TIM_LEVEL 1
+#define TIM_SINGLE 0
+#define TIM_LOOP 1
+void timer1_isr_init();
+void timer1_attachInterrupt(void (*isr)());
+void timer1_detachInterrupt();
+void timer1_enable(uint8_t div, uint8_t intType, uint8_t reload);
+void timer1_disable();
+void timer1_write(uint32_t ticks);
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+class String {
+public:
+  String(const char* s = "") : _s(s ? s : "") {}
+  String(const std::string& s) : _s(s) {}
+  const char* c_str() const { return _s.c_str(); }
+  size_t length() const { return _s.size(); }
+  String& operator+=(const char* s) { _s += s; return *this; }
+  bool operator==(const char* s) const { return _s == s; }
+  bool startsWith(const char* p) const { return _s.compare(0, strlen(p), p) == 0; }
+private:
+  std::string _s;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    size_t r = 0;
+    while (n--) r += write(*buf++);
+    return r;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  virtual int availableForWrite() { return 0; }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+  size_t println() { return write("\r\n"); }
+  template <class T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  template <class T> size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() { return -1; }
+  size_t readBytes(char* buf, size_t n) {
+    size_t got = 0;
+    while (got < n) {
+      int c = read();
+      if (c < 0) break;
+      buf[got++] = (char)c;
+    }
+    return got;
+  }
+  size_t readBytes(uint8_t* buf, size_t n) { return readBytes((char*)buf, n); }
+};
+
+// Output goes to Sim's capture buffer (and stdout when echo is on); input
+// is whatever the test queued with sim::serialInput()
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int availableForWrite() override { return 128; }
+  operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _b{a, b, c, d} {}
+  uint8_t operator[](int i) const { return _b[i]; }
+  uint8_t& operator[](int i) { return _b[i]; }
+  operator uint32_t() const { return _b[0] | _b[1] << 8 | _b[2] << 16 | (uint32_t)_b[3] << 24; }
+  bool operator==(const IPAddress& o) const { return memcmp(_b, o._b, 4) == 0; }
+  bool operator!=(const IPAddress& o) const { return !(*this == o); }
+private:
+  uint8_t _b[4] = {0, 0, 0, 0};
+};
+
+class EspClass {
+public:
+  uint32_t getCycleCount();   // virtual: getCpuFreqMHz() per simulated us
+  uint8_t getCpuFreqMHz() { return 80; }
+  uint32_t getFreeHeap() { return 40000; }
+  uint32_t getMaxFreeBlockSize() { return 30000; }
+  uint8_t getHeapFragmentation() { return 5; }
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+  String getResetReason() { return String("Sim"); }
+  uint32_t getChipId() { return 0x51D0B0; }
+};
+extern EspClass ESP;
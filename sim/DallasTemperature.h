@@ -0,0 +1,27 @@
+#pragma once
+#include <OneWire.h>
+
+typedef uint8_t DeviceAddress[8];
+typedef uint8_t ScratchPad[9];
+#define DEVICE_DISCONNECTED_C -127
+
+// The subset of DallasTemperature the firmware uses, backed by the
+// simulated sensor
+class DallasTemperature {
+public:
+  explicit DallasTemperature(OneWire* ow) : _ow(ow) {}
+  void begin() {}
+  void setWaitForConversion(bool wait) { _wait = wait; }
+  uint8_t getDeviceCount();
+  bool getAddress(uint8_t* addr, uint8_t index);
+  bool isConnected(const uint8_t* addr);
+  bool isConnected(const uint8_t* addr, uint8_t* scratchPad);
+  bool readScratchPad(const uint8_t* addr, uint8_t* scratchPad);
+  bool setResolution(const uint8_t* addr, uint8_t bits, bool skipGlobal = false);
+  bool requestTemperaturesByAddress(const uint8_t* addr);
+  float getTempC(const uint8_t* addr);
+
+private:
+  OneWire* _ow;
+  bool _wait = true;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+// WiFi for the host build: the AP always comes up, the station link is
+// whatever sim::setWifiConnected() says. Sockets never carry real traffic;
+// WebSocket clients are injected by Sim (see WebSocketsServer.h).
+enum wl_status_t { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_DISCONNECTED = 6 };
+enum WiFiMode_t { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 };
+
+class WiFiClass {
+public:
+  bool mode(WiFiMode_t m) { _mode = m; return true; }
+  WiFiMode_t getMode() const { return _mode; }
+  void persistent(bool on) { (void)on; }
+  bool setAutoReconnect(bool on) { (void)on; return true; }
+  bool hostname(const char* name) { (void)name; return true; }
+  bool begin(const char* ssid, const char* pass);
+  bool softAPConfig(IPAddress ip, IPAddress gw, IPAddress mask);
+  bool softAP(const char* ssid, const char* pass) { (void)ssid; (void)pass; return true; }
+  wl_status_t status() const;
+  bool isConnected() const { return status() == WL_CONNECTED; }
+  IPAddress localIP() const;
+  IPAddress subnetMask() const;
+  IPAddress softAPIP() const { return _apIp; }
+
+private:
+  WiFiMode_t _mode = WIFI_OFF;
+  bool _staStarted = false;
+  IPAddress _apIp;
+};
+extern WiFiClass WiFi;
+
+// A socket end with a controllable send buffer
+class WiFiClient : public Stream {
+public:
+  WiFiClient() {}
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t n);
+  int availableForWrite() override;
+  uint8_t connected() const { return _s && _s->connected; }
+  void stop();
+  void setNoDelay(bool on) { (void)on; }
+  operator bool() const { return connected(); }
+
+  // Sim side
+  static WiFiClient open();
+  void setWritable(size_t bytes);      // finite send buffer, consumed by writes
+  void receive(const char* data);      // bytes for read(); also keeps a copy of writes
+  const std::string& sent() const;
+
+private:
+  struct State {
+    bool connected = true;
+    bool limited = false;
+    size_t writable = 2920;            // TCP_SND_BUF on the lwIP2 low-memory build
+    size_t written = 0;
+    bool capture = false;
+    std::string rx;
+    size_t rxPos = 0;
+    std::string tx;
+  };
+  std::shared_ptr<State> _s;
+};
+
+class WiFiServer {
+public:
+  explicit WiFiServer(uint16_t port) { (void)port; }
+  void begin() {}
+  WiFiClient available();              // a request queued by sim::httpRequest()
+};
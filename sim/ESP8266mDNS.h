@@ -0,0 +1,15 @@
+#pragma once
+#include <Arduino.h>
+
+class MDNSResponder {
+public:
+  bool begin(const char* host) { (void)host; return true; }
+  bool update() { return true; }
+  void addService(const char* service, const char* proto, uint16_t port) {
+    (void)service; (void)proto; (void)port;
+  }
+  void addServiceTxt(const char* service, const char* proto, const char* key, const char* value) {
+    (void)service; (void)proto; (void)key; (void)value;
+  }
+};
+extern MDNSResponder MDNS;
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include <ESP8266WiFi.h>
+
+class AsyncUDPPacket {
+public:
+  AsyncUDPPacket(uint8_t* data, size_t len, IPAddress ip, uint16_t port)
+    : _data(data), _len(len), _ip(ip), _port(port) {}
+  uint8_t* data() { return _data; }
+  size_t length() const { return _len; }
+  IPAddress remoteIP() const { return _ip; }
+  uint16_t remotePort() const { return _port; }
+
+private:
+  uint8_t* _data;
+  size_t _len;
+  IPAddress _ip;
+  uint16_t _port;
+};
+
+// Listens and sends into the void: discovery is not simulated beyond that
+class AsyncUDP {
+public:
+  bool listen(uint16_t port) { (void)port; return true; }
+  void onPacket(std::function<void(AsyncUDPPacket&)> cb) { _cb = cb; }
+  size_t writeTo(const uint8_t* data, size_t len, const IPAddress& ip, uint16_t port) {
+    (void)data; (void)ip; (void)port;
+    return len;
+  }
+
+private:
+  std::function<void(AsyncUDPPacket&)> _cb;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <Arduino.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// In-memory LittleFS (ESP8266 FS API). Like the real one, a file written
+// or appended to is committed on close()/flush(): a reset before that
+// leaves the previous version.
+class File : public Stream {
+public:
+  File() {}
+  operator bool() const { return (bool)_h; }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t* buf, size_t n);
+  bool seek(uint32_t pos);
+  size_t position() const;
+  size_t size() const;
+  void flush();
+  void close();
+  const char* name() const;
+  bool isDirectory() const { return false; }
+
+private:
+  struct Handle {
+    std::string path;
+    std::string name;                  // without the directory
+    std::vector<uint8_t> data;         // private copy until committed
+    size_t pos = 0;
+    bool writable = false;
+    bool dirty = false;
+    void commit();
+    ~Handle() { commit(); }          // the last copy going away closes it
+  };
+  std::shared_ptr<Handle> _h;
+  friend class FS;
+  friend class Dir;
+};
+
+class Dir {
+public:
+  bool next();
+  String fileName() const;
+  size_t fileSize() const;
+  File openFile(const char* mode);
+
+private:
+  std::vector<std::string> _paths;
+  size_t _next = 0;                    // one past the current entry
+  size_t _prefix = 0;                  // length of "<dir>/"
+  friend class FS;
+};
+
+class FS {
+public:
+  bool begin();
+  void end() {}
+  bool format();
+  bool exists(const char* path);
+  File open(const char* path, const char* mode);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path) { (void)path; return true; }
+  Dir openDir(const char* path);
+};
+
+extern FS LittleFS;
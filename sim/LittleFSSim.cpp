@@ -0,0 +1,176 @@
+#include "LittleFS.h"
+#include "Sim.h"
+#include "SimInternal.h"
+#include <map>
+
+FS LittleFS;
+
+namespace {
+// Committed file contents by full path. Never destroyed: File objects in
+// globals may still close after main() returns.
+std::map<std::string, std::vector<uint8_t>>& files() {
+  static auto* f = new std::map<std::string, std::vector<uint8_t>>;
+  return *f;
+}
+bool s_readOnly = false;
+} // namespace
+
+// --- File ------------------------------------------------------------------
+
+size_t File::write(const uint8_t* buf, size_t n) {
+  if (!_h || !_h->writable) return 0;
+  Handle& h = *_h;
+  if (h.pos + n > h.data.size()) h.data.resize(h.pos + n);
+  memcpy(h.data.data() + h.pos, buf, n);
+  h.pos += n;
+  h.dirty = true;
+  return n;
+}
+
+int File::available() { return _h ? (int)(_h->data.size() - _h->pos) : 0; }
+
+int File::read() {
+  if (!_h || _h->pos >= _h->data.size()) return -1;
+  return _h->data[_h->pos++];
+}
+
+int File::peek() {
+  if (!_h || _h->pos >= _h->data.size()) return -1;
+  return _h->data[_h->pos];
+}
+
+size_t File::read(uint8_t* buf, size_t n) {
+  if (!_h) return 0;
+  size_t left = _h->data.size() - _h->pos;
+  if (n > left) n = left;
+  memcpy(buf, _h->data.data() + _h->pos, n);
+  _h->pos += n;
+  return n;
+}
+
+bool File::seek(uint32_t pos) {
+  if (!_h || pos > _h->data.size()) return false;
+  _h->pos = pos;
+  return true;
+}
+
+size_t File::position() const { return _h ? _h->pos : 0; }
+size_t File::size() const { return _h ? _h->data.size() : 0; }
+const char* File::name() const { return _h ? _h->name.c_str() : ""; }
+
+void File::Handle::commit() {
+  if (!dirty) return;
+  files()[path] = data;
+  dirty = false;
+}
+
+void File::flush() {
+  if (_h) _h->commit();
+}
+
+void File::close() {
+  flush();
+  _h.reset();
+}
+
+// --- Dir -------------------------------------------------------------------
+
+bool Dir::next() {
+  if (_next >= _paths.size()) return false;
+  _next++;
+  return true;
+}
+
+String Dir::fileName() const {
+  return _next ? String(_paths[_next - 1].substr(_prefix)) : String();
+}
+
+size_t Dir::fileSize() const {
+  if (!_next) return 0;
+  auto it = files().find(_paths[_next - 1]);
+  return it == files().end() ? 0 : it->second.size();
+}
+
+File Dir::openFile(const char* mode) {
+  return _next ? LittleFS.open(_paths[_next - 1].c_str(), mode) : File();
+}
+
+// --- FS --------------------------------------------------------------------
+
+bool FS::begin() { return true; }
+
+bool FS::format() {
+  files().clear();
+  return true;
+}
+
+bool FS::exists(const char* path) { return files().count(path) > 0; }
+
+File FS::open(const char* path, const char* mode) {
+  File f;
+  auto it = files().find(path);
+  bool read = mode[0] == 'r' && mode[1] != '+';
+  if (read && it == files().end()) return f;
+  if (!read && s_readOnly) return f;
+
+  f._h = std::make_shared<File::Handle>();
+  File::Handle& h = *f._h;
+  h.path = path;
+  const char* slash = strrchr(path, '/');
+  h.name = slash ? slash + 1 : path;
+  h.writable = !read;
+  if (it != files().end() && mode[0] != 'w') h.data = it->second;
+  if (mode[0] == 'a') h.pos = h.data.size();
+  // "w" leaves an empty file even if nothing is written
+  if (mode[0] == 'w') h.dirty = true;
+  return f;
+}
+
+bool FS::remove(const char* path) { return !s_readOnly && files().erase(path) > 0; }
+
+bool FS::rename(const char* from, const char* to) {
+  if (s_readOnly) return false;
+  auto it = files().find(from);
+  if (it == files().end()) return false;
+  std::vector<uint8_t> data = std::move(it->second);
+  files().erase(it);
+  files()[to] = std::move(data);
+  return true;
+}
+
+Dir FS::openDir(const char* path) {
+  Dir d;
+  std::string prefix = path;
+  if (prefix.empty() || prefix.back() != '/') prefix += '/';
+  d._prefix = prefix.size();
+  for (const auto& kv : files()) {
+    const std::string& p = kv.first;
+    // Direct children only
+    if (p.compare(0, prefix.size(), prefix) == 0 && p.find('/', prefix.size()) == std::string::npos) {
+      d._paths.push_back(p);
+    }
+  }
+  return d;
+}
+
+// --- control ---------------------------------------------------------------
+
+namespace sim {
+
+void formatFs() { files().clear(); }
+void setFsReadOnly(bool on) { s_readOnly = on; }
+bool fsExists(const char* path) { return files().count(path) > 0; }
+
+size_t fsSize(const char* path) {
+  auto it = files().find(path);
+  return it == files().end() ? 0 : it->second.size();
+}
+
+namespace detail {
+void resetFs(bool keep) {
+  if (!keep) files().clear();
+  s_readOnly = false;
+}
+} // namespace detail
+
+} // namespace sim
@@ -0,0 +1,257 @@
+// WiFi, mDNS and WebSocket clients for the host build
+#include <ESP8266WiFi.h>
+#include <ESP8266mDNS.h>
+#include <WebSocketsServer.h>
+#include "Sim.h"
+#include "SimInternal.h"
+#include <deque>
+#include <utility>
+#include <string.h>
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+namespace {
+
+constexpr size_t MAX_KEPT_FRAMES = 4096;
+constexpr size_t MAX_CAPTURE_BYTES = 1 << 20;
+
+bool s_staUp = false;
+
+struct WsEvent {
+  uint8_t num;
+  WStype_t type;
+  std::string payload;
+};
+
+struct WsClientLog {
+  std::vector<std::string> text;
+  std::vector<std::string> binData;
+  uint32_t bin = 0;
+  long writable = -1;       // send buffer for new connections, -1 = unlimited
+};
+
+WebSocketsServer* s_ws = nullptr;
+std::deque<WsEvent> s_events;
+WsClientLog s_log[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+WiFiClient s_http;                // the last HTTP request
+bool s_httpPending = false;       // not yet accepted
+
+} // namespace
+
+struct WsSimAccess {
+  static WiFiClient& tcp(WebSocketsServer& ws, uint8_t num) { return ws._tcp[num]; }
+};
+
+// --- WiFi ------------------------------------------------------------------
+
+bool WiFiClass::begin(const char* ssid, const char* pass) {
+  (void)ssid;
+  (void)pass;
+  _staStarted = true;
+  return true;
+}
+
+bool WiFiClass::softAPConfig(IPAddress ip, IPAddress gw, IPAddress mask) {
+  (void)gw;
+  (void)mask;
+  _apIp = ip;
+  return true;
+}
+
+wl_status_t WiFiClass::status() const {
+  return _staStarted && s_staUp ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+IPAddress WiFiClass::localIP() const {
+  return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 77) : IPAddress();
+}
+
+IPAddress WiFiClass::subnetMask() const { return IPAddress(255, 255, 255, 0); }
+
+WiFiClient WiFiClient::open() {
+  WiFiClient c;
+  c._s = std::make_shared<State>();
+  return c;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t n) {
+  if (!connected()) return 0;
+  if (_s->limited) {
+    if (n > _s->writable) n = _s->writable;
+    _s->writable -= n;
+  }
+  _s->written += n;
+  if (_s->capture && _s->tx.size() < MAX_CAPTURE_BYTES) _s->tx.append((const char*)buf, n);
+  return n;
+}
+
+int WiFiClient::available() { return connected() ? (int)(_s->rx.size() - _s->rxPos) : 0; }
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t n) {
+  size_t avail = (size_t)available();
+  if (n > avail) n = avail;
+  memcpy(buf, _s->rx.data() + _s->rxPos, n);
+  _s->rxPos += n;
+  return (int)n;
+}
+
+int WiFiClient::availableForWrite() { return connected() ? (int)_s->writable : 0; }
+
+void WiFiClient::stop() {
+  if (_s) _s->connected = false;
+}
+
+void WiFiClient::setWritable(size_t bytes) {
+  if (!_s) return;
+  _s->limited = true;
+  _s->writable = bytes;
+}
+
+void WiFiClient::receive(const char* data) {
+  if (!_s) return;
+  _s->rx += data;
+  _s->capture = true;
+}
+
+const std::string& WiFiClient::sent() const {
+  static const std::string none;
+  return _s ? _s->tx : none;
+}
+
+WiFiClient WiFiServer::available() {
+  if (!s_httpPending) return WiFiClient();
+  s_httpPending = false;
+  return s_http;
+}
+
+// --- WebSocketsServer --------------------------------------------------------
+
+WebSocketsServer::WebSocketsServer(uint16_t port, const String& origin, const String& protocol) {
+  (void)port;
+  (void)origin;
+  (void)protocol;
+  for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+    _clients[i].num = i;
+    _clients[i].status = WSC_NOT_CONNECTED;
+    _clients[i].tcp = nullptr;
+  }
+  s_ws = this;
+}
+
+WebSocketsServer::~WebSocketsServer() {
+  if (s_ws == this) s_ws = nullptr;
+}
+
+void WebSocketsServer::loop() {
+  if (!_running) return;
+  while (!s_events.empty()) {
+    WsEvent e = std::move(s_events.front());  // no copy: tests count the heap
+    s_events.pop_front();
+    WSclient_t& c = _clients[e.num];
+    if (e.type == WStype_CONNECTED) {
+      _tcp[e.num] = WiFiClient::open();
+      if (s_log[e.num].writable >= 0) _tcp[e.num].setWritable(s_log[e.num].writable);
+      c.tcp = &_tcp[e.num];
+      c.status = WSC_CONNECTED;
+    } else if (c.status != WSC_CONNECTED) {
+      continue;
+    } else if (e.type == WStype_DISCONNECTED) {
+      disconnect(e.num);
+      continue;
+    }
+    if (_cb) _cb(e.num, e.type, (uint8_t*)&e.payload[0], e.payload.size());
+  }
+}
+
+bool WebSocketsServer::sendTXT(uint8_t num, uint8_t* payload, size_t length, bool headerToPayload) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || _clients[num].status != WSC_CONNECTED) return false;
+  const char* data = (const char*)payload + (headerToPayload ? WEBSOCKETS_MAX_HEADER_SIZE : 0);
+  if (length == 0) length = strlen(data);
+  std::vector<std::string>& log = s_log[num].text;
+  if (log.size() >= MAX_KEPT_FRAMES) log.erase(log.begin(), log.begin() + MAX_KEPT_FRAMES / 2);
+  log.emplace_back(data, length);
+  _tcp[num].write((const uint8_t*)data, length + 2);
+  return true;
+}
+
+bool WebSocketsServer::sendBIN(uint8_t num, uint8_t* payload, size_t length, bool headerToPayload) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || _clients[num].status != WSC_CONNECTED) return false;
+  s_log[num].bin++;
+  const uint8_t* data = payload + (headerToPayload ? WEBSOCKETS_MAX_HEADER_SIZE : 0);
+  std::vector<std::string>& log = s_log[num].binData;
+  if (log.size() >= MAX_KEPT_FRAMES) log.erase(log.begin(), log.begin() + MAX_KEPT_FRAMES / 2);
+  log.emplace_back((const char*)data, length);
+  _tcp[num].write(data, length + 2);
+  return true;
+}
+
+void WebSocketsServer::disconnect(uint8_t num) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || _clients[num].status == WSC_NOT_CONNECTED) return;
+  _tcp[num].stop();
+  _clients[num].status = WSC_NOT_CONNECTED;
+  _clients[num].tcp = nullptr;
+  if (_cb) _cb(num, WStype_DISCONNECTED, nullptr, 0);
+}
+
+uint8_t WebSocketsServer::connectedClients(bool ping) {
+  (void)ping;
+  uint8_t n = 0;
+  for (const WSclient_t& c : _clients) n += c.status == WSC_CONNECTED;
+  return n;
+}
+
+// --- control ---------------------------------------------------------------
+
+namespace sim {
+
+void setWifiConnected(bool up) { s_staUp = up; }
+
+void wsConnect(uint8_t num) {
+  if (num < WEBSOCKETS_SERVER_CLIENT_MAX) s_events.push_back({num, WStype_CONNECTED, ""});
+}
+
+void wsReceive(uint8_t num, const char* text) {
+  if (num < WEBSOCKETS_SERVER_CLIENT_MAX) s_events.push_back({num, WStype_TEXT, text});
+}
+
+void wsDisconnect(uint8_t num) {
+  if (num < WEBSOCKETS_SERVER_CLIENT_MAX) s_events.push_back({num, WStype_DISCONNECTED, ""});
+}
+
+void setWsWritable(uint8_t num, size_t bytes) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return;
+  s_log[num].writable = (long)bytes;
+  if (s_ws) WsSimAccess::tcp(*s_ws, num).setWritable(bytes);
+}
+
+std::vector<std::string>& wsSent(uint8_t num) { return s_log[num % WEBSOCKETS_SERVER_CLIENT_MAX].text; }
+uint32_t wsBinFrames(uint8_t num) { return s_log[num % WEBSOCKETS_SERVER_CLIENT_MAX].bin; }
+std::vector<std::string>& wsSentBin(uint8_t num) { return s_log[num % WEBSOCKETS_SERVER_CLIENT_MAX].binData; }
+
+void httpRequest(const char* raw) {
+  s_http = WiFiClient::open();
+  s_http.receive(raw);
+  s_httpPending = true;
+}
+
+const std::string& httpResponse() { return s_http.sent(); }
+bool httpOpen() { return s_http.connected(); }
+
+namespace detail {
+void resetNet() {
+  s_staUp = false;
+  s_events.clear();
+  for (WsClientLog& l : s_log) l = WsClientLog{};
+  s_http = WiFiClient();
+  s_httpPending = false;
+}
+} // namespace detail
+
+} // namespace sim
@@ -0,0 +1,27 @@
+#pragma once
+#include <Arduino.h>
+
+// OneWire bus with one simulated DS18B20 on it (sim::setTempC()). Only the
+// commands the firmware issues directly are modelled: WRITE SCRATCHPAD
+// (0x4E) and the alarm search.
+class OneWire {
+public:
+  explicit OneWire(uint8_t pin) { (void)pin; }
+  uint8_t reset();
+  void select(const uint8_t rom[8]);
+  void skip();
+  void write(uint8_t v, uint8_t power = 0);
+  void write_bytes(const uint8_t* buf, uint16_t n, bool power = false);
+  uint8_t read() { return 0xFF; }
+  void read_bytes(uint8_t* buf, uint16_t n) { memset(buf, 0xFF, n); }
+  void depower() {}
+  void reset_search() { _searchDone = false; }
+  bool search(uint8_t* addr, bool normalSearch = true);
+  static uint8_t crc8(const uint8_t* addr, uint8_t len);
+
+private:
+  uint8_t _cmd = 0;         // last function command after select()
+  uint8_t _written = 0;     // data bytes written since
+  bool _selected = false;
+  bool _searchDone = false;
+};
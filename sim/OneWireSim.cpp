@@ -0,0 +1,178 @@
+// One DS18B20: scratchpad, conversion time per resolution, alarm flag
+#include "DallasTemperature.h"
+#include "Sim.h"
+#include "SimInternal.h"
+#include <math.h>
+
+namespace {
+
+const uint8_t ROM[8] = {0x28, 0x51, 0x4D, 0x10, 0x00, 0x00, 0x00, 0x00};
+
+struct Sensor {
+  bool present = true;
+  float tempC = 20.0f;
+  uint8_t th = 0x4B;          // power-on defaults: +75 / -10 C, 12 bit
+  uint8_t tl = 0x46;
+  uint8_t config = 0x7F;
+  int16_t raw = 85 * 16;      // power-on reset value until the first conversion
+  bool converting = false;
+  int16_t pendingRaw = 0;
+  uint64_t readyAtUs = 0;
+};
+Sensor s_dev;
+
+uint8_t resolution() { return 9 + ((s_dev.config >> 5) & 0x03); }
+
+uint32_t conversionUs() {
+  static const uint32_t US[] = {93750, 187500, 375000, 750000};
+  return US[resolution() - 9];
+}
+
+// A conversion result only shows once the conversion time has passed
+void settle() {
+  if (s_dev.converting && sim::nowUs() >= s_dev.readyAtUs) {
+    s_dev.raw = s_dev.pendingRaw;
+    s_dev.converting = false;
+  }
+}
+
+bool romMatches(const uint8_t* addr) {
+  uint8_t rom[8];
+  memcpy(rom, ROM, 7);
+  rom[7] = OneWire::crc8(rom, 7);
+  return memcmp(addr, rom, 8) == 0;
+}
+
+} // namespace
+
+// --- OneWire ---------------------------------------------------------------
+
+uint8_t OneWire::reset() {
+  _selected = false;
+  _cmd = 0;
+  return s_dev.present ? 1 : 0;
+}
+
+void OneWire::select(const uint8_t rom[8]) { _selected = s_dev.present && romMatches(rom); }
+void OneWire::skip() { _selected = s_dev.present; }
+
+void OneWire::write(uint8_t v, uint8_t) {
+  if (!_selected) return;
+  if (_cmd == 0) {
+    _cmd = v;
+    _written = 0;
+    return;
+  }
+  if (_cmd != 0x4E) return;
+  // WRITE SCRATCHPAD: TH, TL, config
+  switch (_written++) {
+    case 0: s_dev.th = v; break;
+    case 1: s_dev.tl = v; break;
+    case 2: s_dev.config = (uint8_t)((v & 0x60) | 0x1F); break;
+  }
+}
+
+void OneWire::write_bytes(const uint8_t* buf, uint16_t n, bool) {
+  while (n--) write(*buf++);
+}
+
+bool OneWire::search(uint8_t* addr, bool normalSearch) {
+  if (_searchDone || !s_dev.present) return false;
+  _searchDone = true;
+  if (!normalSearch) {
+    // ALARM SEARCH: the flag compares the whole degrees of the last result
+    settle();
+    int t = (int)floorf(s_dev.raw / 16.0f);
+    if (!(t <= (int8_t)s_dev.tl || t >= (int8_t)s_dev.th)) return false;
+  }
+  memcpy(addr, ROM, 7);
+  addr[7] = crc8(addr, 7);
+  return true;
+}
+
+uint8_t OneWire::crc8(const uint8_t* addr, uint8_t len) {
+  uint8_t crc = 0;
+  while (len--) {
+    uint8_t in = *addr++;
+    for (uint8_t i = 8; i; i--) {
+      uint8_t mix = (crc ^ in) & 0x01;
+      crc >>= 1;
+      if (mix) crc ^= 0x8C;
+      in >>= 1;
+    }
+  }
+  return crc;
+}
+
+// --- DallasTemperature -----------------------------------------------------
+
+uint8_t DallasTemperature::getDeviceCount() { return s_dev.present ? 1 : 0; }
+
+bool DallasTemperature::getAddress(uint8_t* addr, uint8_t index) {
+  if (index != 0 || !s_dev.present) return false;
+  memcpy(addr, ROM, 7);
+  addr[7] = OneWire::crc8(addr, 7);
+  return true;
+}
+
+bool DallasTemperature::isConnected(const uint8_t* addr) {
+  ScratchPad sp;
+  return isConnected(addr, sp);
+}
+
+bool DallasTemperature::isConnected(const uint8_t* addr, uint8_t* sp) {
+  return readScratchPad(addr, sp) && OneWire::crc8(sp, 8) == sp[8];
+}
+
+bool DallasTemperature::readScratchPad(const uint8_t* addr, uint8_t* sp) {
+  if (!s_dev.present || !romMatches(addr)) return false;
+  settle();
+  sp[0] = (uint8_t)(s_dev.raw & 0xFF);
+  sp[1] = (uint8_t)((uint16_t)s_dev.raw >> 8);
+  sp[2] = s_dev.th;
+  sp[3] = s_dev.tl;
+  sp[4] = s_dev.config;
+  sp[5] = 0xFF;
+  sp[6] = 0x0C;
+  sp[7] = 0x10;
+  sp[8] = OneWire::crc8(sp, 8);
+  return true;
+}
+
+bool DallasTemperature::setResolution(const uint8_t* addr, uint8_t bits, bool) {
+  if (!s_dev.present || !romMatches(addr) || bits < 9 || bits > 12) return false;
+  s_dev.config = (uint8_t)(((bits - 9) << 5) | 0x1F);
+  return true;
+}
+
+bool DallasTemperature::requestTemperaturesByAddress(const uint8_t* addr) {
+  if (!s_dev.present || !romMatches(addr)) return false;
+  // Rounded to the resolution; the undefined low bits read as zero
+  int16_t raw = (int16_t)lroundf(s_dev.tempC * 16.0f);
+  raw &= (int16_t)~((1 << (12 - resolution())) - 1);
+  s_dev.pendingRaw = raw;
+  s_dev.converting = true;
+  s_dev.readyAtUs = sim::nowUs() + conversionUs();
+  if (_wait) sim::advanceUs(conversionUs());
+  return true;
+}
+
+float DallasTemperature::getTempC(const uint8_t* addr) {
+  ScratchPad sp;
+  if (!isConnected(addr, sp)) return DEVICE_DISCONNECTED_C;
+  return (int16_t)(sp[0] | sp[1] << 8) / 16.0f;
+}
+
+// --- control ---------------------------------------------------------------
+
+namespace sim {
+
+void setTempC(float c) { s_dev.tempC = c; }
+void setSensorPresent(bool present) { s_dev.present = present; }
+uint8_t sensorResolution() { return resolution(); }
+
+namespace detail {
+void resetSensor() { s_dev = Sensor{}; }
+} // namespace detail
+
+} // namespace sim
@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+// Control side of the host simulation (env:sim). Firmware code never
+// includes this; tests and benchmarks use it to drive the virtual hardware.
+//
+// Time only moves when the test moves it. advance*() fires every timer1
+// interrupt that falls due on the way (the stepper ISR re-arms itself), so
+// step pulses land at the virtual times the hardware would produce them.
+namespace sim {
+
+// Back to power-on: time 0, pins released, sensor at 20 C, empty flash
+// and RTC memory, no WebSocket clients, capture buffers cleared. With
+// reboot the flash and RTC memory are kept, like a reset of the chip.
+void reset(bool reboot = false);
+
+// Virtual time
+uint64_t nowUs();
+void advanceUs(uint64_t us);
+inline void advanceMs(uint32_t ms) { advanceUs((uint64_t)ms * 1000); }
+
+// Runs fn(ctx) once per pass, passUs apart, for durationMs of virtual time
+// (the usual loop: app.tick() then let time pass)
+void run(uint32_t durationMs, uint32_t passUs, void (*fn)(void*), void* ctx);
+
+// GPIO: inputs idle HIGH (pull-ups), A0 at 1023 (released)
+void setPin(uint8_t pin, uint8_t level);   // fires attachInterrupt() handlers
+uint8_t pinOut(uint8_t pin);               // last digitalWrite()
+uint32_t pinRises(uint8_t pin);            // LOW->HIGH writes since reset
+uint64_t pinHighUs(uint8_t pin);           // time spent HIGH since reset
+void setAnalog(uint8_t pin, uint16_t value);
+
+// DS18B20 on the OneWire bus
+void setTempC(float c);
+void setSensorPresent(bool present);
+uint8_t sensorResolution();                // from the last WRITE SCRATCHPAD
+
+// Serial console
+void serialInput(const char* text);        // queued for Serial.read()
+std::string serialOutput();                // since the last clear
+void clearSerialOutput();
+void setSerialEcho(bool on);               // also copy output to stdout
+
+// Display: text of the last frame pushed with sendBuffer(), one drawStr()
+// per line in draw order
+uint32_t frames();
+std::string screenText();
+
+// Flash (in-memory LittleFS)
+void formatFs();
+bool fsExists(const char* path);
+size_t fsSize(const char* path);
+void setFsReadOnly(bool on);               // writes, renames and removes fail
+
+// Network
+void setWifiConnected(bool up);
+void wsConnect(uint8_t num);
+void wsReceive(uint8_t num, const char* text);
+void wsDisconnect(uint8_t num);
+void setWsWritable(uint8_t num, size_t bytes);    // finite send buffer, used up by sends
+std::vector<std::string>& wsSent(uint8_t num);    // text frames, oldest first
+uint32_t wsBinFrames(uint8_t num);
+std::vector<std::string>& wsSentBin(uint8_t num); // binary payloads, oldest first
+void httpRequest(const char* raw);                // accepted by the next WiFiServer::available()
+const std::string& httpResponse();                // what the server wrote back so far
+bool httpOpen();                                  // until the server closes the connection
+
+} // namespace sim
@@ -0,0 +1,246 @@
+// Virtual time, GPIO, timer1, Serial and the ESP class for the host build
+#include "Sim.h"
+#include "SimInternal.h"
+#include <deque>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace {
+
+constexpr uint8_t PIN_COUNT = 40;
+constexpr size_t SERIAL_CAP = 1 << 20;   // keep the newest 1 MB
+
+uint64_t s_nowUs = 0;
+
+bool s_pinLow[PIN_COUNT];   // zero = idle HIGH, before any reset()
+uint8_t s_pinOut[PIN_COUNT];
+uint32_t s_rises[PIN_COUNT];
+uint64_t s_highUs[PIN_COUNT];      // time at HIGH before the last rise
+uint64_t s_roseUs[PIN_COUNT];
+uint16_t s_analog = 1023;
+void (*s_pinIsr[PIN_COUNT])() = {};
+uint8_t s_pinIsrMode[PIN_COUNT] = {};
+
+// timer1: single shot, re-armed by timer1_write()
+void (*s_timerIsr)() = nullptr;
+bool s_timerOn = false;
+bool s_timerArmed = false;
+uint64_t s_timerAtUs = 0;
+
+std::deque<char> s_serialIn;
+std::string s_serialOut;
+bool s_echo = false;
+
+uint32_t s_rtc[128];
+
+} // namespace
+
+// --- Arduino core --------------------------------------------------------
+
+uint32_t millis() { return (uint32_t)(s_nowUs / 1000); }
+uint32_t micros() { return (uint32_t)s_nowUs; }
+uint64_t micros64() { return s_nowUs; }
+void delay(uint32_t ms) { sim::advanceUs((uint64_t)ms * 1000); }
+void delayMicroseconds(uint32_t us) { sim::advanceUs(us); }
+void yield() {}
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= PIN_COUNT) return;
+  if (val && !s_pinOut[pin]) {
+    s_rises[pin]++;
+    s_roseUs[pin] = s_nowUs;
+  }
+  if (!val && s_pinOut[pin]) s_highUs[pin] += s_nowUs - s_roseUs[pin];
+  s_pinOut[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) { return pin < PIN_COUNT && !s_pinLow[pin] ? HIGH : LOW; }
+int analogRead(uint8_t pin) { return pin == A0 ? s_analog : 0; }
+
+int digitalPinToInterrupt(int pin) { return pin; }
+
+void attachInterrupt(int irq, void (*isr)(), int mode) {
+  if (irq < 0 || irq >= PIN_COUNT) return;
+  s_pinIsr[irq] = isr;
+  s_pinIsrMode[irq] = (uint8_t)mode;
+}
+
+void detachInterrupt(int irq) {
+  if (irq >= 0 && irq < PIN_COUNT) s_pinIsr[irq] = nullptr;
+}
+
+// Interrupts only ever run inside sim::advanceUs()/setPin(), between passes
+void noInterrupts() {}
+void interrupts() {}
+
+void timer1_isr_init() {}
+void timer1_attachInterrupt(void (*isr)()) { s_timerIsr = isr; }
+void timer1_detachInterrupt() { s_timerIsr = nullptr; }
+void timer1_enable(uint8_t, uint8_t, uint8_t) { s_timerOn = true; }
+void timer1_disable() { s_timerOn = false; s_timerArmed = false; }
+
+void timer1_write(uint32_t ticks) {
+  // TIM_DIV16 at 80 MHz: 5 ticks per us
+  uint32_t us = ticks / 5;
+  s_timerAtUs = s_nowUs + (us ? us : 1);
+  s_timerArmed = true;
+}
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+// --- Print / Serial ------------------------------------------------------
+
+size_t Print::print(long v, int base) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%ld", v);
+  return write(buf);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%lu", v);
+  return write(buf);
+}
+
+size_t Print::print(double v, int digits) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return write(buf);
+}
+
+size_t Print::printf(const char* fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n < 0) return 0;
+  if ((size_t)n < sizeof(buf)) return write((const uint8_t*)buf, n);
+  std::string big(n + 1, '\0');
+  va_start(ap, fmt);
+  vsnprintf(&big[0], big.size(), fmt, ap);
+  va_end(ap);
+  return write((const uint8_t*)big.data(), n);
+}
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t n) {
+  if (s_serialOut.size() + n > SERIAL_CAP) s_serialOut.erase(0, s_serialOut.size() / 2);
+  s_serialOut.append((const char*)buf, n);
+  if (s_echo) fwrite(buf, 1, n, stdout);
+  return n;
+}
+
+int HardwareSerial::available() { return (int)s_serialIn.size(); }
+
+int HardwareSerial::read() {
+  if (s_serialIn.empty()) return -1;
+  char c = s_serialIn.front();
+  s_serialIn.pop_front();
+  return (uint8_t)c;
+}
+
+// --- ESP -----------------------------------------------------------------
+
+uint32_t EspClass::getCycleCount() { return (uint32_t)(s_nowUs * getCpuFreqMHz()); }
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > sizeof(s_rtc)) return false;
+  memcpy(data, (const uint8_t*)s_rtc + offset * 4, size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+  if (offset * 4 + size > sizeof(s_rtc)) return false;
+  memcpy((uint8_t*)s_rtc + offset * 4, data, size);
+  return true;
+}
+
+// --- control -------------------------------------------------------------
+
+namespace sim {
+
+void reset(bool reboot) {
+  s_nowUs = 0;
+  memset(s_pinLow, 0, sizeof(s_pinLow));
+  memset(s_pinOut, LOW, sizeof(s_pinOut));
+  memset(s_rises, 0, sizeof(s_rises));
+  memset(s_highUs, 0, sizeof(s_highUs));
+  memset(s_pinIsr, 0, sizeof(s_pinIsr));
+  s_analog = 1023;
+  s_timerIsr = nullptr;
+  s_timerOn = s_timerArmed = false;
+  s_serialIn.clear();
+  s_serialOut.clear();
+  if (!reboot) memset(s_rtc, 0, sizeof(s_rtc));
+  detail::resetFs(reboot);
+  detail::resetSensor();
+  detail::resetDisplay();
+  detail::resetNet();
+}
+
+uint64_t nowUs() { return s_nowUs; }
+
+void advanceUs(uint64_t us) {
+  uint64_t end = s_nowUs + us;
+  while (s_timerOn && s_timerArmed && s_timerAtUs <= end) {
+    s_nowUs = s_timerAtUs;
+    s_timerArmed = false;
+    if (s_timerIsr) s_timerIsr();
+  }
+  s_nowUs = end;
+}
+
+void run(uint32_t durationMs, uint32_t passUs, void (*fn)(void*), void* ctx) {
+  uint64_t end = s_nowUs + (uint64_t)durationMs * 1000;
+  while (s_nowUs < end) {
+    fn(ctx);
+    advanceUs(passUs);
+  }
+}
+
+void setPin(uint8_t pin, uint8_t level) {
+  if (pin >= PIN_COUNT) return;
+  bool low = !level;
+  if (low == s_pinLow[pin]) return;
+  s_pinLow[pin] = low;
+  if (!s_pinIsr[pin]) return;
+  uint8_t mode = s_pinIsrMode[pin];
+  if (mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level)) s_pinIsr[pin]();
+}
+
+uint8_t pinOut(uint8_t pin) { return pin < PIN_COUNT ? s_pinOut[pin] : LOW; }
+uint32_t pinRises(uint8_t pin) { return pin < PIN_COUNT ? s_rises[pin] : 0; }
+
+uint64_t pinHighUs(uint8_t pin) {
+  if (pin >= PIN_COUNT) return 0;
+  return s_highUs[pin] + (s_pinOut[pin] ? s_nowUs - s_roseUs[pin] : 0);
+}
+
+void setAnalog(uint8_t pin, uint16_t value) {
+  if (pin == A0) s_analog = value;
+}
+
+void serialInput(const char* text) {
+  while (*text) s_serialIn.push_back(*text++);
+}
+
+std::string serialOutput() { return s_serialOut; }
+void clearSerialOutput() { s_serialOut.clear(); }
+void setSerialEcho(bool on) { s_echo = on; }
+
+} // namespace sim
@@ -0,0 +1,12 @@
+#pragma once
+// Shared between the sim mock implementations only
+#include <cstdint>
+
+namespace sim {
+namespace detail {
+void resetFs(bool keep);
+void resetSensor();
+void resetDisplay();
+void resetNet();
+} // namespace detail
+} // namespace sim
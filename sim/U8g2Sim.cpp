@@ -0,0 +1,46 @@
+#include "U8g2lib.h"
+#include "Wire.h"
+#include "Sim.h"
+#include "SimInternal.h"
+
+TwoWire Wire;
+
+const u8g2_cb_t u8g2_cb_r0{};
+const uint8_t u8g2_font_5x8_tf[] = {5};
+const uint8_t u8g2_font_6x13B_tf[] = {6};
+const uint8_t u8g2_font_6x13_tf[] = {6};
+const uint8_t u8g2_font_10x20_tf[] = {10};
+const uint8_t u8g2_font_logisoso18_tf[] = {11};
+const uint8_t u8g2_font_fur30_tf[] = {20};
+
+namespace {
+std::string s_screen;
+uint32_t s_frames = 0;
+} // namespace
+
+int U8G2::drawStr(int x, int y, const char* s) {
+  (void)x;
+  (void)y;
+  _text += s;
+  _text += '\n';
+  return getStrWidth(s);
+}
+
+void U8G2::sendBuffer() {
+  s_screen = _text;
+  s_frames++;
+}
+
+namespace sim {
+
+uint32_t frames() { return s_frames; }
+std::string screenText() { return s_screen; }
+
+namespace detail {
+void resetDisplay() {
+  s_screen.clear();
+  s_frames = 0;
+}
+} // namespace detail
+
+} // namespace sim
@@ -0,0 +1,56 @@
+#pragma once
+#include <Arduino.h>
+#include <string>
+
+// U8g2 for the host build: nothing is rasterized. drawStr() calls are kept
+// as text and sendBuffer() publishes them as the current frame (sim::
+// screenText()). Fonts are fixed-width; the first byte is the glyph width.
+struct u8g2_cb_t {};
+extern const u8g2_cb_t u8g2_cb_r0;
+#define U8G2_R0 (&u8g2_cb_r0)
+#define U8X8_PIN_NONE 255
+
+extern const uint8_t u8g2_font_5x8_tf[];
+extern const uint8_t u8g2_font_6x13B_tf[];
+extern const uint8_t u8g2_font_6x13_tf[];
+extern const uint8_t u8g2_font_10x20_tf[];
+extern const uint8_t u8g2_font_logisoso18_tf[];
+extern const uint8_t u8g2_font_fur30_tf[];
+
+class U8G2 {
+public:
+  bool begin() { return true; }
+  void clearBuffer() { _text.clear(); }
+  void sendBuffer();
+  void setFont(const uint8_t* font) { _glyphW = font ? font[0] : 6; }
+  void setDrawColor(uint8_t color) { (void)color; }
+  void setFontMode(uint8_t mode) { (void)mode; }
+  int drawStr(int x, int y, const char* s);
+  int getStrWidth(const char* s) const { return (int)strlen(s) * _glyphW; }
+  void drawPixel(int x, int y) { (void)x; (void)y; }
+  void drawHLine(int x, int y, int w) { (void)x; (void)y; (void)w; }
+  void drawVLine(int x, int y, int h) { (void)x; (void)y; (void)h; }
+  void drawLine(int x0, int y0, int x1, int y1) { (void)x0; (void)y0; (void)x1; (void)y1; }
+  void drawBox(int x, int y, int w, int h) { (void)x; (void)y; (void)w; (void)h; }
+  void drawFrame(int x, int y, int w, int h) { (void)x; (void)y; (void)w; (void)h; }
+
+private:
+  std::string _text;
+  uint8_t _glyphW = 6;
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+  U8G2_SSD1306_128X64_NONAME_F_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                      uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE) {
+    (void)rotation; (void)reset; (void)clock; (void)data;
+  }
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_SW_I2C : public U8G2 {
+public:
+  U8G2_SSD1306_128X64_NONAME_F_SW_I2C(const u8g2_cb_t* rotation, uint8_t clock, uint8_t data,
+                                      uint8_t reset = U8X8_PIN_NONE) {
+    (void)rotation; (void)clock; (void)data; (void)reset;
+  }
+};
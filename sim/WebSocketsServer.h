@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+// links2004 WebSocketsServer, host build: no sockets or handshakes. Clients
+// connect, send and disconnect through Sim, and the events are delivered
+// from loop() like the library does. Sent frames are recorded per client.
+#define WEBSOCKETS_MAX_HEADER_SIZE (14)
+#define WEBSOCKETS_SERVER_CLIENT_MAX (5)
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN,
+  WStype_FRAGMENT_TEXT_START,
+  WStype_FRAGMENT_BIN_START,
+  WStype_FRAGMENT,
+  WStype_FRAGMENT_FIN,
+  WStype_PING,
+  WStype_PONG,
+} WStype_t;
+
+typedef enum { WSC_NOT_CONNECTED, WSC_HEADER, WSC_BODY, WSC_CONNECTED } WSclientsStatus_t;
+
+typedef struct {
+  uint8_t num;
+  WSclientsStatus_t status;
+  WiFiClient* tcp;
+} WSclient_t;
+
+class WebSocketsServer {
+public:
+  typedef void (*WebSocketServerEvent)(uint8_t num, WStype_t type, uint8_t* payload, size_t length);
+
+  WebSocketsServer(uint16_t port, const String& origin = "", const String& protocol = "arduino");
+  virtual ~WebSocketsServer();
+
+  void begin() { _running = true; }
+  void close() { _running = false; }
+  void loop();
+  void onEvent(WebSocketServerEvent cb) { _cb = cb; }
+
+  // headerToPayload: payload points WEBSOCKETS_MAX_HEADER_SIZE bytes before the data
+  bool sendTXT(uint8_t num, uint8_t* payload, size_t length = 0, bool headerToPayload = false);
+  bool sendTXT(uint8_t num, const char* payload) { return sendTXT(num, (uint8_t*)payload); }
+  bool sendBIN(uint8_t num, uint8_t* payload, size_t length, bool headerToPayload = false);
+  void disconnect(uint8_t num);
+  uint8_t connectedClients(bool ping = false);
+
+protected:
+  WSclient_t _clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+private:
+  WebSocketServerEvent _cb = nullptr;
+  bool _running = false;
+  WiFiClient _tcp[WEBSOCKETS_SERVER_CLIENT_MAX];
+  friend struct WsSimAccess;
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include <Arduino.h>
+
+// The display is the only I2C device and U8g2 is simulated above the bus
+class TwoWire {
+public:
+  void begin() {}
+  void begin(int sda, int scl) { (void)sda; (void)scl; }
+  void setClock(uint32_t hz) { (void)hz; }
+};
+extern TwoWire Wire;
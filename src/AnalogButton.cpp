@@ -1,4 +1,5 @@
 #include "AnalogButton.h"
+#include "Clock.h"
 
 void AnalogButton::begin() {
   Config cfg;
@@ -21,7 +22,7 @@ void AnalogButton::tick() {
   _edgeLongPress = false;
 
   uint16_t v = analogRead(A0);
-  uint32_t now = millis();
+  uint32_t now = sysClock.nowMs();
 
   // Button pulls LOW when pressed (v < pressThreshold = pressed)
   // Hysteresis: once pressed, need v > releaseThreshold to release
@@ -29,7 +30,7 @@ void AnalogButton::tick() {
                       : (v < _cfg.pressThreshold);    // become pressed when v < press
 
   // Debounce: ignore changes within lockout period
-  if (now < _debounceUntilMs) {
+  if ((int32_t)(now - _debounceUntilMs) < 0) {
     _rawLast = raw;
     return;
   }
@@ -1,6 +1,7 @@
 #include "App.h"
 #include "Config.h"
 #include "StepperISR.h"
+#include "Clock.h"
 #include <Wire.h>
 
 App* App::instance = nullptr;
@@ -9,6 +10,48 @@ void App::buzzerTestCallback() {
   if (instance) instance->_buzzer.testBeep();
 }
 
+void App::resumeCallback(bool accept) {
+  if (!instance) return;
+  App& a = *instance;
+  if (accept) {
+    const JournalRecord& r = a._journal.pending();
+    a._motor.setStartDir(r.flags & ResumeJournal::JF_DIR_FWD);
+    a._session.resumeAt(r.step, r.devUs, r.flags & ResumeJournal::JF_RUNNING,
+                        r.flags & ResumeJournal::JF_PAUSED);
+    a._journal.accept(a._session);
+  } else {
+    a._journal.discard();
+  }
+}
+
+void App::sessionEndCallback(const SessionSummary& s) {
+  if (!instance) return;
+  uint32_t id = instance->_archive.append(s);
+  Serial.printf("Session %lu archived (%d/%d steps, end %u)\n", (unsigned long)id,
+                s.stepsDone, s.stepCount, (unsigned)s.end);
+}
+
+void App::fillStatus(Status& st) {
+  if (!instance) return;
+  App& a = *instance;
+  const SessionController& ses = a._session;
+  st.state = ses.isRunning() ? ProcState::Running
+           : ses.inProgress() ? ProcState::Paused : ProcState::Idle;
+  st.rpm = (int)lroundf(ses.adjustedRpm());
+  st.dirFwd = a._motor.dirFwd();
+  st.tempC = a._temp.estimateC();
+  st.timerActive = ses.isTimerActive();
+  st.timerDurationSec = (uint16_t)ses.adjustedStepDurationSec(ses.currentStep());
+  st.tempAlarm = ses.isTempAlarm();
+  st.tempLow = ses.isTempLow();
+  st.tempHigh = ses.isTempHigh();
+  st.rpmActual = a._motor.currentRpm();
+  st.step = ses.currentStep();
+  st.stepCount = ses.settings().stepCount;
+  st.stepRemainingSec = ses.stepRemainingSec();
+  st.totalRemainingSec = ses.totalRemainingSec();
+}
+
 void App::begin() {
   instance = this;
 #if !defined(ESP32)
@@ -18,6 +61,7 @@ void App::begin() {
 #endif
   Wire.setClock(400000);
 
+  sysClock.tick();
   _in.begin();
   _ui.begin();
   _temp.begin(PIN_DS18B20);
@@ -35,44 +79,251 @@ void App::begin() {
   _session.begin(&_motor);
   _menu.begin(&_session);
   _menu.setBuzzerTestCallback(&App::buzzerTestCallback);
+
+  _profiles.begin();
+  _menu.setProfileStore(&_profiles);
+  // Device config (LittleFS is mounted by the profile store)
+  if (!_config.load(_cfg)) _config.setDefaults(_cfg);
+  _menu.hwSettings() = _cfg.hw;
+  _menu.setBuzzerSettings(_cfg.buzzer);
+  _archive.begin();
+  _session.setSessionEndCallback(&App::sessionEndCallback);
+  _menu.setResumeCallback(&App::resumeCallback);
+  if (_journal.begin(&_profiles, _session.settings())) {
+    _session.bumpSettingsVersion();
+    _menu.showResumePrompt();
+  }
+#ifdef PROFILE_BENCH
+  _profiles.benchJson(_session.settings());
+#endif
   
   Buzzer::Config bcfg;
   bcfg.pin = PIN_BUZZER;
   _buzzer.begin(bcfg);
+  applyDeviceSettings();
+
+  // Network last: everything it reports on is up
+  _net.setRecorder(&_telemetry);
+  _net.begin(_cfg.wifi, &App::fillStatus);
+  _prof.begin();
+  addTasks();
 }
 
 void App::tick() {
-  InputsSnapshot s = _in.tick();
-  bool settingsChanged = _menu.handleInput(s);
-  _temp.tick();
-  _session.setCurrentTemp(_temp.tempC());
+  // One timestamp for the whole pass
+  sysClock.tick();
+  if (_lastTickUs) _loopHist.record((uint32_t)(sysClock.nowUs() - _lastTickUs));
+  _lastTickUs = sysClock.nowUs();
+  _sched.runPass();
+}
+
+void App::addTasks() {
+  // Times in us: period (0 = every pass), budget, deadline
+  _sched.begin(&_prof, SLACK_CUTOFF_US);
+  _sched.add(PS_SESSION, [](void* a) { ((App*)a)->runSession(); }, this,
+             TaskPrio::Motion, 0, 500, 20000);
+  _sched.add(PS_INPUT, [](void* a) { ((App*)a)->_inputs = ((App*)a)->_in.tick(); }, this,
+             TaskPrio::Normal, 0, 200, 20000);
+  _sched.add(PS_MENU, [](void* a) { ((App*)a)->runMenu(); }, this,
+             TaskPrio::Normal, 0, 1000, 20000);
+  _sched.add(PS_BUZZER, [](void* a) { ((App*)a)->_buzzer.tick(); }, this,
+             TaskPrio::Normal, 0, 100, 20000);
+  _sched.add(PS_TEMP, [](void* a) { ((App*)a)->runTemp(); }, this,
+             TaskPrio::Normal, 50000, 6000, 50000);
+  _sched.add(PS_RECORD, [](void* a) { ((App*)a)->runRecord(); }, this,
+             TaskPrio::Normal, 10000, 3000, 10000);
+  // Flash writes: overruns are expected, they are deferred while the motor turns
+  _sched.add(PS_STORE, [](void* a) { ((App*)a)->flushSettings(); }, this,
+             TaskPrio::Normal, 100000, 20000, 100000);
+  _sched.add(PS_CONSOLE, [](void* a) { ((App*)a)->pollSerial(); }, this,
+             TaskPrio::Normal, 5000, 1000, 20000);
+  // A full frame push over I2C is most of the UI budget
+  _sched.add(PS_UI, [](void* a) { ((App*)a)->runUi(); }, this,
+             TaskPrio::Slack, UI_FPS_MS * 1000UL, 30000, UI_FPS_MS * 1000UL);
+  // Bounded by its own budget; whatever doesn't fit continues next time
+  _sched.add(PS_NET, [](void* a) { ((App*)a)->_net.service(NET_BUDGET_US); }, this,
+             TaskPrio::Slack, 0, NET_BUDGET_US + 1000, 50000);
+}
+
+void App::runSession() {
+  _session.setCurrentTemp(_temp.estimateC());
+  _session.setTempBreach(_temp.alarmLow(), _temp.alarmHigh());
   _session.tick();
-  _buzzer.tick();
-  
-  // Sync settings from menu when changed
-  if (settingsChanged) {
-    // Buzzer event settings
-    BuzzerSettings bs;
-    bs.enabled = _menu.editBuzzerEnabled();
-    bs.onStepFinished = _menu.editBuzzerStepFinished();
-    bs.onProcessEnded = _menu.editBuzzerProcessEnded();
-    bs.onTempWarning = _menu.editBuzzerTempWarning();
-    bs.freqHz = _menu.editBuzzerFreq();
-    _buzzer.setSettings(bs);
-    
-    // Hardware settings
-    const auto& hw = _menu.hwSettings();
-    _motor.setStepsPerRev(hw.stepsPerRev);
-    _motor.setMicrosteps(hw.microsteps);
-    _buzzer.setActiveHigh(hw.buzzerActiveHigh);
-    _temp.setOffset(hw.tempOffset);
-  }
-  
   checkBuzzerEvents();
-  updateUiModel(s);
+}
+
+void App::runMenu() {
+  uint32_t settingsVer = _session.settingsVersion();
+  bool settingsChanged = _menu.handleInput(_inputs);
+  bool edited = _session.settingsVersion() != settingsVer;
+  // Remote commands take effect here, like a button press, never mid-update
+  applyCommands();
+  // Sync settings from menu when changed
+  if (settingsChanged) applyDeviceSettings();
+  if (edited) noteSettingsEdits();
+}
+
+void App::runTemp() {
+  const auto& set = _session.settings();
+  _temp.setAlarmLimits(set.tempLimitsEnabled, set.tempMin, set.tempMax);
+  _temp.tick();
+}
+
+void App::runRecord() {
+  _journal.tick(_session, _motor.dirFwd());
+  recordTelemetry();
+}
+
+void App::runUi() {
+  updateUiModel(_inputs);
   _ui.tick(_uiModel);
 }
 
+void App::recordTelemetry() {
+  // One recording per session, kept after it ends for export
+  bool active = _session.inProgress();
+  if (active && !_prevInProgress) _telemetry.start();
+  if (!active && _prevInProgress) _telemetry.stop();
+  _prevInProgress = active;
+  // Session recording and the WebSocket stream share one sample per pass
+  bool record = _telemetry.due();
+  bool stream = _net.telemetryDue();
+  if (!record && !stream) return;
+
+  TelemetrySample t;
+  t.tempC = _temp.estimateC();
+  t.rpmTarget = _session.isRunning() ? _session.adjustedRpm() : 0.0f;
+  t.rpmActual = _motor.currentRpm();
+  t.dirFwd = _motor.dirFwd();
+  t.step = _session.currentStep();
+  t.tempLow = _session.isTempLow();
+  t.tempHigh = _session.isTempHigh();
+  t.tempAlarm = _session.isTempAlarm();
+  if (record) _telemetry.record(t);
+  if (stream) _net.addTelemetry(t);
+}
+
+void App::pollSerial() {
+  while (Serial.available()) {
+    char ch = (char)Serial.read();
+    if (ch == '\r') continue;
+    if (ch != '\n') {
+      if (_cmdLen < sizeof(_cmd) - 1) _cmd[_cmdLen++] = ch;
+      continue;
+    }
+    _cmd[_cmdLen] = '\0';
+    _cmdLen = 0;
+    runCommand(_cmd);
+  }
+
+  // CSV is streamed a few lines per pass, straight from the ring
+  if (_csvExport && _telemetry.exportCsv(Serial, _csvCursor, CSV_LINES_PER_TICK)) {
+    _csvExport = false;
+    Serial.println("# end");
+  }
+}
+
+void App::runCommand(const char* cmd) {
+  if (strcmp(cmd, "csv") == 0) {
+    _csvCursor = TelemetryCursor{};
+    _csvExport = true;
+  } else if (strcmp(cmd, "tlm") == 0) {
+    Serial.printf("telemetry: %s, %lu samples, %lu/%lu bytes, period %u ms, %lu blocks dropped\n",
+                  _telemetry.recording() ? "recording" : "idle",
+                  (unsigned long)_telemetry.sampleCount(), (unsigned long)_telemetry.bytesUsed(),
+                  (unsigned long)TelemetryRecorder::capacityBytes(), _telemetry.periodMs(),
+                  (unsigned long)_telemetry.droppedBlocks());
+  } else if (strncmp(cmd, "tlm ", 4) == 0) {
+    _telemetry.setPeriodMs((uint16_t)atoi(cmd + 4));
+    Serial.printf("telemetry period %u ms\n", _telemetry.periodMs());
+  } else if (strcmp(cmd, "hist") == 0 || strncmp(cmd, "hist ", 5) == 0) {
+    printHistory(cmd + 4);
+  } else if (strcmp(cmd, "loop") == 0) {
+    _loopHist.print(Serial);
+    Serial.printf("p99 < %lu us; net: %u clients, %lu budget yields, longest task %lu us\n",
+                  (unsigned long)_loopHist.percentileUs(0.99f), _net.clients(),
+                  (unsigned long)_net.yields(), (unsigned long)_net.maxTaskUs());
+  } else if (strcmp(cmd, "prof") == 0) {
+    _prof.print(Serial);
+  } else if (strcmp(cmd, "sched") == 0) {
+    _sched.print(Serial);
+  } else if (strcmp(cmd, "loop reset") == 0) {
+    _loopHist.reset();
+    _sched.resetStats();
+    _net.resetStats();
+  } else if (strcmp(cmd, "net") == 0) {
+    Serial.printf("net: sta %s, ap %s, %u clients, telemetry %u Hz\n", _net.staConnected() ? "up" : "down",
+                  _net.apActive() ? "on" : "off", _net.clients(), _net.telemetryHz());
+    for (uint8_t i = 0; i < NetService::maxClients(); i++) {
+      if (!_net.clientConnected(i)) continue;
+      const WsServer::QueueStats& q = _net.queueStats(i);
+      Serial.printf("  #%u queue %u frames %u bytes (max %u), sent %lu, dropped %lu\n", i,
+                    q.frames, q.bytes, q.maxBytes, (unsigned long)q.sent, (unsigned long)q.dropped);
+    }
+    const HttpServer& h = _net.http();
+    Serial.printf("  http: %u assets, %lu served, %lu not modified\n", h.assets(),
+                  (unsigned long)h.served(), (unsigned long)h.notModified());
+  } else if (strcmp(cmd, "heap") == 0) {
+#if defined(ESP32)
+    Serial.printf("heap: %lu free, largest block %lu\n", (unsigned long)ESP.getFreeHeap(),
+                  (unsigned long)ESP.getMaxAllocHeap());
+#else
+    Serial.printf("heap: %lu free, largest block %lu, fragmentation %u%%\n",
+                  (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMaxFreeBlockSize(),
+                  ESP.getHeapFragmentation());
+#endif
+  } else if (strcmp(cmd, "save") == 0) {
+    const WriteBehind::Stats& w = _writeBehind.stats();
+    Serial.printf("save: pending %s%s, %lu edits, %lu flushes, %lu failed, %lu deferred (motor running)\n",
+                  (_writeBehind.dirty() & WS_CONFIG) ? "config " : "",
+                  (_writeBehind.dirty() & WS_PROFILE) ? "profile " : "-",
+                  (unsigned long)w.edits, (unsigned long)w.flushes, (unsigned long)w.failed,
+                  (unsigned long)w.deferred);
+    Serial.printf("  config seq %lu, %lu saves since boot\n", (unsigned long)_config.seq(),
+                  (unsigned long)_config.saves());
+  } else if (cmd[0]) {
+    Serial.println("commands: csv | tlm | tlm <period ms> | hist | hist <id> | loop | loop reset | prof | sched | net | heap | save");
+  }
+}
+
+void App::printHistory(const char* arg) {
+  static const char* const END_NAMES[] = {"done", "stopped", "alarm"};
+  auto endName = [](uint8_t e) { return e < 3 ? END_NAMES[e] : "?"; };
+
+  uint32_t id = (uint32_t)atol(arg);
+  if (id == 0) {
+    // Index only - the log isn't touched
+    ArchiveEntry list[8];
+    uint8_t n = _archive.listRecent(list, 8);
+    Serial.printf("%lu sessions archived\n", (unsigned long)_archive.count());
+    for (uint8_t i = 0; i < n; i++) {
+      const ArchiveEntry& e = list[i];
+      Serial.printf("#%lu %-16s %d steps %5lds %s\n", (unsigned long)e.id,
+                    e.name[0] ? e.name : "-", e.stepsDone, (long)e.actualSec, endName(e.end));
+    }
+    return;
+  }
+
+  SessionSummary s;
+  if (!_archive.fetch(id, s)) {
+    Serial.printf("session %lu not found\n", (unsigned long)id);
+    return;
+  }
+  Serial.printf("#%lu %s, %s, started at %lus uptime", (unsigned long)id,
+                s.profileName[0] ? s.profileName : "-", endName((uint8_t)s.end),
+                (unsigned long)(s.startMs / 1000));
+  if (s.startEpoch) Serial.printf(" (epoch %lu)", (unsigned long)s.startEpoch);
+  Serial.println(s.resumed ? ", resumed" : "");
+  for (int8_t i = 0; i < s.stepCount && i < MAX_STEPS; i++) {
+    Serial.printf("  step %d: %lds of %lds\n", i + 1, (long)s.stepActualSec[i],
+                  (long)s.stepPlannedSec[i]);
+  }
+  if (!isnan(s.tempMeanC)) {
+    Serial.printf("  temp min %.2f max %.2f mean %.2f C\n", s.tempMinC, s.tempMaxC, s.tempMeanC);
+  }
+  Serial.printf("  %lu reversals, %u alarms\n", (unsigned long)s.reversals, s.alarms);
+}
+
 void App::updateUiModel(const InputsSnapshot& s) {
   Screen scr = _menu.screen();
   _uiModel.screen = scr;
@@ -82,6 +333,7 @@ void App::updateUiModel(const InputsSnapshot& s) {
   const auto& set = _session.settings();
   
   _uiModel.run = _session.isRunning();
+  _uiModel.savePending = _writeBehind.pending();
   _uiModel.currentRpm = _motor.currentRpm();
   _uiModel.dirFwd = _motor.dirFwd();
   
@@ -114,6 +366,41 @@ void App::updateUiModel(const InputsSnapshot& s) {
     _uiModel.currentStepRpm = set.targetRpm;
   }
   
+  // Resume prompt: where the interrupted session stopped
+  if (scr == Screen::ResumePrompt && _journal.hasPending()) {
+    const JournalRecord& r = _journal.pending();
+    _uiModel.resumeStep = r.step;
+    strncpy(_uiModel.resumeStepName, set.steps[r.step].name, sizeof(_uiModel.resumeStepName) - 1);
+    _uiModel.resumeStepName[sizeof(_uiModel.resumeStepName) - 1] = '\0';
+    _uiModel.resumeDoneSec = (int32_t)(r.devUs / 1000000ULL);
+    _uiModel.resumeStepSec = set.steps[r.step].durationSec;
+    _uiModel.resumeRunning = r.flags & (ResumeJournal::JF_RUNNING | ResumeJournal::JF_PAUSED);
+  }
+
+  if (scr == Screen::Diagnostics) {
+    _uiModel.diagScroll = _menu.diagScroll();
+    _uiModel.diagWindowMs = _prof.ready() ? _prof.windowMs() : 0;
+    for (uint8_t i = 0; i < PS_COUNT; i++) {
+      ModuleProfiler::Stats st = _prof.stats((ProfSection)i);
+      _uiModel.diagMeanUs[i] = st.meanUs;
+      _uiModel.diagP99Us[i] = st.p99Us;
+      _uiModel.diagMaxUs[i] = st.maxUs;
+    }
+    _uiModel.diagPasses = _prof.windowPasses();
+  }
+
+  // Profile library: headers come from the in-RAM index, no file reads
+  if (scr == Screen::ProfileMenu) {
+    _uiModel.profileCount = _profiles.count();
+    _uiModel.activeProfile = _menu.activeProfile();
+    for (uint8_t i = 0; i < _profiles.count() && i < 8; i++) {
+      const ProfileHeader& h = _profiles.header(i);
+      memcpy(_uiModel.profileNames[i], h.name, sizeof(_uiModel.profileNames[i]));
+      _uiModel.profileStepCounts[i] = h.stepCount;
+      _uiModel.profileTotalSec[i] = h.totalDurationSec;
+    }
+  }
+
   // Profile name
   strncpy(_uiModel.profileName, set.profileName, sizeof(_uiModel.profileName) - 1);
   _uiModel.profileName[sizeof(_uiModel.profileName) - 1] = '\0';
@@ -200,6 +487,152 @@ void App::updateUiModel(const InputsSnapshot& s) {
   _uiModel.encSwRawHigh = s.encSwRawHigh;
 }
 
+void App::applyDeviceSettings() {
+  _buzzer.setSettings(_menu.buzzerSettings());
+  const auto& hw = _menu.hwSettings();
+  _motor.setStepsPerRev(hw.stepsPerRev);
+  _motor.setMicrosteps(hw.microsteps);
+  _buzzer.setActiveHigh(hw.buzzerActiveHigh);
+  _buzzer.setType(hw.buzzerType);
+  _temp.setOffset(hw.tempOffset);
+}
+
+// Field by field: memcmp would also compare the padding bytes
+static bool sameBuzzer(const BuzzerSettings& a, const BuzzerSettings& b) {
+  return a.enabled == b.enabled && a.onStepFinished == b.onStepFinished &&
+         a.onProcessEnded == b.onProcessEnded && a.onTempWarning == b.onTempWarning &&
+         a.freqHz == b.freqHz;
+}
+
+static bool sameHardware(const HardwareSettings& a, const HardwareSettings& b) {
+  return a.stepsPerRev == b.stepsPerRev && a.microsteps == b.microsteps &&
+         a.driverType == b.driverType && a.motorInvertDir == b.motorInvertDir &&
+         a.buzzerType == b.buzzerType && a.buzzerActiveHigh == b.buzzerActiveHigh &&
+         a.tempOffset == b.tempOffset;
+}
+
+void App::noteSettingsEdits() {
+  uint8_t sections = 0;
+  BuzzerSettings bs = _menu.buzzerSettings();
+  const HardwareSettings& hw = _menu.hwSettings();
+  if (!sameBuzzer(bs, _cfg.buzzer) || !sameHardware(hw, _cfg.hw)) {
+    _cfg.buzzer = bs;
+    _cfg.hw = hw;
+    sections |= WS_CONFIG;
+  }
+
+  // Edits to a profile loaded from the library go back to it. A different
+  // active profile means it was just loaded or saved: new baseline.
+  int8_t active = _menu.activeProfile();
+  uint32_t crc = ProfileStore::recordCrc(_session.settings());
+  if (active != _profileIdx) {
+    _profileIdx = active;
+    _profileCrc = crc;
+  } else if (active >= 0 && crc != _profileCrc) {
+    _profileCrc = crc;
+    sections |= WS_PROFILE;
+  }
+  _writeBehind.markDirty(sections);
+}
+
+void App::flushSettings() {
+  // The profile list counts as leaving the menu: pending edits are written
+  // before another profile can be loaded over them
+  Screen scr = _menu.screen();
+  bool inMenu = scr != Screen::Main && scr != Screen::ProfileMenu;
+  bool motorRunning = _session.isRunning() || _motor.currentRpm() > 0.0f;
+  uint8_t due = _writeBehind.due(inMenu, motorRunning);
+  if (due & WS_CONFIG) {
+    _writeBehind.flushed(WS_CONFIG, _config.save(_cfg));
+  }
+  if (due & WS_PROFILE) {
+    int8_t idx = _menu.activeProfile();  // < 0: deleted meanwhile
+    _writeBehind.flushed(WS_PROFILE, idx < 0 || _profiles.save(_session.settings(), idx) == idx);
+  }
+}
+
+void App::applyCommands() {
+  Command c;
+  while (_net.popCommand(c)) {
+    CmdError err = applyCommand(c);
+    Serial.printf("Cmd: %s from client %u -> %s\n", cmdTypeToStr(c.type), c.client, cmdErrorToStr(err));
+    _net.ackCommand(c, err);
+  }
+}
+
+CmdError App::applyCommand(const Command& c) {
+  auto clampRpm = [](int32_t v) { return v < RPM_MIN ? RPM_MIN : v > RPM_MAX ? RPM_MAX : v; };
+  auto& set = _session.settings();
+  switch (c.type) {
+    case CmdType::Start:
+      // Also continues after a step-end pause
+      if (_session.isRunning()) return CmdError::NotAllowed;
+      _session.toggleRun();
+      return CmdError::Ok;
+
+    case CmdType::Pause:
+      if (!_session.isRunning()) return CmdError::NotAllowed;
+      _session.toggleRun();
+      return CmdError::Ok;
+
+    case CmdType::Next:
+      if (!_session.isPaused()) return CmdError::NotAllowed;
+      _session.nextStep();
+      return CmdError::Ok;
+
+    case CmdType::Stop:
+      if (!_session.inProgress()) return CmdError::NotAllowed;
+      _session.stop();
+      return CmdError::Ok;
+
+    case CmdType::SetRpm:
+      // During a session: this step only, the profile stays as it is.
+      // Otherwise like the main screen
+      if (_session.inProgress()) {
+        _session.setRpmOverride(clampRpm(c.rpm));
+        return CmdError::Ok;
+      }
+      set.targetRpm = clampRpm(c.rpm);
+      _session.bumpSettingsVersion();
+      return CmdError::Ok;
+
+    case CmdType::EditStep: {
+      // Existing steps or one appended; only steps not yet started mid-session
+      if (c.step < 0 || c.step > set.stepCount || c.step >= MAX_STEPS) return CmdError::BadArgs;
+      if (_session.inProgress() && c.step <= _session.currentStep()) return CmdError::NotAllowed;
+      bool append = c.step == set.stepCount;
+      if (c.fields & CF_DURATION) {
+        if (c.durationSec < 0 || c.durationSec > 3600) return CmdError::BadArgs;
+      }
+      // A new step needs a duration; its slot may still hold a deleted step
+      if (append && (!(c.fields & CF_DURATION) || c.durationSec == 0)) return CmdError::BadArgs;
+      ProcessStep& st = set.steps[c.step];
+      if (append) st = ProcessStep{};
+      if (c.fields & CF_DURATION) st.durationSec = c.durationSec;
+      if (c.fields & CF_RPM) st.rpm = clampRpm(c.rpm);
+      if (c.fields & CF_NAME) strlcpy(st.name, c.name, sizeof(st.name));
+      if (append) set.stepCount++;
+      _session.bumpSettingsVersion();
+      return CmdError::Ok;
+    }
+
+    case CmdType::LoadProfile:
+      // Never swap the steps under a session in progress
+      if (_session.inProgress()) return CmdError::NotAllowed;
+      if (c.index < 0 || c.index >= _profiles.count()) return CmdError::BadArgs;
+      if (!_profiles.load(c.index, set)) return CmdError::Failed;
+      _menu.setActiveProfile(c.index);
+      _session.bumpSettingsVersion();
+      // Remote edits are not written back; this is the profile's baseline
+      _profileIdx = c.index;
+      _profileCrc = ProfileStore::recordCrc(set);
+      return CmdError::Ok;
+
+    default:
+      return CmdError::BadArgs;
+  }
+}
+
 void App::checkBuzzerEvents() {
   bool running = _session.isRunning();
   int8_t step = _session.currentStep();
@@ -2,8 +2,14 @@
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <string.h>
+#include "Crc32.h"
 #include "Protocol.h"
 
+namespace {
+const char* SLOT_PATH[2] = {"/config.0.bin", "/config.1.bin"};
+const char* LEGACY_PATH = "/config.json";
+} // namespace
+
 bool ConfigStore::begin() {
   return LittleFS.begin();
 }
@@ -21,19 +27,87 @@ void ConfigStore::setDefaults(PersistentConfig& cfg) {
 
   cfg.rpm = 10;
   cfg.dirFwd = true;
+
+  cfg.hw = HardwareSettings{};
+  cfg.buzzer = BuzzerSettings{};
+}
+
+bool ConfigStore::readSlot(uint8_t slot, PersistentConfig& out, uint32_t& seq) {
+  File f = LittleFS.open(SLOT_PATH[slot], "r");
+  if (!f) return false;
+  uint8_t buf[sizeof(SlotHeader) + sizeof(PersistentConfig)];
+  size_t n = f.read(buf, sizeof(buf));
+  f.close();
+
+  SlotHeader h;
+  if (n < sizeof(h)) return false;
+  memcpy(&h, buf, sizeof(h));
+  const uint8_t* payload = buf + sizeof(h);
+  if (h.magic != MAGIC || h.version != FORMAT_VER || h.size > sizeof(PersistentConfig) ||
+      n != sizeof(h) + h.size || crc32(payload, h.size, crc32(&h.seq, sizeof(h.seq))) != h.crc) {
+    return false;
+  }
+  // Shorter record from older firmware: the new fields keep their defaults
+  setDefaults(out);
+  memcpy((void*)&out, payload, h.size);
+  seq = h.seq;
+  return true;
 }
 
 bool ConfigStore::load(PersistentConfig& out) {
-  if (!LittleFS.exists(_path)) return false;
+  _seq = 0;
+  _slot = -1;
+  for (uint8_t s = 0; s < 2; s++) {
+    PersistentConfig cfg;
+    uint32_t seq;
+    if (readSlot(s, cfg, seq) && (_slot < 0 || (int32_t)(seq - _seq) > 0)) {
+      out = cfg;
+      _seq = seq;
+      _slot = s;
+    }
+  }
+  if (_slot >= 0) return true;
+
+  if (!loadLegacyJson(out)) return false;
+  Serial.println("ConfigStore: migrating /config.json");
+  if (save(out)) LittleFS.remove(LEGACY_PATH);
+  return true;
+}
+
+bool ConfigStore::save(const PersistentConfig& cfg) {
+  SlotHeader h;
+  h.magic = MAGIC;
+  h.version = FORMAT_VER;
+  h.size = sizeof(PersistentConfig);
+  h.seq = _seq + 1;
+  h.crc = crc32(&cfg, sizeof(cfg), crc32(&h.seq, sizeof(h.seq)));
+
+  uint8_t slot = _slot == 0 ? 1 : 0;
+  File f = LittleFS.open(SLOT_PATH[slot], "w");
+  if (!f) return false;
+  size_t n = f.write((const uint8_t*)&h, sizeof(h));
+  n += f.write((const uint8_t*)&cfg, sizeof(cfg));
+  f.close();
+  if (n != sizeof(h) + sizeof(cfg)) return false;
+
+  _seq = h.seq;
+  _slot = slot;
+  _saves++;
+  return true;
+}
 
-  File f = LittleFS.open(_path, "r");
+bool ConfigStore::loadLegacyJson(PersistentConfig& out) {
+  if (!LittleFS.exists(LEGACY_PATH)) return false;
+
+  File f = LittleFS.open(LEGACY_PATH, "r");
   if (!f) return false;
 
-  StaticJsonDocument<1024> doc;
+  JsonDocument doc;
   auto err = deserializeJson(doc, f);
   f.close();
   if (err) return false;
 
+  setDefaults(out);
   out.ver = doc["ver"] | 1;
 
   out.wifi.mode = wifiModeFromStr(doc["wifi"]["mode"] | "apsta");
@@ -55,32 +129,3 @@ bool ConfigStore::load(PersistentConfig& out) {
 
   return true;
 }
-
-bool ConfigStore::save(const PersistentConfig& cfg) {
-  StaticJsonDocument<1024> doc;
-
-  doc["ver"] = cfg.ver;
-
-  doc["wifi"]["mode"] = wifiModeToStr(cfg.wifi.mode);
-  doc["wifi"]["apSubnet"] = cfg.wifi.apSubnet;
-  doc["wifi"]["staSsid"] = cfg.wifi.staSsid;
-  doc["wifi"]["staPass"] = cfg.wifi.staPass;
-
-  doc["rev"]["rampMs"]  = cfg.rev.rampMs;
-  doc["rev"]["pauseMs"] = cfg.rev.pauseMs;
-
-  doc["motion"]["startRampMs"] = cfg.motion.startRampMs;
-  doc["motion"]["stopRampMs"]  = cfg.motion.stopRampMs;
-
-  doc["autoRev"]["mode"] = autoRevModeToStr(cfg.autoRev.mode);
-  doc["autoRev"]["interval"] = cfg.autoRev.interval;
-
-  doc["rpm"] = cfg.rpm;
-  doc["dirFwd"] = cfg.dirFwd;
-
-  File f = LittleFS.open(_path, "w");
-  if (!f) return false;
-  bool ok = (serializeJson(doc, f) > 0);
-  f.close();
-  return ok;
-}
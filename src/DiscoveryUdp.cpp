@@ -1,20 +1,70 @@
 #include "DiscoveryUdp.h"
+#include "Clock.h"
 #if defined(ESP32)
   #include <WiFi.h>
+  #include <ESPmDNS.h>
 #else
   #include <ESP8266WiFi.h>
+  #include <ESP8266mDNS.h>
 #endif
+#include <ctype.h>
 #include <string.h>
 
+static const char PROBE[] = "DISCOVER_DIYJOBO";
+
 void DiscoveryUdp::begin(uint16_t port, const char* deviceName, uint16_t httpPort, uint16_t wsPort, const char* fw) {
   _port = port;
   _deviceName = deviceName;
   _httpPort = httpPort;
   _wsPort = wsPort;
   _fw = fw;
+  _msgDirty = true;
+
+  if (_udp.listen(_port)) {
+    _udp.onPacket([this](AsyncUDPPacket& packet) { onPacket(packet); });
+  } else {
+    Serial.printf("Discovery: cannot listen on %u\n", _port);
+  }
+  _lastMs = sysClock.nowMs() - _intervalMs;  // first announcement right away
+  startMdns();
+}
+
+void DiscoveryUdp::startMdns() {
+  // Host name: the device name in lower case, "diy-jobo.local"
+  char host[32];
+  size_t n = 0;
+  for (const char* p = _deviceName; *p && n < sizeof(host) - 1; p++) {
+    host[n++] = (*p == ' ') ? '-' : (char)tolower((unsigned char)*p);
+  }
+  host[n] = '\0';
+
+  _mdns = MDNS.begin(host);
+  if (!_mdns) {
+    Serial.println("Discovery: mDNS failed");
+    return;
+  }
+  char ws[8];
+  snprintf(ws, sizeof(ws), "%u", _wsPort);
+  MDNS.addService("http", "tcp", _httpPort);
+  MDNS.addService("diyjobo", "tcp", _wsPort);
+  MDNS.addServiceTxt("diyjobo", "tcp", "ws", ws);
+  MDNS.addServiceTxt("diyjobo", "tcp", "fw", _fw);
+  Serial.printf("Discovery: mDNS %s.local\n", host);
+}
+
+void DiscoveryUdp::setDeviceName(const char* name) {
+  _deviceName = name;
+  _msgDirty = true;
+}
 
-  _udp.begin(_port);
-  _lastMs = 0;
+void DiscoveryUdp::setClientsConnected(bool any) {
+  if (any == _backoff) return;
+  _backoff = any;
+  if (!any) {
+    // Nobody listening: announce at the base rate again, starting now
+    _intervalMs = BASE_INTERVAL_MS;
+    _lastMs = sysClock.nowMs() - _intervalMs;
+  }
 }
 
 bool DiscoveryUdp::getActiveIpAndBroadcast(IPAddress& ip, IPAddress& bc) {
@@ -37,60 +87,66 @@ bool DiscoveryUdp::getActiveIpAndBroadcast(IPAddress& ip, IPAddress& bc) {
   return true;
 }
 
-void DiscoveryUdp::tick() {
-  handleIncoming();
-
-  uint32_t now = millis();
-  if (now - _lastMs >= _intervalMs) {
-    _lastMs = now;
-    sendAnnounce();
-  }
-}
-
-void DiscoveryUdp::handleIncoming() {
-  int psize = _udp.parsePacket();
-  if (psize <= 0) return;
-
-  char buf[64];
-  int len = _udp.read(buf, sizeof(buf)-1);
-  if (len <= 0) return;
-  buf[len] = 0;
-
-  if (strcmp(buf, "DISCOVER_DIYJOBO") != 0) return;
-
-  IPAddress ip, bc;
-  if (!getActiveIpAndBroadcast(ip, bc)) return;
+void DiscoveryUdp::refreshMessage(const IPAddress& ip) {
+  if (!_msgDirty && ip == _msgIp) return;
 
-  char reply[200];
-  snprintf(
-    reply, sizeof(reply),
+  int len = snprintf(
+    _msg, sizeof(_msg),
     "DIYJOBO;name=%s;ip=%u.%u.%u.%u;http=%u;ws=%u;fw=%s",
     _deviceName,
     ip[0], ip[1], ip[2], ip[3],
     _httpPort, _wsPort,
     _fw
   );
-
-  _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
-  _udp.write((const uint8_t*)reply, strlen(reply));
-  _udp.endPacket();
+  _msgLen = len < (int)sizeof(_msg) ? len : sizeof(_msg) - 1;
+  _msgIp = ip;
+  _msgDirty = false;
 }
 
-void DiscoveryUdp::sendAnnounce() {
+void DiscoveryUdp::tick() {
+#if !defined(ESP32)
+  if (_mdns) MDNS.update();  // ESP32 runs its responder in its own task
+#endif
+  answerProbes();
+
+  uint32_t now = sysClock.nowMs();
+  if (now - _lastMs < _intervalMs) return;
+  _lastMs = now;
   IPAddress ip, bc;
   if (!getActiveIpAndBroadcast(ip, bc)) return;
+  refreshMessage(ip);
+  sendAnnounce(bc);
+  if (_backoff && _intervalMs < MAX_INTERVAL_MS) {
+    _intervalMs = _intervalMs * 2 > MAX_INTERVAL_MS ? MAX_INTERVAL_MS : _intervalMs * 2;
+  }
+}
 
-  char msg[200];
-  snprintf(
-    msg, sizeof(msg),
-    "DIYJOBO;name=%s;ip=%u.%u.%u.%u;http=%u;ws=%u;fw=%s",
-    _deviceName,
-    ip[0], ip[1], ip[2], ip[3],
-    _httpPort, _wsPort,
-    _fw
-  );
+void DiscoveryUdp::onPacket(AsyncUDPPacket& packet) {
+  // Callback context: just queue the requester
+  if (packet.length() != sizeof(PROBE) - 1 ||
+      memcmp(packet.data(), PROBE, sizeof(PROBE) - 1) != 0) {
+    return;
+  }
+  uint8_t head = _probeHead;
+  uint8_t next = (head + 1) % PROBES;
+  if (next == _probeTail) return;  // full - the client will probe again
+  _probes[head].ip = packet.remoteIP();
+  _probes[head].port = packet.remotePort();
+  _probeHead = next;
+}
+
+void DiscoveryUdp::answerProbes() {
+  if (_probeTail == _probeHead) return;
+  IPAddress ip, bc;
+  bool up = getActiveIpAndBroadcast(ip, bc);
+  if (up) refreshMessage(ip);
+  while (_probeTail != _probeHead) {
+    const Probe& p = _probes[_probeTail];
+    if (up) _udp.writeTo((const uint8_t*)_msg, _msgLen, p.ip, p.port);
+    _probeTail = (_probeTail + 1) % PROBES;
+  }
+}
 
-  _udp.beginPacket(bc, _port);
-  _udp.write((const uint8_t*)msg, strlen(msg));
-  _udp.endPacket();
+void DiscoveryUdp::sendAnnounce(const IPAddress& bc) {
+  _udp.writeTo((const uint8_t*)_msg, _msgLen, bc, _port);
 }
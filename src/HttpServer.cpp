@@ -0,0 +1,293 @@
+#include "HttpServer.h"
+#include "Clock.h"
+#include "Crc32.h"
+#include <string.h>
+#include <strings.h>
+#if defined(ESP32)
+  #include <lwip/sockets.h>
+#endif
+
+namespace {
+const char* const WWW_DIR = "/www";
+const char* const GZ = ".gz";
+const char* const CSV_URL = "/telemetry.csv";
+
+// Print into a fixed buffer; whatever doesn't fit is dropped
+class BufPrint : public Print {
+public:
+  BufPrint(uint8_t* buf, size_t cap) : _buf(buf), _cap(cap) {}
+  using Print::write;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* p, size_t n) override {
+    if (n > _cap - _len) n = _cap - _len;
+    memcpy(_buf + _len, p, n);
+    _len += n;
+    return n;
+  }
+  size_t length() const { return _len; }
+
+private:
+  uint8_t* _buf;
+  size_t _cap;
+  size_t _len = 0;
+};
+} // namespace
+
+void HttpServer::begin() {
+  // ETags once per boot: the filesystem image only changes with an upload
+  _assetCount = 0;
+#if defined(ESP32)
+  File dir = LittleFS.open(WWW_DIR);
+  if (dir && dir.isDirectory()) {
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+      const char* name = strrchr(f.name(), '/');
+      addAsset(name ? name + 1 : f.name(), f);
+      f.close();
+    }
+  }
+#else
+  Dir dir = LittleFS.openDir(WWW_DIR);
+  while (dir.next()) {
+    File f = dir.openFile("r");
+    addAsset(dir.fileName().c_str(), f);
+    f.close();
+  }
+#endif
+  _server.begin();
+  Serial.printf("Http: %u assets\n", _assetCount);
+}
+
+void HttpServer::addAsset(const char* name, File& f) {
+  size_t n = strlen(name);
+  if (!f || n <= 3 || strcmp(name + n - 3, GZ) != 0) return;
+  if (_assetCount >= MAX_ASSETS || n - 3 + 1 >= sizeof(Asset::url)) {
+    Serial.printf("Http: skipping %s\n", name);
+    return;
+  }
+  Asset& a = _assets[_assetCount++];
+  a.url[0] = '/';
+  memcpy(a.url + 1, name, n - 3);
+  a.url[n - 2] = '\0';
+  a.size = f.size();
+  uint32_t crc = 0;
+  size_t got;
+  while ((got = f.read(_buf, sizeof(_buf))) > 0) crc = crc32(_buf, got, crc);
+  a.etag = crc;
+}
+
+const HttpServer::Asset* HttpServer::find(const char* path) const {
+  const char* p = strcmp(path, "/") == 0 ? "/index.html" : path;
+  for (uint8_t i = 0; i < _assetCount; i++) {
+    if (strcmp(_assets[i].url, p) == 0) return &_assets[i];
+  }
+  return nullptr;
+}
+
+const char* HttpServer::contentType(const char* url) {
+  const char* ext = strrchr(url, '.');
+  if (!ext) return "application/octet-stream";
+  if (!strcmp(ext, ".html")) return "text/html; charset=utf-8";
+  if (!strcmp(ext, ".js")) return "application/javascript";
+  if (!strcmp(ext, ".css")) return "text/css";
+  if (!strcmp(ext, ".svg")) return "image/svg+xml";
+  if (!strcmp(ext, ".json")) return "application/json";
+  if (!strcmp(ext, ".ico")) return "image/x-icon";
+  return "application/octet-stream";
+}
+
+size_t HttpServer::writable(WiFiClient& client) {
+  if (!client.connected()) return 0;
+#if defined(ESP32)
+  // Same as WsTransport::writable - no send-buffer query on ESP32
+  int fd = client.fd();
+  if (fd < 0) return 0;
+  fd_set wfds;
+  FD_ZERO(&wfds);
+  FD_SET(fd, &wfds);
+  timeval tv = {0, 0};
+  return select(fd + 1, nullptr, &wfds, nullptr, &tv) > 0 ? 1460 : 0;
+#else
+  return client.availableForWrite();
+#endif
+}
+
+void HttpServer::service() {
+  accept();
+  uint32_t now = sysClock.nowMs();
+  for (Conn& c : _conn) {
+    if (c.state == State::Idle) continue;
+    uint32_t limit = c.state == State::Request ? REQUEST_TIMEOUT_MS : SEND_TIMEOUT_MS;
+    if (!c.client.connected() || now - c.startMs > limit) {
+      close(c);
+      continue;
+    }
+    if (c.state == State::Request) readRequest(c);
+    if (c.state == State::Sending) {
+      if (c.csv) sendCsv(c);
+      else sendFile(c);
+    }
+  }
+}
+
+void HttpServer::accept() {
+  WiFiClient client = _server.available();
+  if (!client) return;
+  for (Conn& c : _conn) {
+    if (c.state != State::Idle) continue;
+    c = Conn{};
+    c.client = client;
+    c.client.setNoDelay(true);
+    c.state = State::Request;
+    c.startMs = sysClock.nowMs();
+    return;
+  }
+  // Both slots busy: the browser retries
+  client.stop();
+}
+
+void HttpServer::readRequest(Conn& c) {
+  int avail = c.client.available();
+  while (avail > 0 && c.state == State::Request) {
+    int n = c.client.read(_buf, avail < (int)sizeof(_buf) ? avail : sizeof(_buf));
+    if (n <= 0) return;
+    avail -= n;
+    for (int i = 0; i < n && c.state == State::Request; i++) {
+      char ch = (char)_buf[i];
+      if (ch == '\r') continue;
+      if (ch != '\n') {
+        if (c.lineLen < sizeof(c.line) - 1) c.line[c.lineLen++] = ch;  // long lines are cut
+        continue;
+      }
+      c.line[c.lineLen] = '\0';
+      if (c.lineLen == 0) respond(c);  // end of headers
+      else parseLine(c);
+      c.lineLen = 0;
+    }
+  }
+}
+
+void HttpServer::parseLine(Conn& c) {
+  if (c.firstLine) {
+    // "GET /path?query HTTP/1.1"
+    c.firstLine = false;
+    c.isGet = strncmp(c.line, "GET ", 4) == 0;
+    const char* p = strchr(c.line, ' ');
+    size_t n = 0;
+    if (p) {
+      for (p++; *p && *p != ' ' && *p != '?' && n < sizeof(c.path) - 1; p++) c.path[n++] = *p;
+    }
+    c.path[n] = '\0';
+    return;
+  }
+  static const char INM[] = "If-None-Match:";
+  if (strncasecmp(c.line, INM, sizeof(INM) - 1) == 0) {
+    const char* q = strchr(c.line, '"');
+    if (q) {
+      c.ifNoneMatch = strtoul(q + 1, nullptr, 16);
+      c.hasIfNoneMatch = true;
+    }
+  }
+}
+
+void HttpServer::respond(Conn& c) {
+  if (!c.isGet) {
+    sendEmpty(c, "405 Method Not Allowed");
+    return;
+  }
+  if (_telemetry && strcmp(c.path, CSV_URL) == 0) {
+    // Length unknown up front: the body ends when the connection closes
+    int n = snprintf((char*)_buf, sizeof(_buf),
+                     "HTTP/1.1 200 OK\r\nContent-Type: text/csv\r\n"
+                     "Content-Disposition: attachment; filename=\"telemetry.csv\"\r\n"
+                     "Cache-Control: no-store\r\nConnection: close\r\n\r\n");
+    c.client.write(_buf, n);
+    c.csv = true;
+    c.startMs = sysClock.nowMs();
+    c.state = State::Sending;
+    _served++;
+    return;
+  }
+  const Asset* a = find(c.path);
+  if (!a) {
+    sendEmpty(c, "404 Not Found");
+    return;
+  }
+
+  const char* type = contentType(a->url);
+  char cache[32];
+  if (strncmp(type, "text/html", 9) == 0) strcpy(cache, "no-cache");
+  else snprintf(cache, sizeof(cache), "max-age=%lu", (unsigned long)ASSET_MAX_AGE_S);
+
+  if (c.hasIfNoneMatch && c.ifNoneMatch == a->etag) {
+    int n = snprintf((char*)_buf, sizeof(_buf),
+                     "HTTP/1.1 304 Not Modified\r\nETag: \"%08lx\"\r\nCache-Control: %s\r\n"
+                     "Connection: close\r\n\r\n", (unsigned long)a->etag, cache);
+    c.client.write(_buf, n);
+    _notModified++;
+    close(c);
+    return;
+  }
+
+  char path[32];
+  snprintf(path, sizeof(path), "%s%s%s", WWW_DIR, a->url, GZ);
+  c.file = LittleFS.open(path, "r");
+  if (!c.file) {
+    sendEmpty(c, "500 Internal Server Error");
+    return;
+  }
+  int n = snprintf((char*)_buf, sizeof(_buf),
+                   "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Encoding: gzip\r\n"
+                   "Content-Length: %lu\r\nETag: \"%08lx\"\r\nCache-Control: %s\r\n"
+                   "Connection: close\r\n\r\n",
+                   type, (unsigned long)a->size, (unsigned long)a->etag, cache);
+  // The header fits an empty socket buffer; the body waits for room
+  c.client.write(_buf, n);
+  c.left = a->size;
+  c.startMs = sysClock.nowMs();
+  c.state = State::Sending;
+  _served++;
+}
+
+void HttpServer::sendFile(Conn& c) {
+  size_t room = writable(c.client);
+  if (room == 0) return;
+  size_t n = room < sizeof(_buf) ? room : sizeof(_buf);
+  if (n > c.left) n = c.left;
+  size_t got = c.file.read(_buf, n);
+  if (got == 0 || c.client.write(_buf, got) != got) {
+    close(c);
+    return;
+  }
+  c.left -= got;
+  if (c.left == 0) close(c);
+}
+
+void HttpServer::sendCsv(Conn& c) {
+  size_t room = writable(c.client);
+  if (room > sizeof(_buf)) room = sizeof(_buf);
+  uint16_t lines = room / CSV_LINE_BYTES;
+  if (lines == 0) return;
+  if (!c.cursor.started) lines--;   // the header takes one
+  BufPrint out(_buf, room);
+  bool done = _telemetry->exportCsv(out, c.cursor, lines);
+  if (c.client.write(_buf, out.length()) != out.length()) {
+    close(c);
+    return;
+  }
+  // A long recording may take a while; only a stalled socket times out
+  c.startMs = sysClock.nowMs();
+  if (done) close(c);
+}
+
+void HttpServer::sendEmpty(Conn& c, const char* status) {
+  int n = snprintf((char*)_buf, sizeof(_buf),
+                   "HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status);
+  c.client.write(_buf, n);
+  close(c);
+}
+
+void HttpServer::close(Conn& c) {
+  if (c.file) c.file.close();
+  c.client.stop();
+  c.state = State::Idle;
+}
@@ -1,4 +1,5 @@
 #include "Inputs.h"
+#include "Clock.h"
 
 void Inputs::begin() {
   pinMode(PIN_ENC_A, INPUT_PULLUP);
@@ -13,19 +14,19 @@ void Inputs::begin() {
 
   _a0Back.begin();  // Use defaults: 700/300 thresholds, 30ms debounce, 600ms long
   
-  _startupMs = millis();
+  _startupMs = sysClock.nowMs();
 }
 
 InputsSnapshot Inputs::tick() {
   InputsSnapshot s{};
   
   // Ignore button presses during startup (analog settling)
-  bool ignoreButtons = (millis() - _startupMs) < STARTUP_IGNORE_MS;
+  bool ignoreButtons = (sysClock.nowMs() - _startupMs) < STARTUP_IGNORE_MS;
 
   // --- encoder (polling, falling edge only, debounced by time) ---
   int a = digitalRead(PIN_ENC_A);
   if (a != _lastEncA) {
-    uint32_t now = micros();
+    uint32_t now = sysClock.nowUs32();
     if (now - _encLastUs > ENC_DEBOUNCE_US) {
       if (a == LOW) {
         int b = digitalRead(PIN_ENC_B);
@@ -49,7 +50,7 @@ InputsSnapshot Inputs::tick() {
   _lastBack = back;
 
 bool sw = digitalRead(PIN_ENC_SW);
-uint32_t nowMs = millis();
+uint32_t nowMs = sysClock.nowMs();
 
 s.encSwRawHigh = (sw == HIGH);
 s.encSwDown = (sw == LOW);
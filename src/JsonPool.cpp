@@ -0,0 +1,45 @@
+#include "JsonPool.h"
+#include <string.h>
+
+void* JsonPool::allocate(size_t size) {
+  size_t need = HEADER + round(size);
+  if (need > _size - _used) {
+    _failures++;
+    return nullptr;
+  }
+  uint8_t* p = _buf + _used + HEADER;
+  blockSize(p) = round(size);
+  _used += need;
+  if (_used > _peak) _peak = _used;
+  _last = p;
+  return p;
+}
+
+void JsonPool::deallocate(void* ptr) {
+  if (!ptr || ptr != _last) return;  // left for reset()
+  _used = (uint8_t*)ptr - HEADER - _buf;
+  _last = nullptr;
+}
+
+void* JsonPool::reallocate(void* ptr, size_t newSize) {
+  if (!ptr) return allocate(newSize);
+  size_t old = blockSize(ptr);
+  size_t want = round(newSize);
+  if (ptr == _last) {
+    size_t start = (uint8_t*)ptr - _buf;
+    if (want > _size - start) {
+      _failures++;
+      return nullptr;
+    }
+    // Newest block: grow or shrink where it is
+    blockSize(ptr) = want;
+    _used = start + want;
+    if (_used > _peak) _peak = _used;
+    return ptr;
+  }
+  if (want <= old) return ptr;
+  void* p = allocate(newSize);
+  if (!p) return nullptr;
+  memcpy(p, ptr, old);
+  return p;
+}
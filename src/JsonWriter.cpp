@@ -0,0 +1,134 @@
+#include "JsonWriter.h"
+#include <math.h>
+
+JsonWriter::JsonWriter(char* buf, size_t cap) : _buf(buf), _cap(cap) {
+  if (_cap == 0) _overflow = true;
+  else _buf[0] = '\0';
+}
+
+void JsonWriter::put(char c) {
+  // Keep room for the terminator
+  if (_len + 1 >= _cap) {
+    _overflow = true;
+    return;
+  }
+  _buf[_len++] = c;
+  _buf[_len] = '\0';
+}
+
+void JsonWriter::put(const char* s) {
+  while (*s) put(*s++);
+}
+
+void JsonWriter::putString(const char* s) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  put('"');
+  for (; *s; s++) {
+    uint8_t c = (uint8_t)*s;
+    if (c == '"' || c == '\\') {
+      put('\\');
+      put((char)c);
+    } else if (c < 0x20) {
+      put("\\u00");
+      put(HEX_DIGITS[c >> 4]);
+      put(HEX_DIGITS[c & 0x0F]);
+    } else {
+      put((char)c);
+    }
+  }
+  put('"');
+}
+
+void JsonWriter::putUnsigned(unsigned long v) {
+  char tmp[20];   // 64-bit unsigned long on the host builds
+  uint8_t n = 0;
+  do {
+    tmp[n++] = (char)('0' + v % 10);
+    v /= 10;
+  } while (v);
+  while (n) put(tmp[--n]);
+}
+
+void JsonWriter::key(const char* k) {
+  uint16_t bit = 1u << _depth;
+  if (_hasItems & bit) put(',');
+  _hasItems |= bit;
+  if (k) {
+    putString(k);
+    put(':');
+  }
+}
+
+JsonWriter& JsonWriter::open(char bracket, const char* k) {
+  if (_depth > 0) key(k);
+  put(bracket);
+  if (_depth < MAX_DEPTH) _depth++;
+  else _overflow = true;
+  _hasItems &= ~(1u << _depth);
+  return *this;
+}
+
+JsonWriter& JsonWriter::close(char bracket) {
+  put(bracket);
+  if (_depth > 0) _depth--;
+  return *this;
+}
+
+JsonWriter& JsonWriter::item(const char* v) {
+  return field(nullptr, v);
+}
+
+JsonWriter& JsonWriter::field(const char* k, const char* v) {
+  key(k);
+  if (v) putString(v);
+  else put("null");
+  return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* k, bool v) {
+  key(k);
+  put(v ? "true" : "false");
+  return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* k, long v) {
+  key(k);
+  if (v < 0) {
+    put('-');
+    putUnsigned(0UL - (unsigned long)v);
+  } else {
+    putUnsigned((unsigned long)v);
+  }
+  return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* k, unsigned long v) {
+  key(k);
+  putUnsigned(v);
+  return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* k, float v, uint8_t decimals) {
+  key(k);
+  if (isnan(v) || isinf(v)) {
+    put("null");
+    return *this;
+  }
+  if (decimals > 6) decimals = 6;
+  unsigned long scale = 1;
+  for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+  // Fixed point; values beyond the range are clamped (nothing we send is that big)
+  double scaled = fabs((double)v) * scale + 0.5;
+  if (scaled > 4.0e9) scaled = 4.0e9;
+  unsigned long q = (unsigned long)scaled;
+  if (v < 0 && q > 0) put('-');
+  putUnsigned(q / scale);
+  if (decimals) {
+    put('.');
+    unsigned long frac = q % scale;
+    for (unsigned long d = scale / 10; d > 0; d /= 10) {
+      put((char)('0' + (frac / d) % 10));
+    }
+  }
+  return *this;
+}
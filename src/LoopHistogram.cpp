@@ -0,0 +1,48 @@
+#include "LoopHistogram.h"
+
+void LoopHistogram::record(uint32_t us) {
+  uint8_t b = 0;
+  uint32_t v = us >> FIRST_SHIFT;
+  while (v && b < BUCKETS - 1) {
+    v >>= 1;
+    b++;
+  }
+  _buckets[b]++;
+  _count++;
+  _sumUs += us;
+  if (us > _maxUs) _maxUs = us;
+}
+
+void LoopHistogram::reset() {
+  *this = LoopHistogram{};
+}
+
+uint32_t LoopHistogram::percentileUs(float p) const {
+  if (_count == 0) return 0;
+  uint32_t need = (uint32_t)ceilf(_count * p);
+  uint32_t seen = 0;
+  for (uint8_t b = 0; b < BUCKETS - 1; b++) {
+    seen += _buckets[b];
+    if (seen >= need) return upperBoundUs(b);
+  }
+  return _maxUs;
+}
+
+void LoopHistogram::print(Print& out) const {
+  char line[72];
+  snprintf(line, sizeof(line), "loop: %lu passes, mean %lu us, max %lu us",
+           (unsigned long)_count, (unsigned long)(_count ? _sumUs / _count : 0),
+           (unsigned long)_maxUs);
+  out.println(line);
+  for (uint8_t b = 0; b < BUCKETS; b++) {
+    if (_buckets[b] == 0) continue;
+    if (b < BUCKETS - 1) {
+      snprintf(line, sizeof(line), "  < %6lu us: %lu", (unsigned long)upperBoundUs(b),
+               (unsigned long)_buckets[b]);
+    } else {
+      snprintf(line, sizeof(line), "  >=%6lu us: %lu", (unsigned long)upperBoundUs(b - 1),
+               (unsigned long)_buckets[b]);
+    }
+    out.println(line);
+  }
+}
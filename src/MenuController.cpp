@@ -1,9 +1,28 @@
 #include "MenuController.h"
+#include "ModuleProfiler.h"
 
 void MenuController::begin(SessionController* session) {
   _session = session;
 }
 
+BuzzerSettings MenuController::buzzerSettings() const {
+  BuzzerSettings bs;
+  bs.enabled = _editBuzzerEnabled;
+  bs.onStepFinished = _editBuzzerStepFinished;
+  bs.onProcessEnded = _editBuzzerProcessEnded;
+  bs.onTempWarning = _editBuzzerTempWarning;
+  bs.freqHz = _editBuzzerFreq;
+  return bs;
+}
+
+void MenuController::setBuzzerSettings(const BuzzerSettings& bs) {
+  _editBuzzerEnabled = bs.enabled;
+  _editBuzzerStepFinished = bs.onStepFinished;
+  _editBuzzerProcessEnded = bs.onProcessEnded;
+  _editBuzzerTempWarning = bs.onTempWarning;
+  _editBuzzerFreq = bs.freqHz;
+}
+
 bool MenuController::handleInput(const InputsSnapshot& s) {
   bool settingsChanged = false;
   
@@ -153,8 +172,15 @@ bool MenuController::handleInput(const InputsSnapshot& s) {
     case Screen::EditTempOffset:
       settingsChanged = handleEditTempOffset(s);
       break;
+    case Screen::ResumePrompt:
+      handleResumePrompt(s);
+      break;
+    case Screen::Diagnostics:
+      handleDiagnostics(s);
+      break;
   }
   
+  if (settingsChanged && _session) _session->bumpSettingsVersion();
   return settingsChanged;
 }
 
@@ -166,6 +192,7 @@ void MenuController::handleMainScreen(const InputsSnapshot& s) {
     set.targetRpm += s.encDelta;
     if (set.targetRpm < RPM_MIN) set.targetRpm = RPM_MIN;
     if (set.targetRpm > RPM_MAX) set.targetRpm = RPM_MAX;
+    _session->bumpSettingsVersion();
   }
 
   if (s.okPressed) {
@@ -217,8 +244,9 @@ void MenuController::handleMenuScreen(const InputsSnapshot& s) {
 
 // ===== Profile Submenu =====
 void MenuController::handleProfileMenu(const InputsSnapshot& s) {
-  // Items: Custom (future: Default, Profile1, Profile2, etc.)
-  const int8_t ITEMS = 1;
+  // Items: Current settings, saved profiles (headers only), Save current
+  const int8_t saved = _profiles ? _profiles->count() : 0;
+  const int8_t ITEMS = 1 + saved + (_profiles ? 1 : 0);
   
   if (s.encDelta != 0) {
     _subMenuIdx += s.encDelta;
@@ -227,12 +255,29 @@ void MenuController::handleProfileMenu(const InputsSnapshot& s) {
   }
 
   if (s.okPressed || s.encSwPressed) {
-    switch (_subMenuIdx) {
-      case 0:  // Custom profile
+    if (_subMenuIdx == 0) {
+      // Current settings
+      _screen = Screen::ProfileEditMenu;
+    } else if (_subMenuIdx <= saved) {
+      // Never swap the steps under a session in progress
+      if (!_session->inProgress() && _profiles->load(_subMenuIdx - 1, _session->settings())) {
+        _activeProfile = _subMenuIdx - 1;
+        _session->bumpSettingsVersion();
         _subMenuIdx = 0;
         _screen = Screen::ProfileEditMenu;
-        break;
-      // Future: case 1: Default profile, case 2: Profile1, etc.
+      }
+    } else {
+      saveCurrentProfile();
+    }
+  }
+
+  // Long press on a saved profile deletes it
+  if (s.encSwLongPress && _subMenuIdx >= 1 && _subMenuIdx <= saved) {
+    int8_t idx = _subMenuIdx - 1;
+    if (_profiles->remove(idx)) {
+      if (_activeProfile == idx) _activeProfile = -1;
+      else if (_activeProfile > idx) _activeProfile--;
+      if (_subMenuIdx > _profiles->count()) _subMenuIdx = _profiles->count();
     }
   }
 
@@ -241,6 +286,15 @@ void MenuController::handleProfileMenu(const InputsSnapshot& s) {
   }
 }
 
+void MenuController::saveCurrentProfile() {
+  auto& set = _session->settings();
+  if (set.profileName[0] == '\0') {
+    snprintf(set.profileName, sizeof(set.profileName), "Profile %d", _profiles->count() + 1);
+  }
+  int8_t idx = _profiles->save(set, _activeProfile);
+  if (idx >= 0) _activeProfile = idx;
+}
+
 void MenuController::handleProfileEditMenu(const InputsSnapshot& s) {
   // Items: Settings, Steps
   const int8_t ITEMS = 2;
@@ -353,6 +407,7 @@ void MenuController::handleStepsMenu(const InputsSnapshot& s) {
       step.tempBias = 2.0f;
       step.name[0] = '\0';
       set.stepCount++;
+      _session->bumpSettingsVersion();
       _editStepIdx = set.stepCount - 1;
       _editStepDetailIdx = 0;
       _screen = Screen::StepDetailMenu;
@@ -366,6 +421,7 @@ void MenuController::handleStepsMenu(const InputsSnapshot& s) {
       set.steps[i] = set.steps[i + 1];
     }
     set.stepCount--;
+    _session->bumpSettingsVersion();
     if (_subMenuIdx >= set.stepCount) _subMenuIdx = set.stepCount - 1;
   }
 
@@ -1151,6 +1207,19 @@ void MenuController::handleBuzzerTest(const InputsSnapshot& s) {
   }
 }
 
+// ===== Resume prompt =====
+void MenuController::handleResumePrompt(const InputsSnapshot& s) {
+  if (s.okPressed || s.encSwPressed) {
+    if (_resumeCb) _resumeCb(true);
+    _screen = Screen::Main;
+  }
+
+  if (s.backPressed || s.a0BackPressed) {
+    if (_resumeCb) _resumeCb(false);
+    _screen = Screen::Main;
+  }
+}
+
 // ===== Hardware Submenu =====
 void MenuController::handleHardwareMenu(const InputsSnapshot& s) {
   const int8_t ITEMS = 7;  // StepsPerRev, Microsteps, Driver, Invert, BuzzerType, ActiveHigh, TempOffset
@@ -1194,11 +1263,28 @@ void MenuController::handleHardwareMenu(const InputsSnapshot& s) {
     }
   }
 
+  if (s.encSwLongPress) {
+    _diagScroll = 0;
+    _screen = Screen::Diagnostics;
+  }
+
   if (s.backPressed || s.a0BackPressed) {
     _screen = Screen::Menu;
   }
 }
 
+void MenuController::handleDiagnostics(const InputsSnapshot& s) {
+  if (s.encDelta != 0) {
+    _diagScroll += s.encDelta;
+    if (_diagScroll < 0) _diagScroll = 0;
+    if (_diagScroll > PS_COUNT - DIAG_ROWS) _diagScroll = PS_COUNT - DIAG_ROWS;
+  }
+
+  if (s.backPressed || s.a0BackPressed || s.okPressed || s.encSwPressed) {
+    _screen = Screen::HardwareMenu;
+  }
+}
+
 bool MenuController::handleEditStepsPerRev(const InputsSnapshot& s) {
   bool changed = false;
   
@@ -0,0 +1,107 @@
+#include "ModuleProfiler.h"
+#include <string.h>
+
+namespace {
+const char* const NAMES[PS_COUNT] = {"input", "menu",  "temp", "session", "record",
+                                     "buzzer", "store", "ui",   "console", "net"};
+} // namespace
+
+const char* ModuleProfiler::name(ProfSection s) {
+  return s < PS_COUNT ? NAMES[s] : "?";
+}
+
+void ModuleProfiler::begin() {
+#if defined(ESP32) || defined(ESP8266)
+  _cyclesPerUs = ESP.getCpuFreqMHz();
+#endif
+  if (_cyclesPerUs == 0) _cyclesPerUs = 1;
+  _windowStartMs = sysClock.nowMs();
+}
+
+void ModuleProfiler::record(ProfSection s, uint32_t cyc) {
+  Section& sec = _cur[s];
+  sec.runs++;
+  if (sec.runs > _maxRuns) _maxRuns = sec.runs;
+  sec.sumCyc += cyc;
+  if (cyc < sec.minCyc) sec.minCyc = cyc;
+  if (cyc > sec.maxCyc) sec.maxCyc = cyc;
+
+  uint8_t b = 0;
+  uint32_t v = cyclesToUs(cyc) >> 1;
+  while (v && b < BUCKETS - 1) {
+    v >>= 1;
+    b++;
+  }
+  sec.buckets[b]++;
+}
+
+void ModuleProfiler::endPass() {
+  _passes++;
+  uint32_t now = sysClock.nowMs();
+  uint32_t elapsed = now - _windowStartMs;
+  if (elapsed < WINDOW_MS && _maxRuns < MAX_RUNS) return;
+  memcpy(_last, _cur, sizeof(_last));
+  for (uint8_t i = 0; i < PS_COUNT; i++) _cur[i] = Section{};
+  _lastWindowMs = elapsed ? elapsed : 1;
+  _lastPasses = _passes;
+  _passes = 0;
+  _maxRuns = 0;
+  _windowStartMs = now;
+}
+
+ModuleProfiler::Stats ModuleProfiler::stats(ProfSection s) const {
+  Stats st;
+  const Section& sec = _last[s];
+  if (sec.runs == 0) return st;
+  st.runs = sec.runs;
+  st.minUs = cyclesToUs(sec.minCyc);
+  st.maxUs = cyclesToUs(sec.maxCyc);
+  st.meanUs = cyclesToUs(sec.sumCyc / sec.runs);
+
+  // Smallest bucket bound that covers 99% of the runs
+  uint32_t need = sec.runs - sec.runs / 100;
+  uint32_t seen = 0;
+  st.p99Us = st.maxUs;
+  for (uint8_t b = 0; b < BUCKETS - 1; b++) {
+    seen += sec.buckets[b];
+    if (seen >= need) {
+      st.p99Us = upperBoundUs(b) < st.maxUs ? upperBoundUs(b) : st.maxUs;
+      break;
+    }
+  }
+  return st;
+}
+
+void ModuleProfiler::print(Print& out) const {
+  char line[96];
+  if (!ready()) {
+    out.println("profile: first window not complete yet");
+    return;
+  }
+  snprintf(line, sizeof(line), "profile: last %lu ms, %lu passes, %lu MHz",
+           (unsigned long)_lastWindowMs, (unsigned long)windowPasses(),
+           (unsigned long)_cyclesPerUs);
+  out.println(line);
+  out.println("  us per run: runs min mean p99 max");
+  for (uint8_t i = 0; i < PS_COUNT; i++) {
+    Stats st = stats((ProfSection)i);
+    snprintf(line, sizeof(line), "  %-8s %6lu %6lu %6lu %6lu %6lu", NAMES[i],
+             (unsigned long)st.runs, (unsigned long)st.minUs,
+             (unsigned long)st.meanUs, (unsigned long)st.p99Us, (unsigned long)st.maxUs);
+    out.println(line);
+  }
+  // Histograms: "<bound:count", empty buckets left out
+  for (uint8_t i = 0; i < PS_COUNT; i++) {
+    int n = snprintf(line, sizeof(line), "  %-8s", NAMES[i]);
+    for (uint8_t b = 0; b < BUCKETS && n < (int)sizeof(line) - 1; b++) {
+      uint16_t c = _last[i].buckets[b];
+      if (c == 0) continue;
+      if (b < BUCKETS - 1) {
+        n += snprintf(line + n, sizeof(line) - n, " <%lu:%u", (unsigned long)upperBoundUs(b), c);
+      } else {
+        n += snprintf(line + n, sizeof(line) - n, " >=%lu:%u", (unsigned long)upperBoundUs(b - 1), c);
+      }
+    }
+    out.println(line);
+  }
+}
@@ -1,11 +1,12 @@
 #include "MotorController.h"
 #include "StepperISR.h"
+#include "Clock.h"
 #include <math.h>
 
 void MotorController::begin(const MotorConfig& cfg) {
   _cfg = cfg;
-  _lastUs = micros();
-  _lastReverseMs = millis();
+  _lastUs = sysClock.nowUs();
+  _lastReverseMs = sysClock.nowMs();
 }
 
 void MotorController::setRun(bool run) {
@@ -16,9 +17,10 @@ void MotorController::setRun(bool run) {
   // Reset state when starting
   if (run && !_run) {
     _currentRpm = 0.0f;      // Start ramp from zero
-    _lastUs = micros();      // Reset timing to avoid huge dt
-    _lastReverseMs = millis(); // Reset reverse timer
-    _dirFwd = true;          // Start in forward direction
+    _lastUs = sysClock.nowUs();        // Reset timing to avoid huge dt
+    _lastReverseMs = sysClock.nowMs(); // Reset reverse timer
+    _dirFwd = _startFwd;     // Start forward (unless resuming)
+    _startFwd = true;
     _rs = RS_RUN;            // Normal running state
     stepperISR.kickStart();  // Force timer to wake up quickly
     Serial.println("Motor: reset state for fresh start");
@@ -55,12 +57,12 @@ float MotorController::rpmToSps(float rpm) const {
 }
 
 void MotorController::tick() {
-  uint32_t nowUs = micros();
-  float dt = (nowUs - _lastUs) / 1000000.0f;
+  uint64_t nowUs = sysClock.nowUs();
+  if (nowUs <= _lastUs) return;  // same tick
+  float dt = (uint32_t)(nowUs - _lastUs) / 1000000.0f;
   _lastUs = nowUs;
-  if (dt <= 0) return;
 
-  uint32_t nowMs = millis();
+  uint32_t nowMs = sysClock.nowMs();
 
   // reverse trigger
   bool reverseDue =
@@ -103,6 +105,7 @@ void MotorController::tick() {
     }
     if (_rs == RS_SWITCH_DIR) {
       _dirFwd = !_dirFwd;
+      _reversals++;
       _rs = RS_RAMP_UP;
     }
     if (_rs == RS_RAMP_UP && fabs(_currentRpm - _savedTarget) <= 0.01f) {
@@ -0,0 +1,346 @@
+#include "NetService.h"
+#include "Clock.h"
+#include <ArduinoJson.h>
+#if defined(ESP32)
+  #include <WiFi.h>
+#else
+  #include <ESP8266WiFi.h>
+#endif
+
+NetService* NetService::s_self = nullptr;
+
+static_assert(TelemetryStream::FRAME_BYTES <= WsServer::TX_BYTES, "telemetry frame must fit the TX buffer");
+
+void NetService::begin(const WifiConfig& cfg, void (*fillStatus)(Status&)) {
+  s_self = this;
+  _cfg = cfg;
+  _fillStatus = fillStatus;
+
+  // Every key any client message may carry; the rest is skipped while parsing
+  static const char* const KEYS[] = {"type", "enc", "groups", "max_hz", "cmd", "id",
+                                     "rpm", "step", "duration", "name", "index", "hz"};
+  for (const char* key : KEYS) _filter[key] = true;
+
+  // Credentials come from our own config - keep the SDK from writing flash
+  WiFi.persistent(false);
+  bool sta = _cfg.mode != WifiMode::Ap && _cfg.staSsid[0];
+  bool ap = _cfg.mode != WifiMode::Sta || !sta;
+  WiFi.mode(sta && ap ? WIFI_AP_STA : sta ? WIFI_STA : WIFI_AP);
+  if (ap) startAp();
+  if (sta) {
+    WiFi.setAutoReconnect(true);
+    WiFi.begin(_cfg.staSsid, _cfg.staPass);  // connects in the background
+    _staStartMs = sysClock.nowMs();
+    Serial.printf("Net: joining %s\n", _cfg.staSsid);
+  }
+
+  _ws.begin(&NetService::onWsEvent);
+  _http.begin();
+  _discovery.begin(DISCOVERY_PORT, DEVICE_NAME, HTTP_PORT, WS_PORT, FW_VERSION);
+  _started = true;
+}
+
+void NetService::startAp() {
+  IPAddress ip(192, 168, _cfg.apSubnet, 1);
+  WiFi.softAPConfig(ip, ip, IPAddress(255, 255, 255, 0));
+  WiFi.softAP(WIFI_AP_SSID, WIFI_AP_PASS);
+  _apUp = true;
+  Serial.printf("Net: AP %s on 192.168.%u.1\n", WIFI_AP_SSID, _cfg.apSubnet);
+}
+
+void NetService::service(uint32_t budgetUs) {
+  if (!_started) return;
+  uint64_t start = Clock::readUs();
+  for (uint8_t n = 0; n < T_COUNT; n++) {
+    uint64_t t0 = Clock::readUs();
+    runTask(_next);
+    _next = (_next + 1) % T_COUNT;
+    uint64_t now = Clock::readUs();
+    if (now - t0 > _maxTaskUs) _maxTaskUs = (uint32_t)(now - t0);
+    if (n + 1 < T_COUNT && now - start >= budgetUs) {
+      _yields++;
+      return;
+    }
+  }
+}
+
+void NetService::runTask(uint8_t t) {
+  switch (t) {
+    case T_WIFI:      checkWifi(); break;
+    case T_WS:        _ws.loop(); break;
+    case T_TX:        _ws.flush(); break;
+    case T_DISCOVERY: _discovery.tick(); break;
+    case T_STATUS:    pushStatus(); break;
+    case T_HTTP:      _http.service(); break;
+  }
+}
+
+void NetService::checkWifi() {
+  uint32_t now = sysClock.nowMs();
+  if (now - _lastWifiMs < WIFI_CHECK_MS) return;
+  _lastWifiMs = now;
+
+  bool up = WiFi.status() == WL_CONNECTED;
+  if (up != _staUp) {
+    _staUp = up;
+    if (up) {
+      IPAddress ip = WiFi.localIP();
+      Serial.printf("Net: STA connected, %u.%u.%u.%u\n", ip[0], ip[1], ip[2], ip[3]);
+    } else {
+      Serial.println("Net: STA disconnected");
+      _staStartMs = now;
+    }
+  }
+
+  // STA-only config that can't connect: open the AP so the device stays reachable
+  if (!_staUp && !_apUp && _cfg.mode == WifiMode::Sta && now - _staStartMs >= STA_FALLBACK_MS) {
+    Serial.println("Net: STA not connected, AP fallback");
+    WiFi.mode(WIFI_AP_STA);
+    startAp();
+  }
+}
+
+uint8_t NetService::clients() const {
+  uint8_t n = 0;
+  for (const Client& c : _clients) n += c.connected;
+  return n;
+}
+
+void NetService::pushStatus() {
+  if (!_fillStatus) return;
+  uint32_t now = sysClock.nowMs();
+  bool fullDue = now - _lastStatusMs >= STATUS_PUSH_MS;
+  bool deltaDue = false;
+  for (const Client& c : _clients) {
+    if (c.connected && c.groups && now - c.lastSentMs >= c.periodMs) deltaDue = true;
+  }
+  if (!fullDue && !deltaDue) return;
+
+  Status st;
+  _fillStatus(st);
+  if (fullDue) {
+    _lastStatusMs = now;
+    sendStatus(st, -1);
+  }
+  if (deltaDue) sendDeltas(st, now);
+}
+
+void NetService::sendStatus(const Status& st, int8_t only) {
+  bool want[2] = {false, false};
+  auto wants = [&](uint8_t i) {
+    const Client& c = _clients[i];
+    return c.connected && (only < 0 ? c.groups == 0 : only == i);
+  };
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+    if (wants(i)) want[(uint8_t)_clients[i].enc] = true;
+  }
+
+  // Each encoding is built once and the same bytes go to all its clients
+  if (want[(uint8_t)WireEnc::Json]) {
+    JsonWriter w = _ws.writer();
+    writeStatus(w, st);
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      if (wants(i) && _clients[i].enc == WireEnc::Json) _ws.queue(i, w, FrameClass::Status);
+    }
+  }
+  if (want[(uint8_t)WireEnc::Bin]) {
+    size_t len = encodeStatus(_ws.payload(), WsServer::TX_BYTES, st);
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      if (wants(i) && _clients[i].enc == WireEnc::Bin) _ws.queueBin(i, len, FrameClass::Status);
+    }
+  }
+}
+
+void NetService::sendDeltas(const Status& st, uint32_t now) {
+  StatusValues cur;
+  captureStatus(st, cur);
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+    Client& c = _clients[i];
+    if (!c.connected || !c.groups || now - c.lastSentMs < c.periodMs) continue;
+    c.lastSentMs = now;
+    // A dropped delta leaves the client behind - resync with a keyframe
+    if (_ws.takeGap(i)) c.needKey = true;
+
+    uint32_t fields = groupFields(c.groups);
+    bool key = c.needKey || now - c.lastKeyMs >= KEYFRAME_MS;
+    uint32_t changed = key ? fields : fields & changedFields(cur, c.sent);
+    if (!changed) continue;  // rate slot used, nothing to say
+
+    if (c.enc == WireEnc::Bin) {
+      size_t len = encodeStatusDelta(_ws.payload(), WsServer::TX_BYTES, cur, changed, ++c.seq, key);
+      _ws.queueBin(i, len, FrameClass::Status);
+    } else {
+      JsonWriter w = _ws.writer();
+      writeStatusDelta(w, cur, changed, ++c.seq, key);
+      _ws.queue(i, w, FrameClass::Status);
+    }
+    c.sent = cur;
+    if (key) {
+      c.needKey = false;
+      c.lastKeyMs = now;
+    }
+  }
+}
+
+void NetService::handleText(uint8_t num, const uint8_t* payload, size_t len) {
+  uint64_t rxUs = Clock::readUs();
+  _rxPool.reset();  // the last message's document is gone
+  JsonDocument doc(&_rxPool);
+  DeserializationError err = deserializeJson(doc, payload, len, DeserializationOption::Filter(_filter));
+  if (err) {
+    if (err == DeserializationError::NoMemory) Serial.printf("Net: ws message from %u too large\n", num);
+    return;
+  }
+
+  const char* type = doc["type"] | "";
+  if (strcmp(type, "cmd") == 0) {
+    handleCommand(num, doc, rxUs);
+  } else if (strcmp(type, "hello") == 0) {
+    WireEnc enc = wireEncFromStr(doc["enc"] | "json");
+    _clients[num].enc = enc;
+    JsonWriter w = _ws.writer();
+    writeEncAck(w, enc);
+    _ws.queue(num, w, FrameClass::Reliable);
+    if (_fillStatus && _clients[num].groups == 0) {
+      Status st;
+      _fillStatus(st);
+      sendStatus(st, num);
+    }
+    Serial.printf("Net: ws client %u uses %s\n", num, wireEncToStr(enc));
+  } else if (strcmp(type, "sub") == 0) {
+    Client& c = _clients[num];
+    uint8_t groups = 0;
+    for (JsonVariantConst g : doc["groups"].as<JsonArrayConst>()) {
+      groups |= statusGroupFromStr(g.as<const char*>());
+    }
+    float hz = doc["max_hz"] | 1.0f;
+    uint32_t period = hz > 0.0f ? (uint32_t)(1000.0f / hz) : MAX_SUB_PERIOD_MS;
+    if (period < MIN_SUB_PERIOD_MS) period = MIN_SUB_PERIOD_MS;
+    if (period > MAX_SUB_PERIOD_MS) period = MAX_SUB_PERIOD_MS;
+
+    // Empty list = back to the full status push
+    c.groups = groups;
+    c.periodMs = (uint16_t)period;
+    c.needKey = true;
+    c.lastSentMs = sysClock.nowMs() - period;  // first frame on the next pass
+    JsonWriter w = _ws.writer();
+    writeSubAck(w, groups, c.periodMs);
+    _ws.queue(num, w, FrameClass::Reliable);
+  } else if (strcmp(type, "tlm") == 0) {
+    int hz = doc["hz"] | 0;
+    _clients[num].tlmHz = hz <= 0 ? 0 : hz > 255 ? 255 : hz;
+    updateTelemetryRate();
+    JsonWriter w = _ws.writer();
+    writeTlmAck(w, _clients[num].tlmHz ? _tlm.rateHz() : 0, _clients[num].tlmHz ? _tlm.periodMs() : 0);
+    _ws.queue(num, w, FrameClass::Reliable);
+  }
+}
+
+void NetService::updateTelemetryRate() {
+  // One stream at the highest rate asked for
+  uint8_t hz = 0;
+  for (const Client& c : _clients) {
+    if (c.connected && c.tlmHz > hz) hz = c.tlmHz;
+  }
+  _tlm.setRate(hz);
+}
+
+void NetService::addTelemetry(const TelemetrySample& s) {
+  if (!_tlm.add(s, sysClock.nowMs())) return;
+  memcpy(_ws.payload(), _tlm.frame(), _tlm.frameLen());
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+    // Frames stand alone; a dropped one is only a hole in the graph
+    if (_clients[i].connected && _clients[i].tlmHz) {
+      _ws.queueBin(i, _tlm.frameLen(), FrameClass::Status);
+    }
+  }
+  _tlm.next();
+}
+
+void NetService::handleCommand(uint8_t num, JsonDocument& doc, uint64_t rxUs) {
+  Command c;
+  c.client = num;
+  c.id = doc["id"] | 0UL;
+  c.rxUs = rxUs;
+  const char* name = doc["cmd"] | "";
+  bool ok = cmdTypeFromStr(name, c.type);  // type stays Unknown if not
+  // Step and profile numbers are int8_t: range-check before narrowing
+  auto index = [&](const char* key, int8_t& out) {
+    if (!doc[key].is<int>()) return false;
+    int32_t v = doc[key].as<int32_t>();
+    if (v < -1 || v > INT8_MAX) return false;
+    out = (int8_t)v;
+    return true;
+  };
+  if (ok) {
+    switch (c.type) {
+      case CmdType::SetRpm:
+        ok = doc["rpm"].is<int>();
+        c.rpm = doc["rpm"] | 0;
+        break;
+      case CmdType::EditStep:
+        ok = index("step", c.step);
+        if (doc["duration"].is<int>()) {
+          c.fields |= CF_DURATION;
+          c.durationSec = doc["duration"].as<int32_t>();
+        }
+        if (doc["rpm"].is<int>()) {
+          c.fields |= CF_RPM;
+          c.rpm = doc["rpm"].as<int32_t>();
+        }
+        if (doc["name"].is<const char*>()) {
+          c.fields |= CF_NAME;
+          strlcpy(c.name, doc["name"].as<const char*>(), sizeof(c.name));
+        }
+        ok = ok && c.fields;
+        break;
+      case CmdType::LoadProfile:
+        ok = index("index", c.index);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Rejected here are answered right away; the rest when App applies them
+  if (!ok) ackCommand(c, CmdError::BadArgs);
+  else if (!_cmds.push(c)) ackCommand(c, CmdError::Busy);
+}
+
+void NetService::ackCommand(const Command& c, CmdError err) {
+  if (!clientConnected(c.client)) return;
+  uint32_t latencyUs = (uint32_t)(Clock::readUs() - c.rxUs);
+  JsonWriter w = _ws.writer();
+  writeCmdAck(w, c.id, cmdTypeToStr(c.type), err, latencyUs);
+  _ws.queue(c.client, w, FrameClass::Reliable);
+}
+
+void NetService::onWsEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t len) {
+  if (!s_self || num >= MAX_CLIENTS) return;
+  Client& c = s_self->_clients[num];
+  switch (type) {
+    case WStype_CONNECTED: {
+      c = Client{};
+      c.connected = true;
+      s_self->_ws.reset(num);
+      JsonWriter w = s_self->_ws.writer();
+      writeHello(w, FW_VERSION);
+      s_self->_ws.queue(num, w, FrameClass::Reliable);
+      s_self->_discovery.setClientsConnected(true);
+      Serial.printf("Net: ws client %u connected\n", num);
+      break;
+    }
+    case WStype_DISCONNECTED:
+      if (c.connected) Serial.printf("Net: ws client %u disconnected\n", num);
+      c = Client{};
+      s_self->_ws.reset(num);
+      s_self->updateTelemetryRate();
+      s_self->_discovery.setClientsConnected(s_self->clients() > 0);
+      break;
+    case WStype_TEXT:
+      if (c.connected) s_self->handleText(num, payload, len);
+      break;
+    default:
+      break;
+  }
+}
@@ -0,0 +1,501 @@
+#include "ProfileStore.h"
+#include "Crc32.h"
+#include <LittleFS.h>
+#include <string.h>
+#include <stddef.h>
+#ifdef PROFILE_BENCH
+#include <ArduinoJson.h>
+#endif
+
+namespace {
+
+constexpr uint32_t PROFILE_MAGIC = 0x4650424A;  // "JBPF"
+constexpr uint32_t INDEX_MAGIC = 0x5849424A;    // "JBIX"
+constexpr uint16_t FORMAT_VER = 1;
+const char* INDEX_PATH = "/profiles.idx";
+
+// On-disk layout. Packed, little-endian (both ESP8266 and ESP32) - the
+// record is read straight into these structs.
+#pragma pack(push, 1)
+struct FileHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;      // payload bytes after the header
+  uint32_t crc;       // CRC32 of the payload
+};
+
+struct PackedStep {
+  int32_t durationSec;
+  int16_t rpm;
+  uint8_t tempMode;
+  uint8_t tempBiasMode;
+  float tempTarget;
+  float tempBias;
+  char name[STEP_NAME_LEN];
+  uint8_t flags;      // bit0 coef override, bit1 coef enabled
+  uint8_t coefTarget;
+  uint8_t alarmAction;
+  float coefBase;
+  float coefPercent;
+};
+
+struct PackedProfile {
+  char name[PROFILE_NAME_LEN];
+  int16_t targetRpm;
+  uint8_t flags;      // bit0 reverse, bit1 coef enabled, bit2 temp limits
+  int8_t stepCount;
+  float reverseIntervalSec;
+  float coefBase;
+  float coefPercent;
+  uint8_t coefTarget;
+  uint8_t alarmAction;
+  float tempMin;
+  float tempMax;
+  PackedStep steps[MAX_STEPS];  // only stepCount entries are stored
+};
+
+struct PackedIndexEntry {
+  char name[PROFILE_NAME_LEN];
+  uint8_t slot;
+  int8_t stepCount;
+  int32_t totalDurationSec;
+  uint32_t crc;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PackedStep) == 39, "step layout changed - bump FORMAT_VER");
+static_assert(offsetof(PackedProfile, steps) == 42, "profile layout changed - bump FORMAT_VER");
+static_assert(sizeof(PackedIndexEntry) == 26, "index layout changed - bump FORMAT_VER");
+static_assert(MAX_PROFILES <= 32, "readIndex() keeps the slots in a 32-bit mask");
+
+// One buffer for every file: header + the largest payload
+uint8_t s_buf[sizeof(FileHeader) + sizeof(PackedProfile)];
+uint8_t* payload() { return s_buf + sizeof(FileHeader); }
+
+void slotPath(uint8_t slot, char* buf, size_t len) {
+  snprintf(buf, len, "/profile%u.bin", slot);
+}
+
+// Payload must already be in s_buf. LittleFS commits the file on close, so
+// a reset mid-write leaves the old version.
+bool writeFile(const char* path, uint32_t magic, uint16_t size, uint32_t* crcOut = nullptr) {
+  FileHeader h{magic, FORMAT_VER, size, crc32(payload(), size)};
+  memcpy(s_buf, &h, sizeof(h));
+  File f = LittleFS.open(path, "w");
+  if (!f) return false;
+  size_t n = f.write(s_buf, sizeof(h) + size);
+  f.close();
+  if (crcOut) *crcOut = h.crc;
+  return n == sizeof(h) + size;
+}
+
+// Reads the whole file in one go. Returns the payload size, -1 if missing or corrupt
+int readFile(const char* path, uint32_t magic, uint32_t* crcOut = nullptr) {
+  File f = LittleFS.open(path, "r");
+  if (!f) return -1;
+  size_t n = f.read(s_buf, sizeof(s_buf));
+  f.close();
+  if (n < sizeof(FileHeader)) return -1;
+  FileHeader h;
+  memcpy(&h, s_buf, sizeof(h));
+  if (h.magic != magic || h.version != FORMAT_VER) return -1;
+  if (sizeof(h) + h.size != n) return -1;
+  if (crc32(payload(), h.size) != h.crc) return -1;
+  if (crcOut) *crcOut = h.crc;
+  return h.size;
+}
+
+uint16_t packProfile(const SessionSettings& s, PackedProfile& p) {
+  strncpy(p.name, s.profileName, PROFILE_NAME_LEN);  // zero-fills the tail
+  p.name[PROFILE_NAME_LEN - 1] = '\0';
+  p.targetRpm = (int16_t)s.targetRpm;
+  p.flags = (s.reverseEnabled ? 0x01 : 0) | (s.tempCoefEnabled ? 0x02 : 0) |
+            (s.tempLimitsEnabled ? 0x04 : 0);
+  p.stepCount = s.stepCount;
+  p.reverseIntervalSec = s.reverseIntervalSec;
+  p.coefBase = s.tempCoefBase;
+  p.coefPercent = s.tempCoefPercent;
+  p.coefTarget = (uint8_t)s.tempCoefTarget;
+  p.alarmAction = (uint8_t)s.tempAlarmAction;
+  p.tempMin = s.tempMin;
+  p.tempMax = s.tempMax;
+
+  for (int8_t i = 0; i < s.stepCount; i++) {
+    const ProcessStep& st = s.steps[i];
+    PackedStep& ps = p.steps[i];
+    ps.durationSec = st.durationSec;
+    ps.rpm = (int16_t)st.rpm;
+    ps.tempMode = (uint8_t)st.tempMode;
+    ps.tempBiasMode = (uint8_t)st.tempBiasMode;
+    ps.tempTarget = st.tempTarget;
+    ps.tempBias = st.tempBias;
+    strncpy(ps.name, st.name, STEP_NAME_LEN);
+    ps.name[STEP_NAME_LEN - 1] = '\0';
+    ps.flags = (st.tempCoefOverride ? 0x01 : 0) | (st.tempCoefEnabled ? 0x02 : 0);
+    ps.coefTarget = (uint8_t)st.tempCoefTarget;
+    ps.alarmAction = (uint8_t)st.tempAlarmAction;
+    ps.coefBase = st.tempCoefBase;
+    ps.coefPercent = st.tempCoefPercent;
+  }
+  return (uint16_t)(offsetof(PackedProfile, steps) + s.stepCount * sizeof(PackedStep));
+}
+
+bool unpackProfile(const PackedProfile& p, uint16_t size, SessionSettings& s) {
+  if (size < offsetof(PackedProfile, steps)) return false;
+  if (p.stepCount < 1 || p.stepCount > MAX_STEPS) return false;
+  if (size != offsetof(PackedProfile, steps) + p.stepCount * sizeof(PackedStep)) return false;
+
+  s = SessionSettings{};
+  memcpy(s.profileName, p.name, PROFILE_NAME_LEN);
+  s.profileName[PROFILE_NAME_LEN - 1] = '\0';
+  s.targetRpm = p.targetRpm;
+  s.reverseEnabled = p.flags & 0x01;
+  s.tempCoefEnabled = p.flags & 0x02;
+  s.tempLimitsEnabled = p.flags & 0x04;
+  s.stepCount = p.stepCount;
+  s.reverseIntervalSec = p.reverseIntervalSec;
+  s.tempCoefBase = p.coefBase;
+  s.tempCoefPercent = p.coefPercent;
+  s.tempCoefTarget = (TempCoefTarget)p.coefTarget;
+  s.tempAlarmAction = (TempAlarmAction)p.alarmAction;
+  s.tempMin = p.tempMin;
+  s.tempMax = p.tempMax;
+
+  for (int8_t i = 0; i < p.stepCount; i++) {
+    const PackedStep& ps = p.steps[i];
+    ProcessStep& st = s.steps[i];
+    st.durationSec = ps.durationSec;
+    st.rpm = ps.rpm;
+    st.tempMode = (StepTempMode)ps.tempMode;
+    st.tempBiasMode = (StepTempBiasMode)ps.tempBiasMode;
+    st.tempTarget = ps.tempTarget;
+    st.tempBias = ps.tempBias;
+    memcpy(st.name, ps.name, STEP_NAME_LEN);
+    st.name[STEP_NAME_LEN - 1] = '\0';
+    st.tempCoefOverride = ps.flags & 0x01;
+    st.tempCoefEnabled = ps.flags & 0x02;
+    st.tempCoefTarget = (TempCoefTarget)ps.coefTarget;
+    st.tempAlarmAction = (TempAlarmAction)ps.alarmAction;
+    st.tempCoefBase = ps.coefBase;
+    st.tempCoefPercent = ps.coefPercent;
+  }
+  return true;
+}
+
+void headerFromPacked(const PackedProfile& p, uint8_t slot, uint32_t crc, ProfileHeader& h) {
+  memcpy(h.name, p.name, PROFILE_NAME_LEN);
+  h.name[PROFILE_NAME_LEN - 1] = '\0';
+  h.slot = slot;
+  h.stepCount = p.stepCount;
+  h.totalDurationSec = 0;
+  for (int8_t i = 0; i < p.stepCount; i++) h.totalDurationSec += p.steps[i].durationSec;
+  h.crc = crc;
+}
+
+} // namespace
+
+bool ProfileStore::begin() {
+  _mounted = LittleFS.begin();
+  if (!_mounted) {
+    Serial.println("ProfileStore: LittleFS mount failed");
+    return false;
+  }
+
+  uint32_t t0 = micros();
+  if (!readIndex()) {
+    rebuildIndex();
+    writeIndex();
+  }
+  _indexLoadUs = micros() - t0;
+  Serial.printf("ProfileStore: %u profiles, index in %lu us\n", _count, (unsigned long)_indexLoadUs);
+  return true;
+}
+
+bool ProfileStore::readIndex() {
+  int size = readFile(INDEX_PATH, INDEX_MAGIC);
+  if (size < 0 || size % sizeof(PackedIndexEntry) != 0) return false;
+  uint8_t n = size / sizeof(PackedIndexEntry);
+  if (n > MAX_PROFILES) return false;
+
+  // Every slot once, and exactly the slot files that exist: a reset between
+  // a slot file and the index write leaves them out of step
+  const PackedIndexEntry* e = (const PackedIndexEntry*)payload();
+  uint32_t used = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (e[i].slot >= MAX_PROFILES || (used & (1u << e[i].slot))) return false;
+    if (e[i].stepCount < 1 || e[i].stepCount > MAX_STEPS) return false;
+    used |= 1u << e[i].slot;
+  }
+  char path[20];
+  for (uint8_t slot = 0; slot < MAX_PROFILES; slot++) {
+    slotPath(slot, path, sizeof(path));
+    bool indexed = used & (1u << slot);
+    if (LittleFS.exists(path) != indexed) return false;
+  }
+
+  for (uint8_t i = 0; i < n; i++) {
+    ProfileHeader& h = _index[i];
+    memcpy(h.name, e[i].name, PROFILE_NAME_LEN);
+    h.name[PROFILE_NAME_LEN - 1] = '\0';
+    h.slot = e[i].slot;
+    h.stepCount = e[i].stepCount;
+    h.totalDurationSec = e[i].totalDurationSec;
+    h.crc = e[i].crc;
+  }
+  _count = n;
+  return true;
+}
+
+bool ProfileStore::writeIndex() {
+  PackedIndexEntry* e = (PackedIndexEntry*)payload();
+  for (uint8_t i = 0; i < _count; i++) {
+    const ProfileHeader& h = _index[i];
+    memcpy(e[i].name, h.name, PROFILE_NAME_LEN);
+    e[i].slot = h.slot;
+    e[i].stepCount = h.stepCount;
+    e[i].totalDurationSec = h.totalDurationSec;
+    e[i].crc = h.crc;
+  }
+  return writeFile(INDEX_PATH, INDEX_MAGIC, _count * sizeof(PackedIndexEntry));
+}
+
+void ProfileStore::rebuildIndex() {
+  // Index missing or damaged: scan the slot files (slow path, once)
+  _count = 0;
+  char path[20];
+  for (uint8_t slot = 0; slot < MAX_PROFILES; slot++) {
+    slotPath(slot, path, sizeof(path));
+    if (!LittleFS.exists(path)) continue;
+    uint32_t crc;
+    int size = readFile(path, PROFILE_MAGIC, &crc);
+    const PackedProfile& p = *(const PackedProfile*)payload();
+    if (size < (int)offsetof(PackedProfile, steps) || p.stepCount < 1 || p.stepCount > MAX_STEPS) {
+      Serial.printf("ProfileStore: %s corrupt, skipped\n", path);
+      continue;
+    }
+    headerFromPacked(p, slot, crc, _index[_count++]);
+  }
+  Serial.printf("ProfileStore: index rebuilt, %u profiles\n", _count);
+}
+
+int8_t ProfileStore::freeSlot() const {
+  for (uint8_t slot = 0; slot < MAX_PROFILES; slot++) {
+    bool used = false;
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_index[i].slot == slot) { used = true; break; }
+    }
+    if (!used) return slot;
+  }
+  return -1;
+}
+
+bool ProfileStore::load(uint8_t idx, SessionSettings& out) {
+  if (!_mounted || idx >= _count) return false;
+  uint32_t t0 = micros();
+
+  char path[20];
+  slotPath(_index[idx].slot, path, sizeof(path));
+  uint32_t crc = 0;
+  int size = readFile(path, PROFILE_MAGIC, &crc);
+  if (size < 0 || crc != _index[idx].crc) {
+    // Damaged, or saved without the index write that should have followed
+    Serial.printf("ProfileStore: %s doesn't match the index, rebuilding\n", path);
+    rebuildIndex();
+    writeIndex();
+    return false;
+  }
+  if (!unpackProfile(*(const PackedProfile*)payload(), size, out)) {
+    Serial.printf("ProfileStore: %s unreadable\n", path);
+    return false;
+  }
+
+  _lastLoadUs = micros() - t0;
+  Serial.printf("ProfileStore: loaded '%s' (%d bytes) in %lu us\n",
+                out.profileName, size, (unsigned long)_lastLoadUs);
+  return true;
+}
+
+int8_t ProfileStore::save(const SessionSettings& set, int8_t idx) {
+  if (!_mounted) return -1;
+  uint32_t t0 = micros();
+
+  bool isNew = (idx < 0 || idx >= _count);
+  uint8_t slot;
+  if (isNew) {
+    int8_t freeIdx = freeSlot();
+    if (_count >= MAX_PROFILES || freeIdx < 0) return -1;
+    slot = freeIdx;
+  } else {
+    slot = _index[idx].slot;
+  }
+
+  char path[20];
+  slotPath(slot, path, sizeof(path));
+  PackedProfile& p = *(PackedProfile*)payload();
+  uint16_t size = packProfile(set, p);
+  ProfileHeader h;
+  headerFromPacked(p, slot, 0, h);
+  if (!writeFile(path, PROFILE_MAGIC, size, &h.crc)) {
+    Serial.printf("ProfileStore: write %s failed\n", path);
+    return -1;
+  }
+
+  if (isNew) idx = _count++;
+  _index[idx] = h;
+  writeIndex();
+
+  _lastSaveUs = micros() - t0;
+  Serial.printf("ProfileStore: saved '%s' (%u bytes) in %lu us\n",
+                h.name, size, (unsigned long)_lastSaveUs);
+  return idx;
+}
+
+bool ProfileStore::remove(uint8_t idx) {
+  if (!_mounted || idx >= _count) return false;
+  char path[20];
+  slotPath(_index[idx].slot, path, sizeof(path));
+  if (!LittleFS.remove(path) && LittleFS.exists(path)) {
+    Serial.printf("ProfileStore: remove %s failed\n", path);
+    return false;
+  }
+  for (uint8_t i = idx; i + 1 < _count; i++) _index[i] = _index[i + 1];
+  _count--;
+  return writeIndex();
+}
+
+bool ProfileStore::saveFile(const char* path, const SessionSettings& set, uint32_t* crcOut) {
+  if (!_mounted) return false;
+  uint16_t size = packProfile(set, *(PackedProfile*)payload());
+  return writeFile(path, PROFILE_MAGIC, size, crcOut);
+}
+
+bool ProfileStore::loadFile(const char* path, SessionSettings& out, uint32_t* crcOut) {
+  if (!_mounted) return false;
+  int size = readFile(path, PROFILE_MAGIC, crcOut);
+  return size >= 0 && unpackProfile(*(const PackedProfile*)payload(), size, out);
+}
+
+uint32_t ProfileStore::recordCrc(const SessionSettings& set) {
+  uint16_t size = packProfile(set, *(PackedProfile*)payload());
+  return crc32(payload(), size);
+}
+
+#ifdef PROFILE_BENCH
+namespace {
+
+void settingsToJson(const SessionSettings& s, JsonDocument& doc) {
+  doc["name"] = s.profileName;
+  doc["rpm"] = s.targetRpm;
+  doc["rev"] = s.reverseEnabled;
+  doc["revSec"] = s.reverseIntervalSec;
+  doc["coef"] = s.tempCoefEnabled;
+  doc["coefBase"] = s.tempCoefBase;
+  doc["coefPct"] = s.tempCoefPercent;
+  doc["coefTarget"] = (uint8_t)s.tempCoefTarget;
+  doc["alarm"] = (uint8_t)s.tempAlarmAction;
+  doc["limits"] = s.tempLimitsEnabled;
+  doc["tMin"] = s.tempMin;
+  doc["tMax"] = s.tempMax;
+  JsonArray steps = doc["steps"].to<JsonArray>();
+  for (int8_t i = 0; i < s.stepCount; i++) {
+    const ProcessStep& st = s.steps[i];
+    JsonObject o = steps.add<JsonObject>();
+    o["dur"] = st.durationSec;
+    o["rpm"] = st.rpm;
+    o["tMode"] = (uint8_t)st.tempMode;
+    o["tTarget"] = st.tempTarget;
+    o["bMode"] = (uint8_t)st.tempBiasMode;
+    o["bias"] = st.tempBias;
+    o["name"] = st.name;
+    o["ovr"] = st.tempCoefOverride;
+    o["coef"] = st.tempCoefEnabled;
+    o["coefBase"] = st.tempCoefBase;
+    o["coefPct"] = st.tempCoefPercent;
+    o["coefTarget"] = (uint8_t)st.tempCoefTarget;
+    o["alarm"] = (uint8_t)st.tempAlarmAction;
+  }
+}
+
+void settingsFromJson(const JsonDocument& doc, SessionSettings& s) {
+  s = SessionSettings{};
+  strlcpy(s.profileName, doc["name"] | "", sizeof(s.profileName));
+  s.targetRpm = doc["rpm"] | 30;
+  s.reverseEnabled = doc["rev"] | true;
+  s.reverseIntervalSec = doc["revSec"] | 10.0f;
+  s.tempCoefEnabled = doc["coef"] | false;
+  s.tempCoefBase = doc["coefBase"] | 20.0f;
+  s.tempCoefPercent = doc["coefPct"] | 10.0f;
+  s.tempCoefTarget = (TempCoefTarget)(doc["coefTarget"] | 0);
+  s.tempAlarmAction = (TempAlarmAction)(doc["alarm"] | 1);
+  s.tempLimitsEnabled = doc["limits"] | false;
+  s.tempMin = doc["tMin"] | 18.0f;
+  s.tempMax = doc["tMax"] | 24.0f;
+  JsonArrayConst steps = doc["steps"];
+  s.stepCount = 0;
+  for (JsonObjectConst o : steps) {
+    if (s.stepCount >= MAX_STEPS) break;
+    ProcessStep& st = s.steps[s.stepCount++];
+    st.durationSec = o["dur"] | 0;
+    st.rpm = o["rpm"] | 30;
+    st.tempMode = (StepTempMode)(o["tMode"] | 0);
+    st.tempTarget = o["tTarget"] | 20.0f;
+    st.tempBiasMode = (StepTempBiasMode)(o["bMode"] | 0);
+    st.tempBias = o["bias"] | 2.0f;
+    strlcpy(st.name, o["name"] | "", sizeof(st.name));
+    st.tempCoefOverride = o["ovr"] | false;
+    st.tempCoefEnabled = o["coef"] | false;
+    st.tempCoefBase = o["coefBase"] | 20.0f;
+    st.tempCoefPercent = o["coefPct"] | 10.0f;
+    st.tempCoefTarget = (TempCoefTarget)(o["coefTarget"] | 0);
+    st.tempAlarmAction = (TempAlarmAction)(o["alarm"] | 1);
+  }
+  if (s.stepCount == 0) s.stepCount = 1;
+}
+
+} // namespace
+
+void ProfileStore::benchJson(const SessionSettings& set) {
+  if (!_mounted) return;
+  static SessionSettings tmp;
+  const char* jsonPath = "/profile_bench.json";
+  const char* binPath = "/profile_bench.bin";
+
+  uint32_t t0 = micros();
+  size_t jsonBytes = 0;
+  {
+    JsonDocument doc;
+    settingsToJson(set, doc);
+    File f = LittleFS.open(jsonPath, "w");
+    if (f) { jsonBytes = serializeJson(doc, f); f.close(); }
+  }
+  uint32_t jsonSaveUs = micros() - t0;
+
+  t0 = micros();
+  {
+    JsonDocument doc;
+    File f = LittleFS.open(jsonPath, "r");
+    if (f) {
+      if (!deserializeJson(doc, f)) settingsFromJson(doc, tmp);
+      f.close();
+    }
+  }
+  uint32_t jsonLoadUs = micros() - t0;
+
+  t0 = micros();
+  uint16_t binBytes = packProfile(set, *(PackedProfile*)payload());
+  writeFile(binPath, PROFILE_MAGIC, binBytes);
+  uint32_t binSaveUs = micros() - t0;
+
+  t0 = micros();
+  int size = readFile(binPath, PROFILE_MAGIC);
+  if (size >= 0) unpackProfile(*(const PackedProfile*)payload(), size, tmp);
+  uint32_t binLoadUs = micros() - t0;
+
+  LittleFS.remove(jsonPath);
+  LittleFS.remove(binPath);
+  Serial.printf("ProfileStore bench (%d steps): json save %lu us, load %lu us, %u bytes | "
+                "binary save %lu us, load %lu us, %u bytes\n",
+                set.stepCount, (unsigned long)jsonSaveUs, (unsigned long)jsonLoadUs, (unsigned)jsonBytes,
+                (unsigned long)binSaveUs, (unsigned long)binLoadUs, (unsigned)(binBytes + sizeof(FileHeader)));
+}
+#endif
@@ -1,5 +1,6 @@
 #include "Protocol.h"
 #include <string.h>
+#include <math.h>
 
 const char* stateToStr(ProcState s){
   switch(s){
@@ -43,46 +44,310 @@ WifiMode wifiModeFromStr(const char* s){
   return WifiMode::ApSta;
 }
 
-void buildHello(JsonDocument& doc, const char* fw){
-  doc["type"]="hello";
-  doc["device"]="DIY-JOBO";
-  doc["fw"]=fw;
+const char* wireEncToStr(WireEnc e){
+  return e == WireEnc::Bin ? "bin" : "json";
 }
 
-void buildStatus(JsonDocument& doc, const Status& st){
-  doc["type"]="status";
-  doc["state"]=stateToStr(st.state);
-  doc["rpm"]=st.rpm;
-  doc["dir"]=st.dirFwd ? "fwd":"rev";
-  doc["rev"]=st.reversing;
+WireEnc wireEncFromStr(const char* s){
+  if(s && !strcmp(s,"bin")) return WireEnc::Bin;
+  return WireEnc::Json;
+}
+
+void writeHello(JsonWriter& w, const char* fw){
+  w.beginObject();
+  w.field("type","hello");
+  w.field("device","DIY-JOBO");
+  w.field("fw",fw);
+  w.beginArray("enc").item("json").item("bin").endArray();
+  w.endObject();
+}
+
+void writeEncAck(JsonWriter& w, WireEnc e){
+  w.beginObject();
+  w.field("type","enc");
+  w.field("enc",wireEncToStr(e));
+  w.endObject();
+}
+
+void writeStatus(JsonWriter& w, const Status& st){
+  w.beginObject();
+  w.field("type","status");
+  w.field("state",stateToStr(st.state));
+  w.field("rpm",st.rpm);
+  w.field("dir",st.dirFwd ? "fwd":"rev");
+  w.field("rev",st.reversing);
+
+  w.field("rev_ramp_ms",st.rev.rampMs);
+  w.field("rev_pause_ms",st.rev.pauseMs);
+  w.field("start_ramp_ms",st.motion.startRampMs);
+  w.field("stop_ramp_ms",st.motion.stopRampMs);
+
+  w.field("auto_rev_mode",autoRevModeToStr(st.autoRev.mode));
+  w.field("auto_rev_interval",st.autoRev.interval);
+
+  w.field("temp",st.tempC);
+  w.endObject();
+}
+
+void writeConfig(JsonWriter& w, const PersistentConfig& cfg){
+  w.beginObject();
+  w.field("type","config");
+
+  w.beginObject("wifi");
+  w.field("mode",wifiModeToStr(cfg.wifi.mode));
+  w.field("staSsid",cfg.wifi.staSsid);
+  w.field("apSubnet",cfg.wifi.apSubnet);
+  w.endObject();
+
+  w.field("rpm",cfg.rpm);
+  w.field("dirFwd",cfg.dirFwd);
+
+  w.beginObject("rev");
+  w.field("rampMs",cfg.rev.rampMs);
+  w.field("pauseMs",cfg.rev.pauseMs);
+  w.endObject();
+
+  w.beginObject("motion");
+  w.field("startRampMs",cfg.motion.startRampMs);
+  w.field("stopRampMs",cfg.motion.stopRampMs);
+  w.endObject();
+
+  w.beginObject("autoRev");
+  w.field("mode",autoRevModeToStr(cfg.autoRev.mode));
+  w.field("interval",cfg.autoRev.interval);
+  w.endObject();
+  w.endObject();
+}
+
+namespace {
+
+enum FieldKind : uint8_t { FK_INT, FK_BOOL, FK_STATE, FK_DIR, FK_TENTHS, FK_CENTI };
+
+struct FieldDef {
+  const char* key;
+  uint8_t group;
+  FieldKind kind;
+  uint8_t binBytes;         // width in a BinDelta
+};
+
+// Indexed by StatusField
+const FieldDef FIELDS[SF_COUNT] = {
+  {"state",      SG_MOTOR,  FK_STATE,  1},
+  {"rpm",        SG_MOTOR,  FK_INT,    2},
+  {"rpm_actual", SG_MOTOR,  FK_TENTHS, 2},
+  {"dir",        SG_MOTOR,  FK_DIR,    1},
+  {"rev",        SG_MOTOR,  FK_BOOL,   1},
+  {"timer",      SG_TIMER,  FK_BOOL,   1},
+  {"step",       SG_TIMER,  FK_INT,    1},
+  {"steps",      SG_TIMER,  FK_INT,    1},
+  {"step_left",  SG_TIMER,  FK_INT,    4},
+  {"total_left", SG_TIMER,  FK_INT,    4},
+  {"temp",       SG_TEMP,   FK_CENTI,  2},
+  {"temp_alarm", SG_ALARMS, FK_BOOL,   1},
+  {"temp_low",   SG_ALARMS, FK_BOOL,   1},
+  {"temp_high",  SG_ALARMS, FK_BOOL,   1},
+};
+
+constexpr int32_t VALUE_NONE = INT32_MIN;  // NAN temperature
+
+} // namespace
+
+uint8_t statusGroupFromStr(const char* s){
+  if(!s) return 0;
+  if(!strcmp(s,"motor"))  return SG_MOTOR;
+  if(!strcmp(s,"timer"))  return SG_TIMER;
+  if(!strcmp(s,"temp") || !strcmp(s,"temperature")) return SG_TEMP;
+  if(!strcmp(s,"alarms")) return SG_ALARMS;
+  if(!strcmp(s,"all"))    return SG_ALL;
+  return 0;
+}
+
+void captureStatus(const Status& st, StatusValues& out){
+  int32_t* v = out.v;
+  v[SF_STATE] = (int32_t)st.state;
+  v[SF_RPM] = st.rpm;
+  v[SF_RPM_ACTUAL] = (int32_t)lroundf(st.rpmActual * 10.0f);
+  v[SF_DIR] = st.dirFwd;
+  v[SF_REV] = st.reversing;
+  v[SF_TIMER] = st.timerActive;
+  v[SF_STEP] = st.step;
+  v[SF_STEPS] = st.stepCount;
+  v[SF_STEP_LEFT] = st.stepRemainingSec;
+  v[SF_TOTAL_LEFT] = st.totalRemainingSec;
+  v[SF_TEMP] = isnan(st.tempC) ? VALUE_NONE : (int32_t)lroundf(st.tempC * 100.0f);
+  v[SF_ALARM] = st.tempAlarm;
+  v[SF_TEMP_LOW] = st.tempLow;
+  v[SF_TEMP_HIGH] = st.tempHigh;
+}
+
+uint32_t groupFields(uint8_t groups){
+  uint32_t mask = 0;
+  for(uint8_t f = 0; f < SF_COUNT; f++){
+    if(FIELDS[f].group & groups) mask |= 1UL << f;
+  }
+  return mask;
+}
+
+uint32_t changedFields(const StatusValues& a, const StatusValues& b){
+  uint32_t mask = 0;
+  for(uint8_t f = 0; f < SF_COUNT; f++){
+    if(a.v[f] != b.v[f]) mask |= 1UL << f;
+  }
+  return mask;
+}
+
+void writeStatusDelta(JsonWriter& w, const StatusValues& vals, uint32_t fields, uint32_t seq, bool key){
+  w.beginObject();
+  w.field("type","delta");
+  w.field("seq",(unsigned long)seq);
+  w.field("key",key);
+  for(uint8_t f = 0; f < SF_COUNT; f++){
+    if(!(fields & (1UL << f))) continue;
+    const FieldDef& d = FIELDS[f];
+    int32_t v = vals.v[f];
+    switch(d.kind){
+      case FK_INT:    w.field(d.key,(long)v); break;
+      case FK_BOOL:   w.field(d.key,v != 0); break;
+      case FK_STATE:  w.field(d.key,stateToStr((ProcState)v)); break;
+      case FK_DIR:    w.field(d.key,v ? "fwd" : "rev"); break;
+      case FK_TENTHS: w.field(d.key,v / 10.0f,1); break;
+      case FK_CENTI:
+        if(v == VALUE_NONE) w.field(d.key,(const char*)nullptr);
+        else w.field(d.key,v / 100.0f,2);
+        break;
+    }
+  }
+  w.endObject();
+}
 
-  doc["rev_ramp_ms"]=st.rev.rampMs;
-  doc["rev_pause_ms"]=st.rev.pauseMs;
-  doc["start_ramp_ms"]=st.motion.startRampMs;
-  doc["stop_ramp_ms"]=st.motion.stopRampMs;
+void writeTlmAck(JsonWriter& w, uint8_t hz, uint16_t periodMs){
+  w.beginObject();
+  w.field("type","tlm");
+  w.field("hz",(unsigned)hz);
+  w.field("period_ms",(unsigned)periodMs);
+  w.endObject();
+}
+
+void writeSubAck(JsonWriter& w, uint8_t groups, uint16_t periodMs){
+  static const char* const NAMES[] = {"motor","timer","temp","alarms"};
+  w.beginObject();
+  w.field("type","sub");
+  w.beginArray("groups");
+  for(uint8_t g = 0; g < 4; g++){
+    if(groups & (1 << g)) w.item(NAMES[g]);
+  }
+  w.endArray();
+  w.field("period_ms",periodMs);
+  w.endObject();
+}
+
+namespace {
+const char* const CMD_NAMES[] = {"unknown","start","pause","next","stop","set_rpm","edit_step","load_profile"};
+const char* const CMD_ERRORS[] = {"ok","busy","bad_args","not_allowed","failed"};
+} // namespace
 
-  doc["auto_rev_mode"]=autoRevModeToStr(st.autoRev.mode);
-  doc["auto_rev_interval"]=st.autoRev.interval;
+const char* cmdTypeToStr(CmdType t){
+  return CMD_NAMES[(uint8_t)t];
+}
 
-  doc["temp"]=st.tempC;
+bool cmdTypeFromStr(const char* s, CmdType& out){
+  if(!s) return false;
+  for(uint8_t i = 1; i < sizeof(CMD_NAMES) / sizeof(CMD_NAMES[0]); i++){
+    if(!strcmp(s,CMD_NAMES[i])){
+      out = (CmdType)i;
+      return true;
+    }
+  }
+  return false;
 }
 
-void buildConfig(JsonDocument& doc, const PersistentConfig& cfg){
-  doc["type"]="config";
+const char* cmdErrorToStr(CmdError e){
+  return CMD_ERRORS[(uint8_t)e];
+}
 
-  doc["wifi"]["mode"]=wifiModeToStr(cfg.wifi.mode);
-  doc["wifi"]["staSsid"]=cfg.wifi.staSsid;
-  doc["wifi"]["apSubnet"]=cfg.wifi.apSubnet;
+void writeCmdAck(JsonWriter& w, uint32_t id, const char* cmd, CmdError err, uint32_t latencyUs){
+  w.beginObject();
+  w.field("type","ack");
+  w.field("id",(unsigned long)id);
+  w.field("cmd",cmd);
+  w.field("ok",err == CmdError::Ok);
+  if(err != CmdError::Ok) w.field("err",cmdErrorToStr(err));
+  w.field("latency_us",(unsigned long)latencyUs);
+  w.endObject();
+}
 
-  doc["rpm"]=cfg.rpm;
-  doc["dirFwd"]=cfg.dirFwd;
+static_assert(sizeof(BinStatus) == 20, "BinStatus layout changed - bump BIN_VERSION");
+static_assert(sizeof(BinConfig) == 51, "BinConfig layout changed - bump BIN_VERSION");
+static_assert(sizeof(BinTelemetry) == 22, "BinTelemetry layout changed - bump BIN_VERSION");
+static_assert(sizeof(BinDelta) == 10, "BinDelta layout changed - bump BIN_VERSION");
+static_assert(SF_COUNT <= 16, "BinDelta::fields is 16 bits");
 
-  doc["rev"]["rampMs"]=cfg.rev.rampMs;
-  doc["rev"]["pauseMs"]=cfg.rev.pauseMs;
+// Both targets are little-endian, so the packed structs go out as they are
+size_t encodeStatus(uint8_t* out, size_t cap, const Status& st){
+  if(cap < sizeof(BinStatus)) return 0;
+  BinStatus b;
+  b.type = BIN_MSG_STATUS;
+  b.version = BIN_VERSION;
+  b.state = (uint8_t)st.state;
+  b.flags = (st.dirFwd ? BS_DIR_FWD : 0) | (st.reversing ? BS_REVERSING : 0) |
+            (st.timerActive ? BS_TIMER_ACTIVE : 0) | (st.tempAlarm ? BS_TEMP_ALARM : 0);
+  b.rpm = (int16_t)st.rpm;
+  b.revRampMs = st.rev.rampMs;
+  b.revPauseMs = st.rev.pauseMs;
+  b.startRampMs = st.motion.startRampMs;
+  b.stopRampMs = st.motion.stopRampMs;
+  b.autoRevMode = (uint8_t)st.autoRev.mode;
+  b.reserved = 0;
+  b.autoRevInterval = st.autoRev.interval;
+  if(isnan(st.tempC) || st.tempC < -327.0f || st.tempC > 327.0f) b.tempCenti = BIN_TEMP_NONE;
+  else b.tempCenti = (int16_t)lroundf(st.tempC * 100.0f);
+  memcpy(out, &b, sizeof(b));
+  return sizeof(b);
+}
 
-  doc["motion"]["startRampMs"]=cfg.motion.startRampMs;
-  doc["motion"]["stopRampMs"]=cfg.motion.stopRampMs;
+size_t encodeStatusDelta(uint8_t* out, size_t cap, const StatusValues& vals, uint32_t fields,
+                         uint32_t seq, bool key){
+  if(cap < sizeof(BinDelta)) return 0;
+  BinDelta h;
+  h.type = BIN_MSG_DELTA;
+  h.version = BIN_VERSION;
+  h.flags = key ? BD_KEY : 0;
+  h.reserved = 0;
+  h.seq = seq;
+  h.fields = (uint16_t)fields;
+  memcpy(out, &h, sizeof(h));
+  size_t n = sizeof(h);
+  for(uint8_t f = 0; f < SF_COUNT; f++){
+    if(!(fields & (1UL << f))) continue;
+    uint8_t bytes = FIELDS[f].binBytes;
+    if(n + bytes > cap) return 0;
+    int32_t v = vals.v[f];
+    if(FIELDS[f].kind == FK_CENTI && (v == VALUE_NONE || v < INT16_MIN + 1 || v > INT16_MAX)){
+      v = BIN_TEMP_NONE;
+    }
+    memcpy(out + n, &v, bytes);   // little-endian: the low bytes
+    n += bytes;
+  }
+  return n;
+}
 
-  doc["autoRev"]["mode"]=autoRevModeToStr(cfg.autoRev.mode);
-  doc["autoRev"]["interval"]=cfg.autoRev.interval;
+size_t encodeConfig(uint8_t* out, size_t cap, const PersistentConfig& cfg){
+  if(cap < sizeof(BinConfig)) return 0;
+  BinConfig b;
+  b.type = BIN_MSG_CONFIG;
+  b.version = BIN_VERSION;
+  b.wifiMode = (uint8_t)cfg.wifi.mode;
+  b.apSubnet = cfg.wifi.apSubnet;
+  memcpy(b.staSsid, cfg.wifi.staSsid, sizeof(b.staSsid));
+  b.staSsid[sizeof(b.staSsid) - 1] = '\0';
+  b.rpm = (int16_t)cfg.rpm;
+  b.dirFwd = cfg.dirFwd ? 1 : 0;
+  b.autoRevMode = (uint8_t)cfg.autoRev.mode;
+  b.autoRevInterval = cfg.autoRev.interval;
+  b.revRampMs = cfg.rev.rampMs;
+  b.revPauseMs = cfg.rev.pauseMs;
+  b.startRampMs = cfg.motion.startRampMs;
+  b.stopRampMs = cfg.motion.stopRampMs;
+  memcpy(out, &b, sizeof(b));
+  return sizeof(b);
 }
@@ -0,0 +1,200 @@
+#include "ResumeJournal.h"
+#include "Clock.h"
+#include "Crc32.h"
+#include <LittleFS.h>
+#include <stddef.h>
+#include <string.h>
+#if defined(ESP32)
+  #include <esp_attr.h>
+#endif
+
+namespace {
+
+constexpr uint32_t JOURNAL_MAGIC = 0x4E524A4A;  // "JJRN"
+const char* CHECKPOINT_PATH = "/resume.bin";
+const char* SNAPSHOT_PATH = "/resume_set.bin";
+
+static_assert(sizeof(JournalRecord) == 32, "JournalRecord must stay 32 bytes");
+
+#if defined(ESP8266)
+constexpr uint32_t RTC_BLOCK = 32;  // word offset in RTC user memory (past OTA/eboot use)
+#elif defined(ESP32)
+RTC_NOINIT_ATTR uint32_t s_rtc[sizeof(JournalRecord) / 4];  // kept across resets, not zeroed
+#else
+uint32_t s_rtc[sizeof(JournalRecord) / 4];
+#endif
+
+} // namespace
+
+void ResumeJournal::seal(JournalRecord& r) {
+  r.magic = JOURNAL_MAGIC;
+  r.crc = crc32(&r, offsetof(JournalRecord, crc));
+}
+
+bool ResumeJournal::valid(const JournalRecord& r) {
+  return r.magic == JOURNAL_MAGIC && r.crc == crc32(&r, offsetof(JournalRecord, crc));
+}
+
+bool ResumeJournal::readRtc(JournalRecord& r) {
+#if defined(ESP8266)
+  if (!ESP.rtcUserMemoryRead(RTC_BLOCK, (uint32_t*)&r, sizeof(r))) return false;
+#else
+  memcpy(&r, s_rtc, sizeof(r));
+#endif
+  return valid(r);
+}
+
+void ResumeJournal::writeRtc(const JournalRecord& r) {
+#if defined(ESP8266)
+  ESP.rtcUserMemoryWrite(RTC_BLOCK, (uint32_t*)&r, sizeof(r));
+#else
+  memcpy(s_rtc, &r, sizeof(r));
+#endif
+}
+
+bool ResumeJournal::begin(ProfileStore* store, SessionSettings& settings) {
+  _store = store;
+
+  JournalRecord fl;
+  bool flOk = false;
+  File f = LittleFS.open(CHECKPOINT_PATH, "r");
+  if (f) {
+    flOk = f.read((uint8_t*)&fl, sizeof(fl)) == sizeof(fl) && valid(fl);
+    f.close();
+  }
+  JournalRecord rt;
+  bool rtOk = readRtc(rt);
+
+  // No checkpoint = the last session ended normally
+  if (!flOk) {
+    if (rtOk) writeRtc(JournalRecord{});
+    return false;
+  }
+
+  uint32_t crc = 0;
+  bool snapOk = _store && _store->loadFile(SNAPSHOT_PATH, settings, &crc);
+
+  // RTC memory survives resets but not power-off. Prefer it when it is
+  // newer progress of the same snapshot, or when a reset came between a new
+  // snapshot and its flash checkpoint.
+  bool fromRtc = rtOk && snapOk && rt.snapshotCrc == crc &&
+                 (fl.snapshotCrc != crc || rt.step >= fl.step);
+  _pending = fromRtc ? rt : fl;
+
+  if (!snapOk || crc != _pending.snapshotCrc || _pending.step >= settings.stepCount) {
+    Serial.println("ResumeJournal: checkpoint without matching snapshot, dropped");
+    settings = SessionSettings{};
+    LittleFS.remove(CHECKPOINT_PATH);
+    writeRtc(JournalRecord{});
+    return false;
+  }
+
+  _hasPending = true;
+  _flashWrites = _pending.flashWrites;
+  Serial.printf("ResumeJournal: interrupted at step %d, %.1f s in (%s)\n", _pending.step,
+                _pending.devUs / 1000000.0f, fromRtc ? "rtc" : "flash checkpoint");
+  return true;
+}
+
+void ResumeJournal::accept(const SessionController& session) {
+  _hasPending = false;
+  _active = true;
+  _lastStep = session.currentStep();
+  _snapVersion = session.settingsVersion();
+  _snapCrc = _pending.snapshotCrc;
+}
+
+void ResumeJournal::discard() {
+  _hasPending = false;
+  clear();
+}
+
+void ResumeJournal::tick(const SessionController& session, bool dirFwd) {
+  if (_hasPending) return;  // resume prompt still open
+
+  if (!session.inProgress()) {
+    if (_active) {
+      _active = false;
+      clear();
+      Serial.printf("ResumeJournal: session over, %u flash writes\n", _flashWrites);
+    }
+    return;
+  }
+
+  if (!_active) {
+    // Fresh session
+    _active = true;
+    _flashWrites = 0;
+    _lastStep = -1;
+    _snapVersion = UINT32_MAX;
+    _editVersion = UINT32_MAX;
+  }
+
+  // Flash at session start and step boundaries
+  uint32_t now = sysClock.nowMs();
+  if (session.currentStep() != _lastStep) {
+    _lastStep = session.currentStep();
+    checkpoint(session, dirFwd);
+  } else if (session.settingsVersion() != _snapVersion) {
+    // Edited mid-step: snapshot and checkpoint once the edits settle, while
+    // one record per remaining boundary and the final remove still fit
+    int32_t left = session.settings().stepCount - 1 - session.currentStep();
+    if (session.settingsVersion() != _editVersion) {
+      _editVersion = session.settingsVersion();
+      _editMs = now;
+    } else if (now - _editMs >= SNAPSHOT_SETTLE_MS &&
+               _flashWrites + 3 + (left > 0 ? left : 0) <= MAX_FLASH_WRITES) {
+      _editMs = now;  // a failed snapshot is retried after another wait
+      checkpoint(session, dirFwd);
+    }
+  }
+
+  if (now - _lastRtcMs >= RTC_PERIOD_MS) {
+    _lastRtcMs = now;
+    JournalRecord r;
+    fill(r, session, dirFwd);
+    writeRtc(r);
+  }
+}
+
+void ResumeJournal::fill(JournalRecord& r, const SessionController& s, bool dirFwd) const {
+  r = JournalRecord{};
+  r.snapshotCrc = _snapCrc;
+  r.devUs = s.stepDevUs();
+  r.stampMs = sysClock.nowMs();
+  r.step = s.currentStep();
+  r.flags = (s.isRunning() ? JF_RUNNING : 0) | (s.isPaused() ? JF_PAUSED : 0) |
+            (dirFwd ? JF_DIR_FWD : 0);
+  r.flashWrites = _flashWrites;
+  seal(r);
+}
+
+void ResumeJournal::checkpoint(const SessionController& s, bool dirFwd) {
+  // Snapshot (if settings changed) + record; the final remove needs one more
+  if (_flashWrites + 3 > MAX_FLASH_WRITES) return;
+
+  if (s.settingsVersion() != _snapVersion && _store &&
+      _store->saveFile(SNAPSHOT_PATH, s.settings(), &_snapCrc)) {
+    _snapVersion = s.settingsVersion();
+    _flashWrites++;
+  }
+
+  // RTC first: it names the new snapshot before the flash record does
+  JournalRecord r;
+  _flashWrites++;
+  fill(r, s, dirFwd);
+  writeRtc(r);
+  File f = LittleFS.open(CHECKPOINT_PATH, "w");
+  if (f) {
+    f.write((const uint8_t*)&r, sizeof(r));
+    f.close();
+  }
+}
+
+void ResumeJournal::clear() {
+  if (LittleFS.exists(CHECKPOINT_PATH)) {
+    LittleFS.remove(CHECKPOINT_PATH);
+    _flashWrites++;
+  }
+  writeRtc(JournalRecord{});
+}
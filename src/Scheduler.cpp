@@ -0,0 +1,100 @@
+#include "Scheduler.h"
+#include "Clock.h"
+
+void Scheduler::begin(ModuleProfiler* prof, uint32_t slackCutoffUs) {
+  _prof = prof;
+  _cutoffUs = slackCutoffUs;
+}
+
+void Scheduler::add(ProfSection id, void (*fn)(void*), void* ctx, TaskPrio prio,
+                    uint32_t periodUs, uint32_t budgetUs, uint32_t deadlineUs) {
+  if (id >= PS_COUNT || _count >= PS_COUNT || _tasks[id].fn) return;
+  Task& t = _tasks[id];
+  t.fn = fn;
+  t.ctx = ctx;
+  t.prio = prio;
+  t.periodUs = periodUs;
+  t.budgetUs = budgetUs;
+  t.deadlineUs = deadlineUs;
+  t.dueUs = sysClock.nowUs();
+
+  // Insertion keeps _order sorted by priority, stable within one
+  uint8_t pos = _count;
+  while (pos > 0 && _tasks[_order[pos - 1]].prio > prio) {
+    _order[pos] = _order[pos - 1];
+    pos--;
+  }
+  _order[pos] = id;
+  _count++;
+}
+
+void Scheduler::runPass() {
+  const uint64_t passUs = sysClock.nowUs();
+  const uint32_t passCyc = ModuleProfiler::cycles();
+  uint32_t mark = passCyc;   // end of the previous task: one counter read per task
+  bool periodicRan = false;
+
+  for (uint8_t i = 0; i < _count; i++) {
+    Task& t = _tasks[_order[i]];
+    uint32_t elapsedUs = _prof->cyclesToUs(mark - passCyc);
+    uint64_t nowUs = passUs + elapsedUs;
+    if (t.periodUs && nowUs < t.dueUs) continue;
+
+    // Every-pass tasks are late by the gap since their last start
+    uint32_t lateUs = (uint32_t)(nowUs - t.dueUs);
+    bool missed = lateUs > t.deadlineUs;
+    if (t.prio == TaskPrio::Slack && elapsedUs >= _cutoffUs && !missed) {
+      t.st.deferred++;
+      continue;
+    }
+
+    t.fn(t.ctx);
+    uint32_t end = ModuleProfiler::cycles();
+    uint32_t runCyc = end - mark;
+    uint32_t runUs = _prof->cyclesToUs(runCyc);
+    mark = end;
+    _prof->record((ProfSection)_order[i], runCyc);
+
+    t.st.runs++;
+    if (missed) t.st.misses++;
+    if (runUs > t.budgetUs) t.st.overruns++;
+    if (lateUs > t.st.maxLateUs) t.st.maxLateUs = lateUs;
+    if (runUs > t.st.maxRunUs) t.st.maxRunUs = runUs;
+
+    if (t.periodUs) {
+      periodicRan = true;
+      // Keep the cadence; resync instead of bursting after a stall
+      t.dueUs += t.periodUs;
+      if (t.dueUs <= nowUs) t.dueUs = nowUs + t.periodUs;
+    } else {
+      t.dueUs = nowUs;
+    }
+  }
+
+  if (!periodicRan) _idlePasses++;
+  _prof->endPass();
+}
+
+void Scheduler::resetStats() {
+  for (uint8_t i = 0; i < PS_COUNT; i++) _tasks[i].st = TaskStats{};
+  _idlePasses = 0;
+}
+
+void Scheduler::print(Print& out) const {
+  static const char* const PRIO[] = {"motion", "normal", "slack"};
+  char line[128];
+  snprintf(line, sizeof(line), "sched: %lu idle passes, slack cut-off %lu us",
+           (unsigned long)_idlePasses, (unsigned long)_cutoffUs);
+  out.println(line);
+  out.println("  task     prio   period  budget    runs  misses overruns deferred  late_max  run_max");
+  for (uint8_t i = 0; i < _count; i++) {
+    const Task& t = _tasks[_order[i]];
+    snprintf(line, sizeof(line), "  %-8s %-6s %6lu %7lu %7lu %7lu %8lu %8lu %9lu %8lu",
+             ModuleProfiler::name((ProfSection)_order[i]), PRIO[(uint8_t)t.prio],
+             (unsigned long)t.periodUs, (unsigned long)t.budgetUs, (unsigned long)t.st.runs,
+             (unsigned long)t.st.misses, (unsigned long)t.st.overruns,
+             (unsigned long)t.st.deferred, (unsigned long)t.st.maxLateUs,
+             (unsigned long)t.st.maxRunUs);
+    out.println(line);
+  }
+}
@@ -0,0 +1,314 @@
+#include "SessionArchive.h"
+#include "Clock.h"
+#include "Crc32.h"
+#include <LittleFS.h>
+#include <string.h>
+#include <time.h>
+
+namespace {
+
+constexpr uint32_t RECORD_MAGIC = 0x5253424A;  // "JBSR"
+constexpr uint32_t INDEX_MAGIC = 0x4953424A;   // "JBSI"
+constexpr uint16_t FORMAT_VER = 1;
+const char* LOG_PATH[2] = {"/sessions.log", "/sessions.old.log"};
+const char* IDX_PATH[2] = {"/sessions.idx", "/sessions.old.idx"};
+const char* IDX_TMP_PATH = "/sessions.idx.tmp";
+
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t id;
+  uint16_t version;
+  uint16_t size;      // payload bytes after the header
+  uint32_t crc;       // CRC32 of the payload
+};
+
+struct IndexHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t entrySize;
+  uint32_t firstId;   // id of the first entry
+};
+
+// Stored as is (little-endian on both targets)
+static_assert(sizeof(SessionSummary) == 128, "summary layout changed - bump FORMAT_VER");
+static_assert(sizeof(ArchiveEntry) == 36, "index layout changed - bump FORMAT_VER");
+static_assert(sizeof(RecordHeader) == 16 && sizeof(IndexHeader) == 12, "header layout changed");
+
+constexpr uint16_t RECORD_BYTES = sizeof(RecordHeader) + sizeof(SessionSummary);
+
+// Record at the file position; id 0 = any id
+bool readRecord(File& log, uint32_t id, RecordHeader& h, SessionSummary& rec) {
+  return log.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+         h.magic == RECORD_MAGIC && (id == 0 || h.id == id) && h.version == FORMAT_VER &&
+         h.size == sizeof(rec) &&
+         log.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec) &&
+         crc32(&rec, sizeof(rec)) == h.crc;
+}
+
+ArchiveEntry entryFor(uint32_t id, uint32_t offset, const SessionSummary& rec) {
+  ArchiveEntry e;
+  e.id = id;
+  e.offset = offset;
+  e.startEpoch = rec.startEpoch;
+  for (int8_t i = 0; i < rec.stepCount && i < MAX_STEPS; i++) e.actualSec += rec.stepActualSec[i];
+  e.size = RECORD_BYTES;
+  e.stepsDone = rec.stepsDone;
+  e.end = (uint8_t)rec.end;
+  memcpy(e.name, rec.profileName, PROFILE_NAME_LEN);
+  e.name[PROFILE_NAME_LEN - 1] = '\0';
+  return e;
+}
+
+} // namespace
+
+bool SessionArchive::begin() {
+  _ready = false;
+  // rollOver() moves the index first: an index without its log means the
+  // reset came before the log followed
+  if (LittleFS.exists(IDX_PATH[1]) && !LittleFS.exists(LOG_PATH[1]) && !LittleFS.exists(IDX_PATH[0])) {
+    LittleFS.rename(LOG_PATH[0], LOG_PATH[1]);
+  }
+  if (!openGeneration(1)) _gen[1] = Generation{};
+  // Missing or damaged index: the records carry their ids, read them back
+  if (!openGeneration(0) && !(rebuildIndex() && openGeneration(0))) {
+    // Nothing usable in the log either: start over after the previous generation
+    uint32_t firstId = _gen[1].count ? _gen[1].firstId + _gen[1].count : 1;
+    if (!startGeneration(firstId)) {
+      Serial.println("SessionArchive: cannot create index");
+      return false;
+    }
+  }
+  _nextId = _gen[0].firstId + _gen[0].count;
+  _ready = true;
+  Serial.printf("SessionArchive: %lu sessions, log %lu bytes\n",
+                (unsigned long)count(), (unsigned long)_gen[0].logBytes);
+  return true;
+}
+
+bool SessionArchive::openGeneration(uint8_t g) {
+  File f = LittleFS.open(IDX_PATH[g], "r");
+  if (!f) return false;
+  IndexHeader h;
+  size_t n = f.read((uint8_t*)&h, sizeof(h));
+  size_t size = f.size();
+  f.close();
+  if (n != sizeof(h) || h.magic != INDEX_MAGIC || h.version != FORMAT_VER ||
+      h.entrySize != sizeof(ArchiveEntry)) {
+    return false;
+  }
+  _gen[g].firstId = h.firstId;
+  _gen[g].count = (size - sizeof(h)) / sizeof(ArchiveEntry);
+  // A torn last entry: cut it off, or the next append would land misaligned
+  if (size != indexBytes(_gen[g].count) && !trimIndex(g)) return false;
+
+  _gen[g].logBytes = 0;
+  File log = LittleFS.open(LOG_PATH[g], "r");
+  if (log) {
+    _gen[g].logBytes = log.size();
+    log.close();
+  }
+  return true;
+}
+
+uint32_t SessionArchive::indexBytes(uint32_t count) {
+  return sizeof(IndexHeader) + count * sizeof(ArchiveEntry);
+}
+
+// Rewrites the index to its whole entries. LittleFS has no truncate on every
+// core, so the good part is copied and renamed over the original (atomic).
+bool SessionArchive::trimIndex(uint8_t g) {
+  File in = LittleFS.open(IDX_PATH[g], "r");
+  File out = LittleFS.open(IDX_TMP_PATH, "w");
+  uint32_t left = indexBytes(_gen[g].count);
+  uint8_t buf[4 * sizeof(ArchiveEntry)];
+  while (in && out && left > 0) {
+    size_t n = in.read(buf, left < sizeof(buf) ? left : sizeof(buf));
+    if (n == 0 || out.write(buf, n) != n) break;
+    left -= n;
+  }
+  bool ok = in && out && left == 0;
+  in.close();
+  out.close();
+  if (ok) ok = LittleFS.rename(IDX_TMP_PATH, IDX_PATH[g]);
+  if (!ok) {
+    LittleFS.remove(IDX_TMP_PATH);
+    Serial.printf("SessionArchive: cannot repair %s\n", IDX_PATH[g]);
+  }
+  return ok;
+}
+
+bool SessionArchive::rebuildIndex() {
+  File log = LittleFS.open(LOG_PATH[0], "r");
+  if (!log) return false;
+  File idx = LittleFS.open(IDX_TMP_PATH, "w");
+  if (!idx) return false;
+
+  // Records are whole at fixed size unless a write was cut short; after a
+  // bad one look for the next magic. A record with the id of the one before
+  // is a retry after a reset that came before its index append.
+  uint32_t size = log.size();
+  uint32_t offset = 0;
+  uint32_t count = 0;
+  bool ok = true;
+  bool have = false;
+  ArchiveEntry pending;
+  while (ok && offset + RECORD_BYTES <= size) {
+    RecordHeader h;
+    SessionSummary rec;
+    log.seek(offset);
+    if (!readRecord(log, 0, h, rec)) {
+      offset++;
+      continue;
+    }
+    if (!have) {
+      IndexHeader ih{INDEX_MAGIC, FORMAT_VER, (uint16_t)sizeof(ArchiveEntry), h.id};
+      ok = idx.write((const uint8_t*)&ih, sizeof(ih)) == sizeof(ih);
+    } else if (h.id == pending.id + 1) {
+      ok = idx.write((const uint8_t*)&pending, sizeof(pending)) == sizeof(pending);
+      count++;
+    } else if (h.id != pending.id) {
+      break;   // ids must stay sequential; later records can't be indexed
+    }
+    pending = entryFor(h.id, offset, rec);
+    have = true;
+    offset += RECORD_BYTES;
+  }
+  if (ok && have) {
+    ok = idx.write((const uint8_t*)&pending, sizeof(pending)) == sizeof(pending);
+    count++;
+  }
+  log.close();
+  idx.close();
+  if (ok && have) ok = LittleFS.rename(IDX_TMP_PATH, IDX_PATH[0]);
+  if (!ok || !have) {
+    LittleFS.remove(IDX_TMP_PATH);
+    return false;
+  }
+  Serial.printf("SessionArchive: index rebuilt, %lu sessions\n", (unsigned long)count);
+  return true;
+}
+
+bool SessionArchive::startGeneration(uint32_t firstId) {
+  if (LittleFS.exists(LOG_PATH[0])) LittleFS.remove(LOG_PATH[0]);
+  IndexHeader h{INDEX_MAGIC, FORMAT_VER, (uint16_t)sizeof(ArchiveEntry), firstId};
+  File f = LittleFS.open(IDX_PATH[0], "w");
+  if (!f) return false;
+  size_t n = f.write((const uint8_t*)&h, sizeof(h));
+  f.close();
+  _gen[0] = Generation{};
+  _gen[0].firstId = firstId;
+  return n == sizeof(h);
+}
+
+bool SessionArchive::rollOver() {
+  // Index first, both times: a log without an index is ignored, an index
+  // without a log is finished by begin()
+  if (LittleFS.exists(IDX_PATH[1])) LittleFS.remove(IDX_PATH[1]);
+  if (LittleFS.exists(LOG_PATH[1])) LittleFS.remove(LOG_PATH[1]);
+  LittleFS.rename(IDX_PATH[0], IDX_PATH[1]);
+  LittleFS.rename(LOG_PATH[0], LOG_PATH[1]);
+  _gen[1] = _gen[0];
+  Serial.printf("SessionArchive: log rolled over at id %lu\n", (unsigned long)_nextId);
+  return startGeneration(_nextId);
+}
+
+uint32_t SessionArchive::append(const SessionSummary& s) {
+  if (!_ready) return 0;
+  if (_gen[0].count > 0 && _gen[0].logBytes + RECORD_BYTES > MAX_LOG_BYTES) {
+    if (!rollOver()) return 0;
+  }
+
+  SessionSummary rec = s;
+  if (rec.startEpoch == 0) {
+    // Wall clock only if something (SNTP) has set it
+    time_t now = time(nullptr);
+    if (now > 1600000000) {
+      rec.startEpoch = (uint32_t)now - (sysClock.nowMs() - rec.startMs) / 1000;
+    }
+  }
+
+  uint32_t id = _nextId;
+  RecordHeader h{RECORD_MAGIC, id, FORMAT_VER, (uint16_t)sizeof(rec), crc32(&rec, sizeof(rec))};
+  // Log first: a reset before the index append only leaves an unreferenced record
+  File log = LittleFS.open(LOG_PATH[0], "a");
+  if (!log) return 0;
+  uint32_t offset = log.size();
+  size_t n = log.write((const uint8_t*)&h, sizeof(h));
+  n += log.write((const uint8_t*)&rec, sizeof(rec));
+  log.close();
+  if (n != RECORD_BYTES) return 0;
+  _gen[0].logBytes = offset + RECORD_BYTES;
+
+  ArchiveEntry e = entryFor(id, offset, rec);
+  File idx = LittleFS.open(IDX_PATH[0], "a");
+  if (!idx) return 0;
+  n = idx.write((const uint8_t*)&e, sizeof(e));
+  idx.close();
+  if (n != sizeof(e)) {
+    if (n > 0) trimIndex(0);
+    return 0;
+  }
+
+  _gen[0].count++;
+  _nextId++;
+  return id;
+}
+
+uint8_t SessionArchive::listRecent(ArchiveEntry* out, uint8_t n) {
+  uint8_t filled = 0;
+  for (uint8_t g = 0; g < 2 && filled < n; g++) {
+    uint32_t k = _gen[g].count;
+    if (k == 0) continue;
+    if (k > (uint32_t)(n - filled)) k = n - filled;
+
+    // Tail of the index in one read, then newest first
+    File f = LittleFS.open(IDX_PATH[g], "r");
+    if (!f) continue;
+    f.seek(sizeof(IndexHeader) + (_gen[g].count - k) * sizeof(ArchiveEntry));
+    size_t got = f.read((uint8_t*)(out + filled), k * sizeof(ArchiveEntry)) / sizeof(ArchiveEntry);
+    f.close();
+    for (size_t a = 0, b = got; a + 1 < b; a++, b--) {
+      ArchiveEntry t = out[filled + a];
+      out[filled + a] = out[filled + b - 1];
+      out[filled + b - 1] = t;
+    }
+    // Entry ids follow the position; anything else is a damaged row
+    uint32_t id = _gen[g].firstId + _gen[g].count - 1;
+    uint8_t kept = 0;
+    for (size_t a = 0; a < got; a++, id--) {
+      if (out[filled + a].id == id) out[filled + kept++] = out[filled + a];
+    }
+    filled += kept;
+  }
+  return filled;
+}
+
+bool SessionArchive::readEntry(uint8_t g, uint32_t pos, ArchiveEntry& e) {
+  File f = LittleFS.open(IDX_PATH[g], "r");
+  if (!f) return false;
+  f.seek(sizeof(IndexHeader) + pos * sizeof(ArchiveEntry));
+  size_t n = f.read((uint8_t*)&e, sizeof(e));
+  f.close();
+  return n == sizeof(e);
+}
+
+bool SessionArchive::fetch(uint32_t id, SessionSummary& out) {
+  for (uint8_t g = 0; g < 2; g++) {
+    const Generation& gen = _gen[g];
+    if (id < gen.firstId || id - gen.firstId >= gen.count) continue;
+
+    ArchiveEntry e;
+    if (!readEntry(g, id - gen.firstId, e) || e.id != id) return false;
+
+    File log = LittleFS.open(LOG_PATH[g], "r");
+    if (!log) return false;
+    log.seek(e.offset);
+    RecordHeader h;
+    SessionSummary rec;
+    bool ok = readRecord(log, id, h, rec);
+    log.close();
+    if (ok) out = rec;
+    return ok;
+  }
+  return false;
+}
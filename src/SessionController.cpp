@@ -1,4 +1,6 @@
 #include "SessionController.h"
+#include "Clock.h"
+#include <string.h>
 
 void SessionController::begin(MotorController* motor) {
   _motor = motor;
@@ -13,6 +15,11 @@ void SessionController::begin(MotorController* motor) {
 void SessionController::tick() {
   if (!_motor) return;
   
+  // Advance with the rate of the interval just ended, then pick up any
+  // temperature/settings change for the next one
+  integrate();
+  refreshSchedule();
+  
   checkTempLimits();
   updateTimer();
   applyToMotor();
@@ -20,27 +27,31 @@ void SessionController::tick() {
 }
 
 void SessionController::checkTempLimits() {
-  if (!_settings.tempLimitsEnabled || isnan(_currentTempC)) {
+  if (!_settings.tempLimitsEnabled) {
     _tempAlarm = false;
     _tempLow = false;
     _tempHigh = false;
     return;
   }
   
-  _tempLow = _currentTempC < _settings.tempMin;
-  _tempHigh = _currentTempC > _settings.tempMax;
+  // The sensor's own breach flags trip on the first out-of-range reading,
+  // before the filtered estimate has caught up
+  bool haveTemp = !isnan(_currentTempC);
+  _tempLow = _breachLow || (haveTemp && _currentTempC < _settings.tempMin);
+  _tempHigh = _breachHigh || (haveTemp && _currentTempC > _settings.tempMax);
   bool wasAlarm = _tempAlarm;
   _tempAlarm = _tempLow || _tempHigh;
   
+  if (_tempAlarm && !wasAlarm && _summaryActive) {
+    _summary.alarms++;
+  }
+  
   // Apply alarm action when alarm starts (not on every tick)
   if (_tempAlarm && !wasAlarm && _running) {
-    // Get alarm action (step override or profile)
+    // Alarm action (step override or profile), resolved in the schedule
     TempAlarmAction action = _settings.tempAlarmAction;
     if (_currentStep >= 0 && _currentStep < _settings.stepCount) {
-      const auto& step = _settings.steps[_currentStep];
-      if (step.tempCoefOverride) {
-        action = step.tempAlarmAction;
-      }
+      action = _schedule[_currentStep].alarmAction;
     }
     
     switch (action) {
@@ -52,15 +63,14 @@ void SessionController::checkTempLimits() {
         break;
       case TempAlarmAction::Pause:
         // Pause the process
+        pauseTimer();
         _running = false;
         _paused = true;
-        _stepPausedMs += millis() - _stepStartMs;
-        _timerActive = false;
         Serial.println("TempAlarm: PAUSE action triggered");
         break;
       case TempAlarmAction::Stop:
         // Stop the process completely
-        stop();
+        endSession(SessionEnd::Alarm);
         Serial.println("TempAlarm: STOP action triggered");
         break;
     }
@@ -73,18 +83,18 @@ void SessionController::start() {
     // Resume from pause between steps
     _paused = false;
     _running = true;
-    _timerActive = true;
-    _stepStartMs = millis();
+    startTimer();
     Serial.println("  -> resumed from pause");
   } else {
     // Fresh start
     _running = true;
     _currentStep = 0;
+    _rpmOverride = 0;
+    resetDev();
+    beginSummary(false);
     int32_t stepDur = _settings.steps[_currentStep].durationSec;
     if (stepDur > 0) {
-      _timerActive = true;
-      _stepStartMs = millis();
-      _stepPausedMs = 0;
+      startTimer();
     }
     Serial.printf("  -> fresh start, stepDur=%d\n", stepDur);
   }
@@ -92,19 +102,50 @@ void SessionController::start() {
 
 void SessionController::stop() {
   Serial.println("stop() called");
+  endSession(SessionEnd::Stopped);
+}
+
+void SessionController::endSession(SessionEnd why) {
+  if (_summaryActive) {
+    integrate();
+    _summaryActive = false;
+    _summary.end = why;
+    for (int8_t i = 0; i < MAX_STEPS; i++) {
+      _summary.stepActualSec[i] = (int32_t)((_stepRunUs[i] + US_PER_SEC / 2) / US_PER_SEC);
+    }
+    if (_tempUs > 0) _summary.tempMeanC = (float)((double)_tempSum / _tempUs / 100.0);
+    if (_motor) _summary.reversals = _motor->reversals() - _revStart;
+    if (_endCb) _endCb(_summary);
+  }
   _running = false;
   _paused = false;
+  _rpmOverride = 0;
   resetTimer();
 }
 
+void SessionController::beginSummary(bool resumed) {
+  _summary = SessionSummary{};
+  strlcpy(_summary.profileName, _settings.profileName, sizeof(_summary.profileName));
+  _summary.startMs = sysClock.nowMs();
+  _summary.stepCount = _settings.stepCount;
+  for (int8_t i = 0; i < _settings.stepCount; i++) {
+    _summary.stepPlannedSec[i] = _settings.steps[i].durationSec;
+  }
+  _summary.resumed = resumed;
+  // Steps before a resume point count as done, their times are unknown
+  _summary.stepsDone = resumed ? _currentStep : 0;
+  memset(_stepRunUs, 0, sizeof(_stepRunUs));
+  _tempSum = 0;
+  _tempUs = 0;
+  _revStart = _motor ? _motor->reversals() : 0;
+  _summaryActive = true;
+}
+
 void SessionController::toggleRun() {
   Serial.printf("toggleRun: run=%d pause=%d step=%d\n", _running, _paused, _currentStep);
   if (_running) {
     // Pause current step
-    if (_timerActive) {
-      _stepPausedMs += millis() - _stepStartMs;
-      _timerActive = false;
-    }
+    pauseTimer();
     _running = false;
     Serial.println("  -> paused mid-step");
   } else if (_paused) {
@@ -113,32 +154,48 @@ void SessionController::toggleRun() {
     nextStep();
   } else {
     // Start/resume
+    if (!_summaryActive) beginSummary(false);
     _running = true;
     int32_t stepDur = _settings.steps[_currentStep].durationSec;
     if (stepDur > 0 && !_timerActive) {
-      _timerActive = true;
-      _stepStartMs = millis();
+      startTimer();
     }
     Serial.printf("  -> started, stepDur=%d\n", stepDur);
   }
 }
 
+void SessionController::resumeAt(int8_t step, uint64_t devUs, bool running, bool paused) {
+  if (step < 0 || step >= _settings.stepCount) return;
+  Serial.printf("resumeAt: step=%d dev=%.1f run=%d pause=%d\n", step, devUs / 1000000.0f, running, paused);
+  _currentStep = step;
+  _rpmOverride = 0;
+  _devUs = devUs;
+  _devFracQ16 = 0;
+  _paused = paused;
+  _running = running && !paused;
+  _timerActive = false;
+  beginSummary(true);
+  if (_running && _settings.steps[step].durationSec > 0) {
+    startTimer();
+  }
+}
+
 void SessionController::nextStep() {
   Serial.printf("nextStep: cur=%d stepCount=%d\n", _currentStep, _settings.stepCount);
+  _rpmOverride = 0;
   if (_currentStep + 1 < _settings.stepCount) {
     _currentStep++;
     _paused = false;
     _running = true;
-    _stepPausedMs = 0;
+    resetDev();
     int32_t stepDur = _settings.steps[_currentStep].durationSec;
     Serial.printf("  -> step %d dur=%d\n", _currentStep, stepDur);
     if (stepDur > 0) {
-      _timerActive = true;
-      _stepStartMs = millis();
+      startTimer();
     }
   } else {
     Serial.println("  -> all done, stop()");
-    stop();
+    endSession(SessionEnd::Completed);
   }
 }
 
@@ -162,10 +219,6 @@ void SessionController::applyToMotor() {
   _motor->setReverseEverySec(_settings.reverseIntervalSec);
 }
 
-float SessionController::calcTempCoefMultiplier() const {
-  return calcTempCoefMultiplierForStep(_currentStep);
-}
-
 float SessionController::calcTempCoefMultiplierForStep(int8_t stepIdx) const {
   if (isnan(_currentTempC)) return 1.0f;
   
@@ -189,121 +242,175 @@ float SessionController::calcTempCoefMultiplierForStep(int8_t stepIdx) const {
   return 1.0f + (tempDiff * percent / 100.0f);
 }
 
-float SessionController::adjustedRpm() const {
-  // Use current step's RPM if running
-  float rpm = (float)_settings.targetRpm;
-  if (_currentStep >= 0 && _currentStep < _settings.stepCount && _running) {
-    rpm = (float)_settings.steps[_currentStep].rpm;
-  }
+void SessionController::compileStep(int8_t stepIdx, CompiledStep& out) const {
+  const auto& step = _settings.steps[stepIdx];
   
   // Get temp coef settings (step override or profile)
   bool enabled = _settings.tempCoefEnabled;
   TempCoefTarget target = _settings.tempCoefTarget;
-  if (_currentStep >= 0 && _currentStep < _settings.stepCount) {
-    const auto& step = _settings.steps[_currentStep];
-    if (step.tempCoefOverride) {
-      enabled = step.tempCoefEnabled;
-      target = step.tempCoefTarget;
-    }
+  out.alarmAction = _settings.tempAlarmAction;
+  if (step.tempCoefOverride) {
+    enabled = step.tempCoefEnabled;
+    target = step.tempCoefTarget;
+    out.alarmAction = step.tempAlarmAction;
   }
+  bool active = enabled && !isnan(_currentTempC);
+  float mult = active ? calcTempCoefMultiplierForStep(stepIdx) : 1.0f;
   
-  if (enabled && !isnan(_currentTempC)) {
-    if (target == TempCoefTarget::Rpm || target == TempCoefTarget::Both) {
-      rpm *= calcTempCoefMultiplier();
-      if (rpm < 1.0f) rpm = 1.0f;
-      if (rpm > 80.0f) rpm = 80.0f;
-    }
+  // Timer: higher temp = faster development = shorter time
+  out.baseDurationSec = step.durationSec;
+  out.timerRate = 1.0f;
+  if (active && (target == TempCoefTarget::Timer || target == TempCoefTarget::Both)) {
+    out.timerRate = mult < MIN_TIMER_RATE ? MIN_TIMER_RATE : mult;
+  }
+  out.timerRateQ16 = (uint32_t)lroundf(out.timerRate * 65536.0f);
+  out.adjustedDurationSec = step.durationSec;
+  if (step.durationSec > 0 && out.timerRate != 1.0f) {
+    out.adjustedDurationSec = (int32_t)(step.durationSec / out.timerRate);
+    if (out.adjustedDurationSec < 1) out.adjustedDurationSec = 1;
+  }
+  
+  // RPM: higher temp = faster agitation
+  out.rpmAdjusted = active && (target == TempCoefTarget::Rpm || target == TempCoefTarget::Both);
+  out.rpmMult = out.rpmAdjusted ? mult : 1.0f;
+  out.rpm = (float)step.rpm;
+  if (out.rpmAdjusted) {
+    out.rpm *= mult;
+    if (out.rpm < 1.0f) out.rpm = 1.0f;
+    if (out.rpm > 80.0f) out.rpm = 80.0f;
+  }
+}
+
+float SessionController::adjustedRpm() const {
+  float rpm = (float)_settings.targetRpm;
+  if (_currentStep < 0 || _currentStep >= _settings.stepCount) return rpm;
+  
+  // Use current step's RPM if running
+  const auto& cs = _schedule[_currentStep];
+  if (_running) return _rpmOverride > 0 ? (float)_rpmOverride : cs.rpm;
+  
+  if (cs.rpmAdjusted) {
+    rpm *= cs.rpmMult;
+    if (rpm < 1.0f) rpm = 1.0f;
+    if (rpm > 80.0f) rpm = 80.0f;
   }
   return rpm;
 }
 
 int32_t SessionController::adjustedStepDurationSec(int8_t stepIdx) const {
   if (stepIdx < 0 || stepIdx >= _settings.stepCount) return 0;
-  const auto& step = _settings.steps[stepIdx];
-  int32_t dur = step.durationSec;
-  if (dur == 0) return 0;
-  
-  // Get temp coef settings (step override or profile)
-  bool enabled = _settings.tempCoefEnabled;
-  TempCoefTarget target = _settings.tempCoefTarget;
-  if (step.tempCoefOverride) {
-    enabled = step.tempCoefEnabled;
-    target = step.tempCoefTarget;
-  }
-  
-  if (enabled && !isnan(_currentTempC)) {
-    if (target == TempCoefTarget::Timer || target == TempCoefTarget::Both) {
-      float mult = calcTempCoefMultiplierForStep(stepIdx);
-      // For timer: higher temp = shorter time (inverse relationship)
-      // Standard film dev: each degree above base reduces time
-      dur = (int32_t)(dur / mult);
-      if (dur < 1) dur = 1;
+  return _schedule[stepIdx].adjustedDurationSec;
+}
+
+void SessionController::startTimer() {
+  _timerActive = true;
+  _lastIntegrateUs = sysClock.nowUs();
+}
+
+void SessionController::pauseTimer() {
+  integrate();
+  _timerActive = false;
+}
+
+void SessionController::integrate() {
+  uint64_t now = sysClock.nowUs();
+  if (_timerActive) {
+    uint64_t dt = now - _lastIntegrateUs;
+    // 16.16 rate; the fraction is carried so no microsecond is ever lost
+    uint64_t acc = dt * _stepRateQ16 + _devFracQ16;
+    _devUs += acc >> 16;
+    _devFracQ16 = (uint32_t)(acc & 0xFFFF);
+    
+    if (_summaryActive && _currentStep >= 0 && _currentStep < MAX_STEPS) {
+      _stepRunUs[_currentStep] += dt;
+      if (!isnan(_currentTempC)) {
+        if (isnan(_summary.tempMinC) || _currentTempC < _summary.tempMinC) _summary.tempMinC = _currentTempC;
+        if (isnan(_summary.tempMaxC) || _currentTempC > _summary.tempMaxC) _summary.tempMaxC = _currentTempC;
+        _tempSum += (int64_t)lroundf(_currentTempC * 100.0f) * (int64_t)dt;
+        _tempUs += dt;
+      }
     }
   }
-  return dur;
+  _lastIntegrateUs = now;
 }
 
-int32_t SessionController::stepRemainingSec() const {
-  if (_currentStep >= _settings.stepCount) return 0;
-  int32_t stepDur = adjustedStepDurationSec(_currentStep);
-  if (stepDur == 0) return 0;
+void SessionController::refreshSchedule() {
+  // Rebuild only when an input changed: settings version, step count or
+  // the temperature bucket (0.1C)
+  int16_t bucket = isnan(_currentTempC) ? INT16_MIN : (int16_t)lroundf(_currentTempC * 10.0f);
+  if (_schedVersion != _settingsVersion || _schedTempBucket != bucket ||
+      _schedStepCount != _settings.stepCount) {
+    _schedVersion = _settingsVersion;
+    _schedTempBucket = bucket;
+    _schedStepCount = _settings.stepCount;
+    _scheduleRebuilds++;
+    
+    int32_t after = 0;
+    for (int8_t i = _settings.stepCount - 1; i >= 0; i--) {
+      compileStep(i, _schedule[i]);
+      _remainingAfter[i] = after;
+      after += _schedule[i].adjustedDurationSec;
+    }
+  }
   
-  uint32_t elapsedMs;
-  if (_timerActive) {
-    elapsedMs = millis() - _stepStartMs + _stepPausedMs;
-  } else if (_stepPausedMs > 0) {
-    elapsedMs = _stepPausedMs;
+  if (_currentStep >= 0 && _currentStep < _settings.stepCount) {
+    _stepRateQ16 = _schedule[_currentStep].timerRateQ16;
+    _futureRemainingSec = _remainingAfter[_currentStep];
   } else {
-    return stepDur;
+    _stepRateQ16 = 1UL << 16;
+    _futureRemainingSec = 0;
   }
-  
-  int32_t remaining = stepDur - (int32_t)(elapsedMs / 1000);
-  return remaining > 0 ? remaining : 0;
 }
 
-int32_t SessionController::totalRemainingSec() const {
-  int32_t total = stepRemainingSec();
-  for (int8_t i = _currentStep + 1; i < _settings.stepCount; i++) {
-    total += adjustedStepDurationSec(i);
+void SessionController::updateStepRemaining() {
+  if (_currentStep >= _settings.stepCount) {
+    _stepRemainingSec = 0;
+    return;
   }
-  return total;
+  int32_t stepDur = _settings.steps[_currentStep].durationSec;
+  if (stepDur == 0) {
+    _stepRemainingSec = 0;
+    return;
+  }
+  uint64_t durUs = (uint64_t)stepDur * US_PER_SEC;
+  if (_devUs >= durUs) {
+    _stepRemainingSec = 0;
+    return;
+  }
+  uint64_t leftUs = ((durUs - _devUs) << 16) / _stepRateQ16;
+  _stepRemainingSec = (int32_t)((leftUs + US_PER_SEC - 1) / US_PER_SEC);
 }
 
 void SessionController::updateTimer() {
-  if (_currentStep >= _settings.stepCount) return;
-  if (!_running || _paused) return;
-  
-  int32_t stepDur = adjustedStepDurationSec(_currentStep);
-  if (stepDur == 0) return;
-  
-  if (!_timerActive) {
-    _timerActive = true;
-    _stepStartMs = millis();
-    Serial.printf("updateTimer: started timer for step %d, dur=%d\n", _currentStep, stepDur);
-  }
-  
-  uint32_t elapsedMs = millis() - _stepStartMs + _stepPausedMs;
-  if ((int32_t)(elapsedMs / 1000) >= stepDur) {
-    // Step complete
-    Serial.printf("updateTimer: step %d complete, elapsed=%lu\n", _currentStep, elapsedMs);
-    _timerActive = false;
-    _stepPausedMs = 0;
-    
-    if (_currentStep + 1 < _settings.stepCount) {
-      // More steps - pause and wait for user
-      Serial.println("  -> pausing for next step");
-      _running = false;
-      _paused = true;
-    } else {
-      // All done
-      Serial.println("  -> all steps done");
-      stop();
+  if (_currentStep < _settings.stepCount && _running && !_paused) {
+    int32_t stepDur = _settings.steps[_currentStep].durationSec;
+    if (stepDur > 0 && !_timerActive) {
+      startTimer();
+      Serial.printf("updateTimer: started timer for step %d, dur=%d\n", _currentStep, stepDur);
+    } else if (stepDur > 0 && _devUs >= (uint64_t)stepDur * US_PER_SEC) {
+      // Step complete
+      Serial.printf("updateTimer: step %d complete, dev=%.1f\n", _currentStep, stepDevUnits());
+      _timerActive = false;
+      if (_summaryActive) _summary.stepsDone = _currentStep + 1;
+      
+      if (_currentStep + 1 < _settings.stepCount) {
+        // More steps - pause and wait for user
+        Serial.println("  -> pausing for next step");
+        _running = false;
+        _paused = true;
+      } else {
+        // All done
+        Serial.println("  -> all steps done");
+        endSession(SessionEnd::Completed);
+      }
     }
   }
+  
+  updateStepRemaining();
 }
 
 void SessionController::resetTimer() {
   _timerActive = false;
   _currentStep = 0;
-  _stepPausedMs = 0;
+  resetDev();
 }
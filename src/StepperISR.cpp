@@ -1,4 +1,5 @@
 #include "StepperISR.h"
+#include "Clock.h"
 #include <math.h>
 
 StepperISR* StepperISR::self = nullptr;
@@ -86,9 +87,10 @@ void StepperISR::setSpeedSps(float sps) {
   // Debug
   static uint32_t lastDbg = 0;
   static uint32_t lastInterval = 0;
-  if (intervalUs != lastInterval || millis() - lastDbg > 1000) {
+  uint32_t nowMs = sysClock.nowMs();
+  if (intervalUs != lastInterval || nowMs - lastDbg > 1000) {
     Serial.printf("ISR setSpeed: sps=%.1f interval=%u\n", sps, intervalUs);
-    lastDbg = millis();
+    lastDbg = nowMs;
     lastInterval = intervalUs;
   }
 
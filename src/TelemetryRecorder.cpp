@@ -0,0 +1,223 @@
+#include "TelemetryRecorder.h"
+#include "Clock.h"
+#include <string.h>
+
+// Delta record: flags byte, [ext byte], temp, [rpm], [step], [target]
+namespace {
+constexpr uint8_t F_STATE = 0x0F;   // TS_* bits, absolute
+constexpr uint8_t F_T16 = 0x10;     // temp is int16 absolute (else int8 delta)
+constexpr uint8_t F_RPM = 0x20;     // actual rpm delta present
+constexpr uint8_t F_R16 = 0x40;     // ...as int16 (else int8)
+constexpr uint8_t F_EXT = 0x80;     // ext byte follows
+constexpr uint8_t X_STEP = 0x01;    // int8 step follows
+constexpr uint8_t X_TARGET = 0x02;  // int16 target rpm follows
+
+int16_t clamp16(float v) {
+  if (v > 32767.0f) return 32767;
+  if (v < -32767.0f) return -32767;
+  return (int16_t)lroundf(v);
+}
+
+void put16(uint8_t*& p, int16_t v) {
+  *p++ = (uint8_t)(v & 0xFF);
+  *p++ = (uint8_t)((uint16_t)v >> 8);
+}
+
+int16_t get16(const uint8_t*& p) {
+  int16_t v = (int16_t)(p[0] | (p[1] << 8));
+  p += 2;
+  return v;
+}
+} // namespace
+
+void TelemetryRecorder::start() {
+  _oldestSeq = _nextSeq = 0;
+  _dropped = 0;
+  _startMs = sysClock.nowMs();
+  _nextDueMs = _startMs;
+  _newBlock = true;
+  _recording = true;
+}
+
+void TelemetryRecorder::stop() {
+  _recording = false;
+}
+
+void TelemetryRecorder::setPeriodMs(uint16_t ms) {
+  if (ms < 100) ms = 100;
+  if (ms == _periodMs) return;
+  _periodMs = ms;
+  // Block timestamps assume one period per block - start a new one
+  _newBlock = true;
+}
+
+bool TelemetryRecorder::due() const {
+  return _recording && (int32_t)(sysClock.nowMs() - _nextDueMs) >= 0;
+}
+
+TelemetryRecorder::Block* TelemetryRecorder::blockFor(uint32_t seq) {
+  if (seq < _oldestSeq || seq >= _nextSeq) return nullptr;
+  return &_blocks[seq % BLOCKS];
+}
+
+TelemetryQ TelemetryRecorder::quantize(const TelemetrySample& s) {
+  TelemetryQ q;
+  q.temp = isnan(s.tempC) ? TEMP_NONE : clamp16(s.tempC * 16.0f);  // never hits the sentinel
+  q.rpmTarget = clamp16(s.rpmTarget * 2.0f);
+  q.rpmActual = clamp16(s.rpmActual * 2.0f);
+  q.step = s.step;
+  q.state = (s.dirFwd ? TS_DIR_FWD : 0) | (s.tempLow ? TS_TEMP_LOW : 0) |
+            (s.tempHigh ? TS_TEMP_HIGH : 0) | (s.tempAlarm ? TS_ALARM : 0);
+  return q;
+}
+
+void TelemetryRecorder::openBlock(uint32_t t, const TelemetryQ& q) {
+  if (_nextSeq - _oldestSeq >= BLOCKS) {
+    _oldestSeq++;
+    _dropped++;
+  }
+  Block& b = _blocks[_nextSeq % BLOCKS];
+  b.h.seq = _nextSeq++;
+  b.h.startMs = t;
+  b.h.periodMs = _periodMs;
+  b.h.count = 1;
+  b.h.used = 0;
+  b.h.key = q;
+}
+
+void TelemetryRecorder::record(const TelemetrySample& s) {
+  uint32_t now = sysClock.nowMs();
+  // Nominal sample time; resync instead of bursting after a long stall.
+  // Rows are stamped startMs + n * period, so a resync opens a new block
+  // at the real time (as TelemetryStream does with its frames).
+  uint32_t t = _nextDueMs - _startMs;
+  _nextDueMs += _periodMs;
+  if ((int32_t)(now - _nextDueMs) >= 0) {
+    t = now - _startMs;
+    _nextDueMs = now + _periodMs;
+    _newBlock = true;
+  }
+
+  TelemetryQ q = quantize(s);
+  Block* b = blockFor(_nextSeq - 1);
+  if (!b || _newBlock || b->h.used + MAX_SAMPLE_BYTES > DATA_BYTES) {
+    openBlock(t, q);
+    _newBlock = false;
+  } else {
+    b->h.used += encode(_last, q, b->data + b->h.used);
+    b->h.count++;
+  }
+  _last = q;
+}
+
+uint8_t TelemetryRecorder::encode(const TelemetryQ& prev, const TelemetryQ& q, uint8_t* out) {
+  uint8_t* p = out;
+  uint8_t flags = q.state & F_STATE;
+  uint8_t ext = 0;
+
+  int32_t dt = (int32_t)q.temp - prev.temp;
+  bool t16 = q.temp == TEMP_NONE || prev.temp == TEMP_NONE || dt < -128 || dt > 127;
+  if (t16) flags |= F_T16;
+
+  int32_t dr = (int32_t)q.rpmActual - prev.rpmActual;
+  if (dr != 0) {
+    flags |= F_RPM;
+    if (dr < -128 || dr > 127) flags |= F_R16;
+  }
+
+  if (q.step != prev.step) ext |= X_STEP;
+  if (q.rpmTarget != prev.rpmTarget) ext |= X_TARGET;
+  if (ext) flags |= F_EXT;
+
+  *p++ = flags;
+  if (ext) *p++ = ext;
+  if (t16) put16(p, q.temp);
+  else *p++ = (uint8_t)(int8_t)dt;
+  if (flags & F_RPM) {
+    if (flags & F_R16) put16(p, (int16_t)dr);
+    else *p++ = (uint8_t)(int8_t)dr;
+  }
+  if (ext & X_STEP) *p++ = (uint8_t)q.step;
+  if (ext & X_TARGET) put16(p, q.rpmTarget);
+  return (uint8_t)(p - out);
+}
+
+uint8_t TelemetryRecorder::decode(const uint8_t* in, TelemetryQ& q) {
+  const uint8_t* p = in;
+  uint8_t flags = *p++;
+  uint8_t ext = (flags & F_EXT) ? *p++ : 0;
+
+  q.state = flags & F_STATE;
+  if (flags & F_T16) q.temp = get16(p);
+  else q.temp += (int8_t)*p++;
+  if (flags & F_RPM) {
+    if (flags & F_R16) q.rpmActual += get16(p);
+    else q.rpmActual += (int8_t)*p++;
+  }
+  if (ext & X_STEP) q.step = (int8_t)*p++;
+  if (ext & X_TARGET) q.rpmTarget = get16(p);
+  return (uint8_t)(p - in);
+}
+
+void TelemetryRecorder::printRow(Print& out, uint32_t t, const TelemetryQ& q) {
+  char temp[12] = "";
+  if (q.temp != TEMP_NONE) snprintf(temp, sizeof(temp), "%.2f", q.temp / 16.0f);
+  char line[80];
+  snprintf(line, sizeof(line), "%lu,%d,%s,%.1f,%.1f,%d,%d,%d,%d",
+           (unsigned long)t, q.step + 1, temp, q.rpmTarget / 2.0f, q.rpmActual / 2.0f,
+           (q.state & TS_DIR_FWD) ? 1 : 0, (q.state & TS_TEMP_LOW) ? 1 : 0,
+           (q.state & TS_TEMP_HIGH) ? 1 : 0, (q.state & TS_ALARM) ? 1 : 0);
+  out.println(line);
+}
+
+bool TelemetryRecorder::exportCsv(Print& out, TelemetryCursor& c, uint16_t maxLines) {
+  if (!c.started) {
+    out.println("t_ms,step,temp_c,rpm_target,rpm_actual,dir_fwd,temp_low,temp_high,alarm");
+    c = TelemetryCursor{};
+    c.started = true;
+    c.seq = _oldestSeq;
+  }
+
+  uint16_t lines = 0;
+  while (lines < maxLines) {
+    if (c.seq < _oldestSeq) {
+      // Overwritten while we were exporting
+      out.println("# gap");
+      c.seq = _oldestSeq;
+      c.sample = 0;
+    }
+    Block* b = blockFor(c.seq);
+    if (!b) return true;  // past the newest block
+    if (c.sample >= b->h.count) {
+      if (c.seq + 1 >= _nextSeq) return true;  // caught up with the recorder
+      c.seq++;
+      c.sample = 0;
+      continue;
+    }
+
+    if (c.sample == 0) {
+      c.q = b->h.key;
+      c.offset = 0;
+    } else {
+      c.offset += decode(b->data + c.offset, c.q);
+    }
+    printRow(out, b->h.startMs + (uint32_t)c.sample * b->h.periodMs, c.q);
+    c.sample++;
+    lines++;
+  }
+  return false;
+}
+
+uint32_t TelemetryRecorder::sampleCount() const {
+  uint32_t n = 0;
+  for (uint32_t seq = _oldestSeq; seq < _nextSeq; seq++) n += _blocks[seq % BLOCKS].h.count;
+  return n;
+}
+
+uint32_t TelemetryRecorder::bytesUsed() const {
+  uint32_t n = 0;
+  for (uint32_t seq = _oldestSeq; seq < _nextSeq; seq++) {
+    n += sizeof(BlockHeader) + _blocks[seq % BLOCKS].h.used;
+  }
+  return n;
+}
@@ -0,0 +1,67 @@
+#include "TelemetryStream.h"
+#include <string.h>
+
+void TelemetryStream::setRate(uint8_t hz) {
+  if (hz && hz < MIN_HZ) hz = MIN_HZ;
+  if (hz > MAX_HZ) hz = MAX_HZ;
+  if (hz == _hz) return;
+  _hz = hz;
+  _periodMs = hz ? 1000 / hz : 0;
+  _len = 0;
+  _carry = false;
+}
+
+void TelemetryStream::open(const TelemetryQ& q, uint32_t t) {
+  BinTelemetry& h = header();
+  h.type = BIN_MSG_TELEMETRY;
+  h.version = BIN_VERSION;
+  h.count = 1;
+  h.state = q.state;
+  h.periodMs = _periodMs;
+  h.seq = _seq++;
+  h.t0Ms = t;
+  h.temp = q.temp;
+  h.rpmTarget = q.rpmTarget;
+  h.rpmActual = q.rpmActual;
+  h.step = q.step;
+  h.reserved = 0;
+  _len = sizeof(BinTelemetry);
+  _last = q;
+}
+
+bool TelemetryStream::add(const TelemetrySample& s, uint32_t nowMs) {
+  // Nominal sample time, as in TelemetryRecorder; a stall resyncs the schedule
+  uint32_t t = _nextDueMs;
+  _nextDueMs += _periodMs;
+  bool stalled = (int32_t)(nowMs - _nextDueMs) >= 0;
+  if (stalled || _len == 0) {
+    t = nowMs;
+    _nextDueMs = nowMs + _periodMs;
+  }
+
+  TelemetryQ q = TelemetryRecorder::quantize(s);
+  if (_len == 0) {
+    open(q, t);
+  } else if (stalled) {
+    _carry = true;
+    _carryQ = q;
+    _carryMs = t;
+    return true;
+  } else {
+    _len += TelemetryRecorder::encode(_last, q, _buf + _len);
+    header().count++;
+    _last = q;
+  }
+
+  return header().count >= MAX_SAMPLES ||
+         _len + TelemetryRecorder::MAX_SAMPLE_BYTES > FRAME_BYTES ||
+         nowMs - header().t0Ms >= MAX_AGE_MS;
+}
+
+void TelemetryStream::next() {
+  _len = 0;
+  if (_carry) {
+    _carry = false;
+    open(_carryQ, _carryMs);
+  }
+}
@@ -1,4 +1,5 @@
 #include "TempSensor.h"
+#include "Clock.h"
 
 void TempSensor::begin(uint8_t pin) {
   static OneWire ow(pin);
@@ -10,30 +11,55 @@ void TempSensor::begin(uint8_t pin) {
   _dt->begin();
   _dt->setWaitForConversion(false);
 
+  detect();
+
+  _lastCycleMs = sysClock.nowMs();
+  _phase = IDLE;
+}
+
+void TempSensor::detect() {
   _hasSensor = _dt->getAddress(_addr, 0);
-  if (_hasSensor) {
-    _dt->setResolution(_addr, 12);
+  _filterValid = false;
+  if (!_hasSensor) return;
+
+  // Keep whatever TH/TL the sensor holds unless we own the alarm limits
+  ScratchPad sp;
+  if (_dt->isConnected(_addr, sp)) {
+    _th = sp[2];
+    _tl = sp[3];
   }
+  if (_alarmArmed) alarmRegisters(_th, _tl);
+  _alarmDirty = false;
+  writeScratch(12);
+}
 
-  _lastCycleMs = millis();
-  _phase = IDLE;
+bool TempSensor::writeScratch(uint8_t resolution) {
+  // WRITE SCRATCHPAD only - setResolution() would also COPY SCRATCHPAD to
+  // EEPROM, which wears the sensor out when switching resolution at runtime.
+  if (!_ow->reset()) return false;
+  _ow->select(_addr);
+  _ow->write(0x4E);
+  _ow->write(_th);
+  _ow->write(_tl);
+  _ow->write((uint8_t)(((resolution - 9) << 5) | 0x1F));
+  _resolution = resolution;
+  return true;
 }
 
 void TempSensor::tick() {
   // retry detect occasionally if missing
+  uint32_t now = sysClock.nowMs();
+
   if (!_hasSensor) {
-    if (millis() - _lastCycleMs > 2000) {
-      _lastCycleMs = millis();
-      _hasSensor = _dt->getAddress(_addr, 0);
-      if (_hasSensor) _dt->setResolution(_addr, 12);
+    if (now - _lastCycleMs > 2000) {
+      _lastCycleMs = now;
+      detect();
     }
     return;
   }
 
-  uint32_t now = millis();
-
   if (_phase == IDLE) {
-    if (now - _lastCycleMs >= PERIOD_MS) {
+    if (now - _lastCycleMs >= periodMs()) {
       _lastCycleMs = now;
       _dt->requestTemperaturesByAddress(_addr);
       _phase = WAIT;
@@ -43,14 +69,154 @@ void TempSensor::tick() {
   }
 
   // WAIT
-  if (now - _phaseTsMs >= CONV_WAIT_MS) {
-    float t = _dt->getTempC(_addr);
-    if (t > -80 && t < 150) {
+  if (now - _phaseTsMs >= convWaitMs()) {
+    _phase = IDLE;
+
+    // Stable and armed: ALARM SEARCH (a few bit slots when nothing is out
+    // of range) stands in for most full scratchpad reads.
+    if (_alarmArmed && _filterValid && _resolution >= 12 &&
+        _skippedReads + 1 < FULL_READ_EVERY) {
+      _alarmChecks++;
+      if (!alarmSearch()) {
+        _skippedReads++;
+        if (_alarmDirty) applyAlarmRegisters();
+        return;
+      }
+    }
+    _skippedReads = 0;
+    _fullReads++;
+
+    float t;
+    if (readSample(t)) {
       _tempC = t;
+      updateFilter(t, now);
+      float c = t + _offset;
+      _alarmLow = _alarmArmed && c < _alarmMinC;
+      _alarmHigh = _alarmArmed && c > _alarmMaxC;
     } else {
       _tempC = NAN;
+      _filterValid = false;
+      _alarmLow = _alarmHigh = false;
       _hasSensor = false; // force re-detect
+      return;
     }
-    _phase = IDLE;
+    if (_alarmDirty) applyAlarmRegisters();
+  }
+}
+
+void TempSensor::setAlarmLimits(bool enabled, float minC, float maxC) {
+  if (enabled == _alarmArmed && (!enabled || (minC == _alarmMinC && maxC == _alarmMaxC))) return;
+  _alarmArmed = enabled;
+  _alarmMinC = minC;
+  _alarmMaxC = maxC;
+  if (!enabled) _alarmLow = _alarmHigh = false;
+  _alarmDirty = true;
+  // Never touch the scratchpad mid-conversion
+  if (_phase == IDLE && _hasSensor) applyAlarmRegisters();
+}
+
+void TempSensor::alarmRegisters(uint8_t& th, uint8_t& tl) const {
+  if (!_alarmArmed) {
+    th = 0x7F;  // +127C: never fires
+    tl = 0x80;  // -128C: never fires
+    return;
+  }
+  // The sensor compares whole degrees, floor(T), and fires when that is
+  // <= TL or >= TH. TH = floor(max) fires for every T above max and
+  // TL = ceil(min) - 1 for every T below min, at most a degree early; the
+  // full read that follows decides whether it is a real breach.
+  float lo = ceilf(_alarmMinC - _offset) - 1.0f;
+  float hi = floorf(_alarmMaxC - _offset);
+  lo = constrain(lo, -55.0f, 125.0f);
+  hi = constrain(hi, -55.0f, 125.0f);
+  tl = (uint8_t)(int8_t)lo;
+  th = (uint8_t)(int8_t)hi;
+}
+
+void TempSensor::applyAlarmRegisters() {
+  _alarmDirty = false;
+  uint8_t th, tl;
+  alarmRegisters(th, tl);
+  if (th == _th && tl == _tl) return;
+  _th = th;
+  _tl = tl;
+  writeScratch(_resolution);
+}
+
+bool TempSensor::alarmSearch() {
+  // ALARM SEARCH (0xEC): only devices with the alarm flag set respond
+  uint8_t addr[8];
+  _ow->reset_search();
+  while (_ow->search(addr, false)) {
+    if (memcmp(addr, _addr, sizeof(addr)) == 0) return true;
+  }
+  return false;
+}
+
+bool TempSensor::readSample(float& out) {
+  ScratchPad sp;
+  if (!_dt->isConnected(_addr, sp)) return false;  // reads + checks CRC
+
+  int16_t raw = (int16_t)((sp[1] << 8) | sp[0]);
+  // Low bits are undefined below 12-bit resolution
+  raw &= (int16_t)~((1 << (12 - _resolution)) - 1);
+  float t = raw / 16.0f;
+  if (!(t > -80 && t < 150)) return false;
+  out = t;
+  return true;
+}
+
+void TempSensor::updateFilter(float t, uint32_t nowMs) {
+  if (!_filterValid || nowMs - _sampleMs > MAX_ESTIMATE_AGE_MS) {
+    _estC = t;
+    _slopeCPerSec = 0.0f;
+    _sampleMs = nowMs;
+    _filterValid = true;
+    return;
+  }
+
+  float dt = (nowMs - _sampleMs) / 1000.0f;
+  if (dt <= 0.0f) return;
+
+  float predicted = _estC + _slopeCPerSec * dt;
+  float residual = t - predicted;
+  _estC = predicted + ALPHA * residual;
+  _slopeCPerSec += BETA * residual / dt;
+  _sampleMs = nowMs;
+
+  adaptResolution(residual);
+}
+
+void TempSensor::adaptResolution(float residual) {
+  float slope = fabsf(_slopeCPerSec);
+
+  // Temperature moving: fast 10-bit reads
+  if (slope > FAST_SLOPE_C_PER_SEC || fabsf(residual) > FAST_RESIDUAL_C) {
+    _stableCount = 0;
+    if (_resolution != 10) writeScratch(10);
+    return;
+  }
+
+  // Settled for a while: back to 12-bit
+  if (_resolution != 12 && slope < SLOW_SLOPE_C_PER_SEC) {
+    if (++_stableCount >= SLOW_READINGS) {
+      writeScratch(12);
+      _stableCount = 0;
+    }
+  } else {
+    _stableCount = 0;
   }
 }
+
+float TempSensor::estimateC() const {
+  if (!_hasSensor || !_filterValid) return NAN;
+  uint32_t age = sysClock.nowMs() - _sampleMs;
+  if (age > MAX_ESTIMATE_AGE_MS) return NAN;
+  if (age > MAX_EXTRAPOLATE_MS) age = MAX_EXTRAPOLATE_MS;
+  return _estC + _slopeCPerSec * (age / 1000.0f) + _offset;
+}
+
+uint32_t TempSensor::estimateAgeMs() const {
+  if (!_filterValid) return UINT32_MAX;
+  return sysClock.nowMs() - _sampleMs;
+}
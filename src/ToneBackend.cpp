@@ -0,0 +1,43 @@
+#include "ToneBackend.h"
+
+#if defined(ESP32)
+
+void LedcTone::begin(uint8_t pin, bool activeHigh) {
+  _pin = pin;
+  _activeHigh = activeHigh;
+  pinMode(_pin, OUTPUT);
+  stop();
+}
+
+bool LedcTone::start(uint16_t freqHz, uint8_t dutyPct) {
+  if (freqHz == 0 || dutyPct == 0 || dutyPct >= 100) return false;
+  uint32_t max = (1UL << RES_BITS) - 1;
+  uint32_t duty = max * dutyPct / 100;
+  if (!_activeHigh) duty = max - duty;
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+  if (_attached) ledcDetach(_pin);
+  if (!ledcAttach(_pin, freqHz, RES_BITS)) return false;
+  ledcWrite(_pin, duty);
+#else
+  if (ledcSetup(CHANNEL, freqHz, RES_BITS) == 0) return false;
+  ledcAttachPin(_pin, CHANNEL);
+  ledcWrite(CHANNEL, duty);
+#endif
+  _attached = true;
+  return true;
+}
+
+void LedcTone::stop() {
+  if (_attached) {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    ledcDetach(_pin);
+#else
+    ledcDetachPin(_pin);
+#endif
+    _attached = false;
+    pinMode(_pin, OUTPUT);
+  }
+  digitalWrite(_pin, _activeHigh ? LOW : HIGH);
+}
+
+#endif
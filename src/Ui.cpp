@@ -9,8 +9,7 @@ void Ui::begin() {
 }
 
 void Ui::tick(const UiModel& m) {
-  if (millis() - _lastDraw < UI_FPS_MS) return;
-  _lastDraw = millis();
+  // Called at UI_FPS_MS by the scheduler
   draw(m);
 }
 
@@ -70,6 +69,8 @@ void Ui::draw(const UiModel& m) {
     case Screen::EditBuzzerType: drawEditBuzzerType(m); break;
     case Screen::EditBuzzerActiveHigh: drawEditBuzzerActiveHigh(m); break;
     case Screen::EditTempOffset: drawEditTempOffset(m); break;
+    case Screen::Diagnostics: drawDiagnostics(m); break;
+    case Screen::ResumePrompt: drawResumePrompt(m); break;
   }
 
   _u8g2.sendBuffer();
@@ -95,6 +96,7 @@ void Ui::drawMain(const UiModel& m) {
     snprintf(statusBuf, sizeof(statusBuf), "STOP");
   }
   _u8g2.drawStr(100, 9, statusBuf);
+  if (m.savePending) _u8g2.drawStr(92, 9, "*");
   _u8g2.drawHLine(x, 11, 124);
 
   // BIG STEP INDICATOR - center of screen
@@ -219,28 +221,47 @@ void Ui::drawProfileMenu(const UiModel& m) {
   _u8g2.drawHLine(x, 14, 124);
 
   _u8g2.setFont(u8g2_font_5x8_tf);
-  // Future: will have Default, Custom, Profile1, etc.
-  const char* items[] = {"Custom"};
-  
-  for (int i = 0; i < 1; i++) {
-    int y = 30 + i * 14;
+  char buf[48];
+
+  // Current settings, saved profiles, Save - 4 visible with scrolling
+  const int VISIBLE = 4;
+  int itemCount = 2 + m.profileCount;
+  int scrollOff = 0;
+  if (m.subMenuIdx >= VISIBLE) scrollOff = m.subMenuIdx - VISIBLE + 1;
+
+  for (int v = 0; v < VISIBLE && (v + scrollOff) < itemCount; v++) {
+    int i = v + scrollOff;
+    int y = 24 + v * 10;
     bool sel = (i == m.subMenuIdx);
     if (sel) {
-      _u8g2.drawBox(0, y - 10, 128, 13);
+      _u8g2.drawBox(0, y - 7, 128, 10);
       _u8g2.setDrawColor(0);
     }
-    char buf[24];
-    snprintf(buf, sizeof(buf), "%s >", items[i]);
+
+    if (i == 0) {
+      snprintf(buf, sizeof(buf), "Current settings >");
+    } else if (i <= m.profileCount) {
+      int p = i - 1;
+      int32_t dur = m.profileTotalSec[p];
+      snprintf(buf, sizeof(buf), "%c%-12.12s %2dst %2d:%02d", (p == m.activeProfile) ? '*' : ' ',
+               m.profileNames[p], m.profileStepCounts[p], (int)(dur / 60), (int)(dur % 60));
+    } else {
+      snprintf(buf, sizeof(buf), "+ Save current");
+    }
     _u8g2.drawStr(x, y, buf);
     _u8g2.setDrawColor(1);
   }
-  _u8g2.drawStr(x, 63, "OK:select  BACK:menu");
+
+  if (scrollOff > 0) _u8g2.drawStr(120, 20, "^");
+  if (scrollOff + VISIBLE < itemCount) _u8g2.drawStr(120, 54, "v");
+
+  _u8g2.drawStr(x, 63, "OK:load HOLD:del");
 }
 
 void Ui::drawProfileEditMenu(const UiModel& m) {
   const int x = 2;
   _u8g2.setFont(u8g2_font_6x13_tf);
-  _u8g2.drawStr(x, 12, "CUSTOM PROFILE");
+  _u8g2.drawStr(x, 12, m.profileName[0] ? m.profileName : "CUSTOM PROFILE");
   _u8g2.drawHLine(x, 14, 124);
 
   _u8g2.setFont(u8g2_font_5x8_tf);
@@ -980,6 +1001,31 @@ void Ui::drawHardwareMenu(const UiModel& m) {
   _u8g2.drawStr(x, 63, "OK:select  BACK:exit");
 }
 
+void Ui::drawDiagnostics(const UiModel& m) {
+  const int x = 2;
+  char buf[48];
+  _u8g2.setFont(u8g2_font_5x8_tf);
+  if (m.diagWindowMs == 0) {
+    _u8g2.drawStr(x, 8, "DIAGNOSTICS");
+    _u8g2.drawStr(x, 30, "measuring...");
+    return;
+  }
+  snprintf(buf, sizeof(buf), "LOOP %lu/s", (unsigned long)(m.diagPasses * 1000ULL / m.diagWindowMs));
+  _u8g2.drawStr(x, 8, buf);
+  snprintf(buf, sizeof(buf), "%-7s%5s%5s%5s", "us", "mean", "p99", "max");
+  _u8g2.drawStr(x, 17, buf);
+  _u8g2.drawHLine(x, 19, 124);
+
+  for (int8_t i = 0; i < MenuController::DIAG_ROWS; i++) {
+    int8_t idx = m.diagScroll + i;
+    if (idx >= PS_COUNT) break;
+    snprintf(buf, sizeof(buf), "%-7s%5lu%5lu%5lu", ModuleProfiler::name((ProfSection)idx),
+             (unsigned long)m.diagMeanUs[idx], (unsigned long)m.diagP99Us[idx],
+             (unsigned long)m.diagMaxUs[idx]);
+    _u8g2.drawStr(x, 27 + i * 8, buf);
+  }
+}
+
 void Ui::drawEditStepsPerRev(const UiModel& m) {
   const int x = 2;
   _u8g2.setFont(u8g2_font_6x13_tf);
@@ -1087,3 +1133,26 @@ void Ui::drawEditTempOffset(const UiModel& m) {
   _u8g2.setFont(u8g2_font_5x8_tf);
   _u8g2.drawStr(x, 63, "ENC:+/-0.1  OK:save  BACK:cancel");
 }
+
+// ===== Resume prompt =====
+void Ui::drawResumePrompt(const UiModel& m) {
+  const int x = 2;
+  _u8g2.setFont(u8g2_font_6x13_tf);
+  _u8g2.drawStr(x, 12, "RESUME SESSION?");
+  _u8g2.drawHLine(x, 14, 124);
+
+  _u8g2.setFont(u8g2_font_5x8_tf);
+  char buf[64];
+  if (m.profileName[0]) {
+    _u8g2.drawStr(x, 26, m.profileName);
+  }
+  snprintf(buf, sizeof(buf), "Step %d/%d %s", m.resumeStep + 1, m.stepCount, m.resumeStepName);
+  _u8g2.drawStr(x, 36, buf);
+  snprintf(buf, sizeof(buf), "Done %d:%02d of %d:%02d%s",
+           (int)(m.resumeDoneSec / 60), (int)(m.resumeDoneSec % 60),
+           (int)(m.resumeStepSec / 60), (int)(m.resumeStepSec % 60),
+           m.resumeRunning ? "" : " (paused)");
+  _u8g2.drawStr(x, 46, buf);
+
+  _u8g2.drawStr(x, 63, "OK:resume  BACK:discard");
+}
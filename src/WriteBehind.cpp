@@ -0,0 +1,38 @@
+#include "WriteBehind.h"
+#include "Clock.h"
+
+void WriteBehind::markDirty(uint8_t sections) {
+  if (!sections) return;
+  _dirty |= sections;
+  _lastEditMs = sysClock.nowMs();
+  _stats.edits++;
+}
+
+uint8_t WriteBehind::due(bool menuOpen, bool motorRunning) {
+  if (_menuWasOpen && !menuOpen && _dirty) _leftMenu = true;
+  _menuWasOpen = menuOpen;
+  if (!_dirty) return 0;
+
+  bool quiet = sysClock.nowMs() - _lastEditMs >= QUIET_MS;
+  if (!quiet && !_leftMenu) return 0;
+  if (motorRunning) {
+    // Flash writes stall the step ISR timing - wait for the motor to stop
+    if (!_heldBack) _stats.deferred++;
+    _heldBack = true;
+    return 0;
+  }
+  return _dirty;
+}
+
+void WriteBehind::flushed(uint8_t sections, bool ok) {
+  _heldBack = false;
+  _leftMenu = false;
+  if (!ok) {
+    // Keep them dirty; retry after another quiet period
+    _stats.failed++;
+    _lastEditMs = sysClock.nowMs();
+    return;
+  }
+  _dirty &= ~sections;
+  _stats.flushes++;
+}
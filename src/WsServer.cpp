@@ -0,0 +1,147 @@
+#include "WsServer.h"
+#if defined(ESP32)
+  #include <lwip/sockets.h>
+#endif
+
+size_t WsTransport::writable(uint8_t num) {
+  if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return 0;
+  WSclient_t& c = _clients[num];
+  if (c.status != WSC_CONNECTED || !c.tcp || !c.tcp->connected()) return 0;
+#if defined(ESP32)
+  // No send-buffer query on ESP32: a writable socket takes at least a segment
+  int fd = c.tcp->fd();
+  if (fd < 0) return 0;
+  fd_set wfds;
+  FD_ZERO(&wfds);
+  FD_SET(fd, &wfds);
+  timeval tv = {0, 0};
+  return select(fd + 1, nullptr, &wfds, nullptr, &tv) > 0 ? 1460 : 0;
+#else
+  return c.tcp->availableForWrite();  // free TCP send buffer
+#endif
+}
+
+void WsServer::ringWrite(Queue& q, uint16_t pos, const void* src, uint16_t len) {
+  const uint8_t* p = (const uint8_t*)src;
+  uint16_t first = QUEUE_BYTES - pos;
+  if (first > len) first = len;
+  memcpy(q.buf + pos, p, first);
+  memcpy(q.buf, p + first, len - first);
+}
+
+void WsServer::ringRead(const Queue& q, uint16_t pos, void* dst, uint16_t len) const {
+  uint8_t* p = (uint8_t*)dst;
+  uint16_t first = QUEUE_BYTES - pos;
+  if (first > len) first = len;
+  memcpy(p, q.buf + pos, first);
+  memcpy(p + first, q.buf, len - first);
+}
+
+bool WsServer::queue(uint8_t num, const JsonWriter& w, FrameClass cls) {
+  if (!w.ok()) return false;
+  return push(num, w.length(), cls == FrameClass::Reliable ? REC_RELIABLE : 0);
+}
+
+bool WsServer::queueBin(uint8_t num, size_t len, FrameClass cls) {
+  return push(num, len, REC_BIN | (cls == FrameClass::Reliable ? REC_RELIABLE : 0));
+}
+
+bool WsServer::push(uint8_t num, size_t len, uint8_t flags) {
+  if (num >= MAX_CLIENTS || len == 0 || len > TX_BYTES) return false;
+  Queue& q = _q[num];
+  uint16_t need = sizeof(Record) + len;
+  while (QUEUE_BYTES - q.used < need && dropOldestStatus(q)) {}
+
+  if (QUEUE_BYTES - q.used < need) {
+    if (flags & REC_RELIABLE) {
+      // Full of replies it hasn't read - the client is gone in all but name
+      Serial.printf("Ws: client %u not reading, disconnecting\n", num);
+      _ws.disconnect(num);
+      reset(num);
+      return false;
+    }
+    q.stats.dropped++;
+    q.gap = true;
+    return false;
+  }
+
+  Record r = {(uint16_t)len, flags, 0};
+  uint16_t tail = (q.head + q.used) % QUEUE_BYTES;
+  ringWrite(q, tail, &r, sizeof(r));
+  ringWrite(q, (tail + sizeof(r)) % QUEUE_BYTES, payload(), len);
+  q.used += need;
+  q.stats.frames++;
+  q.stats.bytes = q.used;
+  if (q.used > q.stats.maxBytes) q.stats.maxBytes = q.used;
+  return true;
+}
+
+bool WsServer::dropOldestStatus(Queue& q) {
+  uint16_t off = 0;
+  while (off < q.used) {
+    Record r;
+    ringRead(q, (q.head + off) % QUEUE_BYTES, &r, sizeof(r));
+    uint16_t n = sizeof(r) + r.len;
+    if (!(r.flags & REC_RELIABLE)) {
+      // Slide the (small) reliable records ahead of it up over the gap
+      for (uint16_t i = off; i > 0; i--) {
+        q.buf[(q.head + i - 1 + n) % QUEUE_BYTES] = q.buf[(q.head + i - 1) % QUEUE_BYTES];
+      }
+      q.head = (q.head + n) % QUEUE_BYTES;
+      q.used -= n;
+      q.stats.frames--;
+      q.stats.bytes = q.used;
+      q.stats.dropped++;
+      q.gap = true;
+      return true;
+    }
+    off += n;
+  }
+  return false;
+}
+
+bool WsServer::flushClient(uint8_t num) {
+  Queue& q = _q[num];
+  while (q.used) {
+    Record r;
+    ringRead(q, q.head, &r, sizeof(r));
+    // Whole frame or nothing: a partial write would make the library wait
+    if (_ws.writable(num) < (size_t)r.len + WEBSOCKETS_MAX_HEADER_SIZE) return false;
+
+    ringRead(q, (q.head + sizeof(r)) % QUEUE_BYTES, payload(), r.len);
+    bool ok = (r.flags & REC_BIN) ? _ws.sendBIN(num, _tx, r.len, true)
+                                  : _ws.sendTXT(num, _tx, r.len, true);
+    uint16_t n = sizeof(r) + r.len;
+    q.head = (q.head + n) % QUEUE_BYTES;
+    q.used -= n;
+    q.stats.frames--;
+    q.stats.bytes = q.used;
+    if (ok) q.stats.sent++;
+  }
+  return true;
+}
+
+void WsServer::flush() {
+  // Rotate the starting client so one busy socket can't always go first
+  for (uint8_t k = 0; k < MAX_CLIENTS; k++) {
+    uint8_t num = (_nextFlush + k) % MAX_CLIENTS;
+    if (_q[num].used) flushClient(num);
+  }
+  _nextFlush = (_nextFlush + 1) % MAX_CLIENTS;
+}
+
+void WsServer::reset(uint8_t num) {
+  if (num >= MAX_CLIENTS) return;
+  Queue& q = _q[num];
+  q.head = 0;
+  q.used = 0;
+  q.gap = false;
+  q.stats.frames = 0;
+  q.stats.bytes = 0;
+}
+
+bool WsServer::takeGap(uint8_t num) {
+  if (num >= MAX_CLIENTS || !_q[num].gap) return false;
+  _q[num].gap = false;
+  return true;
+}
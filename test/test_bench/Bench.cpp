@@ -0,0 +1,203 @@
+#include "Bench.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__linux__) && defined(__x86_64__)
+  #include <signal.h>
+  #include <unistd.h>
+  #include <sys/ptrace.h>
+  #include <sys/user.h>
+  #include <sys/wait.h>
+  #define BENCH_TRACE 1
+#endif
+
+namespace {
+
+constexpr int BENCH_REPEATS = 3;
+constexpr const char* MODEL = "lx106-sf1";   // bump when the table below changes
+
+// Rough cycle costs on the LX106 at 80 MHz: libgcc soft-float routines
+// (there is a 32-bit multiplier, no FPU), called from flash-cached code
+constexpr double FP_CYCLES[FP_OPS] = {
+  90, 110, 380, 700, 35, 55,      // float add mul div sqrt cmp cvt
+  160, 330, 1400, 2500, 60, 70    // double
+};
+// One x86-64 instruction does about what 1-2 LX106 instructions do
+// (memory operands, 64-bit arithmetic)
+constexpr double INSTR_CYCLES = 1.5;
+constexpr double ESP_MHZ = 80.0;
+
+const char* const FP_NAMES[FP_OPS] = {
+  "f_add", "f_mul", "f_div", "f_sqrt", "f_cmp", "f_cvt",
+  "d_add", "d_mul", "d_div", "d_sqrt", "d_cmp", "d_cvt"
+};
+
+FILE* s_out = nullptr;
+
+struct TraceCount {
+  uint64_t instr = 0;
+  uint64_t fp[FP_OPS] = {};
+};
+
+#ifdef BENCH_TRACE
+// SSE scalar/packed arithmetic at the start of b (legacy encoding, which is
+// what -O2 without -march emits). Returns the op class and how many lanes,
+// or n = 0 for anything else.
+struct FpHit { FpOp op; uint8_t n; };
+
+FpHit classify(const uint8_t* b) {
+  uint8_t pfx = 0;
+  int i = 0;
+  for (; i < 8; i++) {
+    uint8_t c = b[i];
+    if (c == 0x66 || c == 0xF2 || c == 0xF3) pfx = c;
+    else if (c != 0x2E && c != 0x3E && c != 0x26 && c != 0x36 && c != 0x64 && c != 0x65 &&
+             c != 0x67 && c != 0xF0) break;
+  }
+  if ((b[i] & 0xF0) == 0x40) i++;   // REX
+  if (b[i] != 0x0F) return {FP_ADD, 0};
+
+  // Lanes and precision by prefix: F3 ss, F2 sd, none ps, 66 pd
+  bool dbl = pfx == 0xF2 || pfx == 0x66;
+  uint8_t lanes = pfx == 0 ? 4 : pfx == 0x66 ? 2 : 1;
+  auto hit = [&](FpOp f, FpOp d) { return FpHit{dbl ? d : f, lanes}; };
+
+  switch (b[i + 1]) {
+    case 0x58: case 0x5C: return hit(FP_ADD, DP_ADD);     // add, sub
+    case 0x59: return hit(FP_MUL, DP_MUL);
+    case 0x5E: return hit(FP_DIV, DP_DIV);
+    case 0x51: return hit(FP_SQRT, DP_SQRT);
+    case 0x5D: case 0x5F: case 0xC2: return hit(FP_CMP, DP_CMP);  // min, max, cmp
+    case 0x2E: case 0x2F:                                 // (u)comiss/sd
+      return FpHit{pfx == 0x66 ? DP_CMP : FP_CMP, 1};
+    case 0x2A: case 0x2C: case 0x2D:                      // int <-> scalar
+      if (pfx == 0xF3 || pfx == 0xF2) return hit(FP_CVT, DP_CVT);
+      break;
+    case 0x5A:                                            // float <-> double
+      return FpHit{DP_CVT, (uint8_t)(pfx == 0 || pfx == 0x66 ? 2 : 1)};
+    case 0x5B:                                            // packed int <-> float
+      return FpHit{FP_CVT, 4};
+    case 0xE6:                                            // packed int <-> double
+      if (pfx) return FpHit{DP_CVT, 2};
+      break;
+  }
+  return {FP_ADD, 0};
+}
+
+// Runs op n times in a forked child between two SIGSTOPs and single-steps
+// everything in between
+bool trace(void (*op)(void*, uint32_t), void* ctx, uint32_t n, TraceCount& out) {
+  fflush(stdout);
+  fflush(stderr);
+  if (s_out) fflush(s_out);
+  pid_t pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    if (ptrace(PTRACE_TRACEME, 0, nullptr, nullptr) != 0) _exit(1);
+    raise(SIGSTOP);
+    for (uint32_t i = 0; i < n; i++) op(ctx, i);
+    raise(SIGSTOP);
+    _exit(0);
+  }
+
+  int st = 0;
+  if (waitpid(pid, &st, 0) != pid || !WIFSTOPPED(st)) return false;
+  out = TraceCount{};
+  bool done = false;
+  while (!done) {
+    user_regs_struct regs;
+    if (ptrace(PTRACE_GETREGS, pid, nullptr, &regs) != 0) break;
+    long code[2];
+    code[0] = ptrace(PTRACE_PEEKTEXT, pid, (void*)regs.rip, nullptr);
+    code[1] = ptrace(PTRACE_PEEKTEXT, pid, (void*)(regs.rip + 8), nullptr);
+    FpHit h = classify((const uint8_t*)code);
+    if (h.n) out.fp[h.op] += h.n;
+    else out.instr++;
+
+    if (ptrace(PTRACE_SINGLESTEP, pid, nullptr, nullptr) != 0) break;
+    if (waitpid(pid, &st, 0) != pid || !WIFSTOPPED(st)) break;
+    done = WSTOPSIG(st) == SIGSTOP;   // the end mark
+  }
+  kill(pid, SIGKILL);
+  waitpid(pid, &st, 0);
+  return done;
+}
+#else
+bool trace(void (*)(void*, uint32_t), void*, uint32_t, TraceCount&) { return false; }
+#endif
+
+void nop(void*, uint32_t) {}
+
+// Instructions of the SIGSTOP marks themselves, taken off every trace
+TraceCount s_overhead;
+bool s_traceOk = false;
+
+void emit(const char* line) {
+  printf("BENCH %s\n", line);
+  if (s_out) fprintf(s_out, "%s\n", line);
+}
+
+} // namespace
+
+void benchBegin() {
+  const char* path = getenv("BENCH_OUT");
+  if (path && *path) {
+    s_out = fopen(path, "w");
+    if (!s_out) fprintf(stderr, "bench: cannot write %s\n", path);
+  }
+  s_traceOk = trace(&nop, nullptr, 0, s_overhead);
+  if (!s_traceOk) fprintf(stderr, "bench: no instruction tracing on this host, host timings only\n");
+
+  char line[160];
+  snprintf(line, sizeof(line), "{\"model\":\"%s\",\"compiler\":\"%s\",\"traced\":%s}",
+           MODEL, __VERSION__, s_traceOk ? "true" : "false");
+  emit(line);
+}
+
+void benchEnd() {
+  if (s_out) fclose(s_out);
+  s_out = nullptr;
+}
+
+BenchResult benchRun(const char* name, uint32_t iters, void (*op)(void*, uint32_t), void* ctx,
+                     uint32_t traceIters) {
+  BenchResult r;
+
+  // Counted first, from the same state the timed runs start at
+  TraceCount tc;
+  if (s_traceOk && traceIters && trace(op, ctx, traceIters, tc)) {
+    r.counted = true;
+    r.instr = ((double)tc.instr - (double)s_overhead.instr) / traceIters;
+    r.espCycles = r.instr * INSTR_CYCLES;
+    for (uint8_t k = 0; k < FP_OPS; k++) {
+      r.fp[k] = ((double)tc.fp[k] - (double)s_overhead.fp[k]) / traceIters;
+      r.espCycles += r.fp[k] * FP_CYCLES[k];
+    }
+    r.espUs = r.espCycles / ESP_MHZ;
+  }
+
+  for (int rep = 0; rep < BENCH_REPEATS; rep++) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iters; i++) op(ctx, i);
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iters;
+    if (rep == 0 || ns < r.hostNs) r.hostNs = ns;
+  }
+
+  char line[512];
+  int n = snprintf(line, sizeof(line), "{\"name\":\"%s\",\"iters\":%lu,\"host_ns\":%.1f",
+                   name, (unsigned long)iters, r.hostNs);
+  if (r.counted) {
+    n += snprintf(line + n, sizeof(line) - n, ",\"instr\":%.1f", r.instr);
+    for (uint8_t k = 0; k < FP_OPS; k++) {
+      n += snprintf(line + n, sizeof(line) - n, ",\"%s\":%.2f", FP_NAMES[k], r.fp[k]);
+    }
+    snprintf(line + n, sizeof(line) - n, ",\"esp_cycles\":%.0f,\"esp_us\":%.2f}",
+             r.espCycles, r.espUs);
+  } else {
+    snprintf(line + n, sizeof(line) - n, ",\"instr\":null,\"esp_us\":null}");
+  }
+  emit(line);
+  return r;
+}
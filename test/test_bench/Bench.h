@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+
+// Float operations counted per benchmark. Everything else is "instr".
+enum FpOp : uint8_t {
+  FP_ADD, FP_MUL, FP_DIV, FP_SQRT, FP_CMP, FP_CVT,   // float (FP_CVT: float <-> int)
+  DP_ADD, DP_MUL, DP_DIV, DP_SQRT, DP_CMP, DP_CVT,   // double (DP_CVT incl. float <-> double)
+  FP_OPS
+};
+
+struct BenchResult {
+  double hostNs = 0;        // per op, best of BENCH_REPEATS
+  bool counted = false;     // false = no tracer on this host
+  double instr = 0;         // per op, float operations not included
+  double fp[FP_OPS] = {};   // per op
+  double espCycles = 0;     // cost model, see Bench.cpp
+  double espUs = 0;
+};
+
+// Host micro-benchmarks for the loop hot paths.
+//
+// Each benchmark is timed on the host, then run once more in a forked copy
+// that is single-stepped with ptrace (x86-64 Linux) to count instructions
+// and float/double operations per op. The counts feed a cost model of the
+// ESP8266: it has no FPU, every float operation is a libgcc soft-float
+// call. Counts don't depend on host load, so espUs is the number to compare
+// between commits; host ns are a sanity check.
+//
+// op(ctx, i) is one iteration (i counts from 0 per run) and may change
+// state. Results go to stdout as "BENCH {json}" lines and, when BENCH_OUT
+// names a file, as plain JSON lines to that file.
+void benchBegin();
+void benchEnd();
+BenchResult benchRun(const char* name, uint32_t iters, void (*op)(void*, uint32_t), void* ctx,
+                     uint32_t traceIters = 200);
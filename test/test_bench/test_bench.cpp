@@ -0,0 +1,247 @@
+// Micro-benchmarks of the loop hot paths on the simulated board: the real
+// sources over a realistic profile, timed on the host and costed for the
+// ESP8266 (see Bench.h). Compare runs with scripts/bench_compare.py.
+#include <Arduino.h>
+#include <unity.h>
+#include <memory>
+#include <string.h>
+#include "Sim.h"
+#include "Config.h"
+#include "Clock.h"
+#include "App.h"
+#include "Protocol.h"
+#include "Bench.h"
+
+// App::updateUiModel() is private
+struct AppBench {
+  static void updateUiModel(App& a) { a.updateUiModel(a._inputs); }
+  static SessionController& session(App& a) { return a._session; }
+};
+
+static MotorController motor;
+static SessionController session;
+static MenuController menu;
+static std::unique_ptr<App> app;
+static volatile int32_t sink;
+
+// Develop 6 min (temperature compensated), stop 1, fix 5, wash 15, rinse 3;
+// reverse every 10 s, temperature limits on
+static void loadProfile(SessionSettings& set) {
+  static const struct { const char* name; int sec; int rpm; } STEPS[] = {
+    {"Dev", 360, 30}, {"Stop", 60, 30}, {"Fix", 300, 25}, {"Wash", 900, 20}, {"Rinse", 180, 20}};
+  set.stepCount = 5;
+  for (int8_t i = 0; i < set.stepCount; i++) {
+    set.steps[i].durationSec = STEPS[i].sec;
+    set.steps[i].rpm = STEPS[i].rpm;
+    strlcpy(set.steps[i].name, STEPS[i].name, sizeof(set.steps[i].name));
+  }
+  set.steps[0].tempCoefOverride = true;
+  set.steps[0].tempCoefEnabled = true;
+  set.steps[0].tempCoefPercent = 8.0f;
+  set.steps[0].tempCoefTarget = TempCoefTarget::Both;
+  set.tempCoefEnabled = true;
+  set.tempLimitsEnabled = true;
+  set.reverseEnabled = true;
+  set.reverseIntervalSec = 10.0f;
+}
+
+// Filtered temperature drifting slowly, like TempSensor::estimateC()
+static float tempAt(uint32_t i) {
+  return 21.0f + (float)((i / 500) % 20) * 0.01f;
+}
+
+// Loop passes 5 ms apart; the session is continued at every step end and
+// restarted when it completes, so boundaries are part of the mix
+static void opSessionTick(void*, uint32_t i) {
+  sim::advanceUs(5000);
+  sysClock.tick();
+  session.setCurrentTemp(tempAt(i));
+  if (!session.isRunning()) session.toggleRun();
+  session.tick();
+}
+
+static void opTotalRemaining(void*, uint32_t) { sink += session.totalRemainingSec(); }
+
+static void opAdjustedRpm(void*, uint32_t i) {
+  session.setCurrentTemp(tempAt(i));
+  sink += (int32_t)session.adjustedRpm();
+}
+
+// Ramp, reverse state machine and steps/s -> timer interval
+static void opMotorTick(void*, uint32_t) {
+  sim::advanceUs(5000);
+  sysClock.tick();
+  motor.tick();
+}
+
+// Mostly idle passes; every 64 passes: RPM +1/-1 on the main screen, into
+// the menu, two items down and back up, out again
+static void opMenuInput(void*, uint32_t i) {
+  InputsSnapshot s;
+  switch (i % 64) {
+    case 0: case 24: case 32: s.encDelta = 1; break;
+    case 8: case 40: case 48: s.encDelta = -1; break;
+    case 16: s.encSwPressed = true; break;
+    case 56: s.backPressed = true; break;
+  }
+  sink += menu.handleInput(s);
+}
+
+static Status sampleStatus(uint32_t i) {
+  Status st;
+  st.state = ProcState::Running;
+  st.rpm = 20 + i % 40;
+  st.dirFwd = i & 1;
+  st.tempC = 18.0f + (i % 500) * 0.013f;
+  st.timerActive = true;
+  st.rpmActual = st.rpm - 0.5f;
+  st.step = 2;
+  return st;
+}
+
+static char jbuf[512];
+static uint8_t bbuf[512];
+static PersistentConfig cfg;
+
+static void opStatusJson(void*, uint32_t i) {
+  JsonWriter w(jbuf, sizeof(jbuf));
+  writeStatus(w, sampleStatus(i));
+  sink += w.length();
+}
+
+static void opStatusBin(void*, uint32_t i) {
+  sink += encodeStatus(bbuf, sizeof(bbuf), sampleStatus(i));
+}
+
+static void opConfigJson(void*, uint32_t) {
+  JsonWriter w(jbuf, sizeof(jbuf));
+  writeConfig(w, cfg);
+  sink += w.length();
+}
+
+static void opConfigBin(void*, uint32_t) {
+  sink += encodeConfig(bbuf, sizeof(bbuf), cfg);
+}
+
+// What a subscribed client costs per pass: capture, diff, delta frame
+static void opStatusDelta(void*, uint32_t i) {
+  static StatusValues prev;
+  StatusValues cur;
+  captureStatus(sampleStatus(i / 4), cur);
+  uint32_t fields = changedFields(prev, cur) & groupFields(SG_ALL);
+  prev = cur;
+  JsonWriter w(jbuf, sizeof(jbuf));
+  writeStatusDelta(w, cur, fields, i, false);
+  sink += w.length();
+}
+
+static void opCmdAck(void*, uint32_t i) {
+  JsonWriter w(jbuf, sizeof(jbuf));
+  writeCmdAck(w, i, "start", CmdError::Ok, 850);
+  sink += w.length();
+}
+
+static void opUpdateUiModel(void*, uint32_t) { AppBench::updateUiModel(*app); }
+
+static void tickApp(void* a) { ((App*)a)->tick(); }
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+}
+
+void tearDown(void) {
+  app.reset();
+}
+
+static void startSession() {
+  motor = MotorController();
+  session = SessionController();
+  MotorConfig mcfg;
+  mcfg.stepsPerRev = STEPS_PER_REV;
+  mcfg.microsteps = MICROSTEPS;
+  motor.begin(mcfg);
+  session.begin(&motor);
+  loadProfile(session.settings());
+  session.bumpSettingsVersion();
+  session.toggleRun();
+}
+
+void bench_session(void) {
+  startSession();
+  BenchResult tick = benchRun("session.tick", 100000, &opSessionTick, nullptr);
+  TEST_ASSERT_TRUE(session.inProgress());
+  // Precomputed at step boundaries - no float math left per read
+  BenchResult total = benchRun("session.total_remaining", 1000000, &opTotalRemaining, nullptr);
+  benchRun("session.adjusted_rpm", 1000000, &opAdjustedRpm, nullptr);
+  TEST_ASSERT_TRUE(tick.hostNs > 0);
+  if (total.counted) {
+    for (uint8_t k = 0; k < FP_OPS; k++) TEST_ASSERT_EQUAL_FLOAT(0.0f, (float)total.fp[k]);
+  }
+}
+
+void bench_motor_ramp(void) {
+  MotorConfig mcfg;
+  mcfg.stepsPerRev = STEPS_PER_REV;
+  mcfg.microsteps = MICROSTEPS;
+  mcfg.reverseEverySec = 10.0f;
+  motor = MotorController();
+  motor.begin(mcfg);
+  motor.setTargetRpm(30.0f);
+  motor.setRun(true);
+  benchRun("motor.ramp", 100000, &opMotorTick, nullptr);
+  TEST_ASSERT_TRUE(motor.reversals() > 0);
+}
+
+void bench_menu_input(void) {
+  session = SessionController();
+  session.begin(nullptr);
+  menu = MenuController();
+  menu.begin(&session);
+  benchRun("menu.handle_input", 640000, &opMenuInput, nullptr, 128);
+  // Every script cycle ends where it started
+  TEST_ASSERT_EQUAL((int)Screen::Main, (int)menu.screen());
+  TEST_ASSERT_EQUAL(30, session.settings().targetRpm);
+}
+
+// Same work every call: a short trace is enough
+void bench_protocol(void) {
+  strcpy(cfg.wifi.staSsid, "darkroom");
+  benchRun("protocol.status_json", 500000, &opStatusJson, nullptr, 16);
+  benchRun("protocol.status_bin", 500000, &opStatusBin, nullptr, 16);
+  benchRun("protocol.config_json", 200000, &opConfigJson, nullptr, 16);
+  benchRun("protocol.config_bin", 200000, &opConfigBin, nullptr, 16);
+  benchRun("protocol.status_delta", 500000, &opStatusDelta, nullptr, 16);
+  benchRun("protocol.cmd_ack", 500000, &opCmdAck, nullptr, 16);
+
+  JsonWriter w(jbuf, sizeof(jbuf));
+  writeStatus(w, sampleStatus(0));
+  TEST_ASSERT_TRUE(encodeStatus(bbuf, sizeof(bbuf), sampleStatus(0)) * 5 < w.length());
+}
+
+// Whole firmware booted, a session running on the main screen
+void bench_app_ui_model(void) {
+  app.reset(new App());
+  app->begin();
+  sim::run(1000, 5000, &tickApp, app.get());
+  SessionController& s = AppBench::session(*app);
+  loadProfile(s.settings());
+  s.bumpSettingsVersion();
+  s.toggleRun();
+  sim::run(2000, 5000, &tickApp, app.get());
+  TEST_ASSERT_TRUE(s.isRunning());
+  benchRun("app.update_ui_model", 1000000, &opUpdateUiModel, nullptr);
+}
+
+int main(int argc, char **argv) {
+  benchBegin();
+  UNITY_BEGIN();
+  RUN_TEST(bench_session);
+  RUN_TEST(bench_motor_ramp);
+  RUN_TEST(bench_menu_input);
+  RUN_TEST(bench_protocol);
+  RUN_TEST(bench_app_ui_model);
+  int failures = UNITY_END();
+  benchEnd();
+  return failures;
+}
@@ -0,0 +1,146 @@
+// Buzzer: the tone each alert pattern asks the backend for (frequency, duty,
+// timing), the software fallback, and the active-buzzer and disabled paths.
+#include "Arduino.h"
+#include <unity.h>
+#include "../../src/Clock.cpp"
+#include "Buzzer.h"
+
+// Records what the buzzer asked for
+class MockTone : public ToneBackend {
+public:
+  struct Event {
+    bool start;
+    uint16_t freqHz;
+    uint8_t dutyPct;
+    uint32_t ms;
+  };
+  Event events[32];
+  uint8_t count = 0;
+  bool refuse = false;   // behave like a backend that can't make the tone
+  bool sounding = false;
+
+  void begin(uint8_t, bool) override { count = 0; sounding = false; }
+  bool start(uint16_t freqHz, uint8_t dutyPct) override {
+    if (refuse) return false;
+    log(true, freqHz, dutyPct);
+    sounding = true;
+    return true;
+  }
+  void stop() override {
+    if (sounding) log(false, 0, 0);
+    sounding = false;
+  }
+
+private:
+  void log(bool start, uint16_t f, uint8_t d) {
+    if (count < 32) events[count++] = Event{start, f, d, sysClock.nowMs()};
+  }
+};
+
+static MockTone mock;
+static Buzzer buzzer;
+
+static void runFor(uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    advanceMockMillis(1);
+    sysClock.tick();
+    buzzer.tick();
+  }
+}
+
+static void startBuzzer() {
+  setMockMillis(0);
+  sysClock.tick();
+  mock = MockTone();
+  buzzer = Buzzer();
+  buzzer.setBackend(&mock);
+  Buzzer::Config cfg;
+  cfg.pin = 5;
+  buzzer.begin(cfg);
+  BuzzerSettings s;
+  buzzer.setSettings(s);
+}
+
+void setUp(void) { startBuzzer(); }
+void tearDown(void) {}
+
+void test_step_finished_is_one_short_beep(void) {
+  buzzer.alert(AlertType::StepFinished);
+  runFor(200);
+  TEST_ASSERT_EQUAL_UINT8(2, mock.count);
+  TEST_ASSERT_TRUE(mock.events[0].start);
+  TEST_ASSERT_EQUAL_UINT16(2200, mock.events[0].freqHz);
+  TEST_ASSERT_EQUAL_UINT8(50, mock.events[0].dutyPct);
+  TEST_ASSERT_FALSE(mock.events[1].start);
+  TEST_ASSERT_EQUAL_UINT32(50, mock.events[1].ms - mock.events[0].ms);
+  TEST_ASSERT_FALSE(buzzer.isAlerting());
+}
+
+void test_process_ended_is_three_long_beeps(void) {
+  buzzer.alert(AlertType::ProcessEnded);
+  runFor(2000);
+  TEST_ASSERT_EQUAL_UINT8(6, mock.count);
+  for (uint8_t i = 0; i < 6; i += 2) {
+    TEST_ASSERT_TRUE(mock.events[i].start);
+    TEST_ASSERT_EQUAL_UINT8(50, mock.events[i].dutyPct);
+    TEST_ASSERT_EQUAL_UINT32(300, mock.events[i + 1].ms - mock.events[i].ms);
+    if (i + 2 < 6) TEST_ASSERT_EQUAL_UINT32(100, mock.events[i + 2].ms - mock.events[i + 1].ms);
+  }
+  TEST_ASSERT_FALSE(buzzer.isAlerting());
+}
+
+void test_temp_warning_repeats_with_warning_duty(void) {
+  buzzer.alert(AlertType::TempWarning);
+  runFor(1000);
+  TEST_ASSERT_TRUE(mock.count >= 10);
+  TEST_ASSERT_TRUE(mock.events[0].start);
+  TEST_ASSERT_EQUAL_UINT8(25, mock.events[0].dutyPct);
+  TEST_ASSERT_EQUAL_UINT32(80, mock.events[1].ms - mock.events[0].ms);
+  TEST_ASSERT_TRUE(buzzer.isAlerting());
+  buzzer.stopAlert();
+  TEST_ASSERT_FALSE(mock.sounding);
+}
+
+void test_settings_frequency_reaches_backend(void) {
+  BuzzerSettings s;
+  s.freqHz = 3100;
+  buzzer.setSettings(s);
+  buzzer.testBeep();
+  TEST_ASSERT_EQUAL_UINT16(3100, mock.events[0].freqHz);
+}
+
+void test_disabled_event_is_silent(void) {
+  BuzzerSettings s;
+  s.onStepFinished = false;
+  buzzer.setSettings(s);
+  buzzer.alert(AlertType::StepFinished);
+  runFor(200);
+  TEST_ASSERT_EQUAL_UINT8(0, mock.count);
+}
+
+void test_active_buzzer_bypasses_backend(void) {
+  buzzer.setType(BuzzerType::Active);
+  buzzer.alert(AlertType::ProcessEnded);
+  runFor(2000);
+  TEST_ASSERT_EQUAL_UINT8(0, mock.count);
+}
+
+void test_refused_tone_falls_back_to_software(void) {
+  mock.refuse = true;
+  buzzer.alert(AlertType::StepFinished);
+  runFor(200);
+  TEST_ASSERT_EQUAL_UINT8(0, mock.count);
+  TEST_ASSERT_FALSE(buzzer.isAlerting());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_step_finished_is_one_short_beep);
+  RUN_TEST(test_process_ended_is_three_long_beeps);
+  RUN_TEST(test_temp_warning_repeats_with_warning_duty);
+  RUN_TEST(test_settings_frequency_reaches_backend);
+  RUN_TEST(test_disabled_event_is_silent);
+  RUN_TEST(test_active_buzzer_bypasses_backend);
+  RUN_TEST(test_refused_tone_falls_back_to_software);
+  return UNITY_END();
+}
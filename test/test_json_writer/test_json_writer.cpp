@@ -0,0 +1,232 @@
+// JsonWriter / Protocol: exact output, overflow handling, status deltas,
+// command acks, and no heap use while building status messages.
+#include "Arduino.h"
+#include <unity.h>
+#include <new>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../src/JsonWriter.cpp"
+#include "../../src/Protocol.cpp"
+
+// Count every allocation made by the code under test: C++ new, and on glibc
+// the C allocator too (a library calling malloc never goes through new)
+static unsigned long allocations = 0;
+void* operator new(size_t n) {
+  allocations++;
+  void* p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* malloc(size_t n) { allocations++; return __libc_malloc(n); }
+extern "C" void* calloc(size_t n, size_t size) { allocations++; return __libc_calloc(n, size); }
+extern "C" void* realloc(void* p, size_t n) { allocations++; return __libc_realloc(p, n); }
+#endif
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_status_output(void) {
+  char buf[512];
+  JsonWriter w(buf, sizeof(buf));
+  Status st;
+  st.state = ProcState::Running;
+  st.rpm = 30;
+  st.tempC = 20.25f;
+  writeStatus(w, st);
+  TEST_ASSERT_TRUE(w.ok());
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"type\":\"status\",\"state\":\"running\",\"rpm\":30,\"dir\":\"fwd\",\"rev\":false,"
+      "\"rev_ramp_ms\":350,\"rev_pause_ms\":150,\"start_ramp_ms\":350,\"stop_ramp_ms\":600,"
+      "\"auto_rev_mode\":\"off\",\"auto_rev_interval\":0,\"temp\":20.25}", buf);
+  TEST_ASSERT_EQUAL(strlen(buf), w.length());
+}
+
+void test_values_and_escaping(void) {
+  char buf[128];
+  JsonWriter w(buf, sizeof(buf));
+  w.beginObject();
+  w.field("s", "a\"b\\c\n");
+  w.field("n", -42);
+  w.field("f", -0.5f, 1);
+  w.field("z", -0.001f, 2);
+  w.field("nan", NAN);
+  w.beginObject("o").field("x", 1UL).endObject();
+  w.endObject();
+  TEST_ASSERT_TRUE(w.ok());
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"s\":\"a\\\"b\\\\c\\u000a\",\"n\":-42,\"f\":-0.5,\"z\":0.00,\"nan\":null,\"o\":{\"x\":1}}", buf);
+}
+
+void test_widest_integers(void) {
+  char buf[96];
+  JsonWriter w(buf, sizeof(buf));
+  w.beginObject().field("max", ULONG_MAX).field("min", LONG_MIN).endObject();
+  TEST_ASSERT_TRUE(w.ok());
+  char expect[96];
+  snprintf(expect, sizeof(expect), "{\"max\":%lu,\"min\":%ld}", ULONG_MAX, LONG_MIN);
+  TEST_ASSERT_EQUAL_STRING(expect, buf);
+}
+
+void test_overflow_is_flagged(void) {
+  char buf[24];
+  buf[20] = 'G';  // guard past the writer's capacity
+  JsonWriter w(buf, 20);
+  Status st;
+  writeStatus(w, st);
+  TEST_ASSERT_FALSE(w.ok());
+  TEST_ASSERT_EQUAL(19, w.length());
+  TEST_ASSERT_EQUAL('\0', buf[19]);
+  TEST_ASSERT_EQUAL('G', buf[20]);
+}
+
+void test_status_makes_no_allocations(void) {
+  static char buf[512];
+  PersistentConfig cfg;
+  Status st;
+  unsigned long before = allocations;
+  for (int i = 0; i < 1000; i++) {
+    st.rpm = i;
+    st.tempC = 18.0f + i * 0.01f;
+    JsonWriter w(buf, sizeof(buf));
+    writeStatus(w, st);
+    JsonWriter c(buf, sizeof(buf));
+    writeConfig(c, cfg);
+    StatusValues v;
+    captureStatus(st, v);
+    JsonWriter d(buf, sizeof(buf));
+    writeStatusDelta(d, v, groupFields(SG_ALL), i, false);
+    TEST_ASSERT_TRUE(w.ok() && c.ok() && d.ok());
+  }
+  TEST_ASSERT_EQUAL_UINT32(before, allocations);
+}
+
+void test_status_delta(void) {
+  Status st;
+  st.rpm = 30;
+  st.tempC = 20.5f;
+  StatusValues a, b;
+  captureStatus(st, a);
+  st.tempC = 20.52f;
+  st.rpmActual = 12.34f;
+  captureStatus(st, b);
+
+  uint32_t changed = changedFields(b, a);
+  TEST_ASSERT_EQUAL_UINT32((1UL << SF_TEMP) | (1UL << SF_RPM_ACTUAL), changed);
+
+  // A temp-only subscriber sees just the temperature
+  char buf[256];
+  JsonWriter w(buf, sizeof(buf));
+  writeStatusDelta(w, b, changed & groupFields(SG_TEMP), 7, false);
+  TEST_ASSERT_EQUAL_STRING("{\"type\":\"delta\",\"seq\":7,\"key\":false,\"temp\":20.52}", buf);
+
+  JsonWriter k(buf, sizeof(buf));
+  writeStatusDelta(k, b, groupFields(SG_MOTOR), 8, true);
+  TEST_ASSERT_EQUAL_STRING("{\"type\":\"delta\",\"seq\":8,\"key\":true,\"state\":\"idle\","
+                           "\"rpm\":30,\"rpm_actual\":12.3,\"dir\":\"fwd\",\"rev\":false}", buf);
+  TEST_ASSERT_EQUAL(SG_ALARMS, statusGroupFromStr("alarms"));
+  TEST_ASSERT_EQUAL(0, statusGroupFromStr("bogus"));
+}
+
+void test_command_ack(void) {
+  CmdType t = CmdType::Unknown;
+  TEST_ASSERT_TRUE(cmdTypeFromStr("edit_step", t));
+  TEST_ASSERT_EQUAL((int)CmdType::EditStep, (int)t);
+  TEST_ASSERT_FALSE(cmdTypeFromStr("unknown", t));
+
+  char buf[128];
+  JsonWriter w(buf, sizeof(buf));
+  writeCmdAck(w, 42, cmdTypeToStr(CmdType::SetRpm), CmdError::Ok, 850);
+  TEST_ASSERT_EQUAL_STRING("{\"type\":\"ack\",\"id\":42,\"cmd\":\"set_rpm\",\"ok\":true,"
+                           "\"latency_us\":850}", buf);
+  JsonWriter e(buf, sizeof(buf));
+  writeCmdAck(e, 3, cmdTypeToStr(CmdType::Next), CmdError::NotAllowed, 12);
+  TEST_ASSERT_EQUAL_STRING("{\"type\":\"ack\",\"id\":3,\"cmd\":\"next\",\"ok\":false,"
+                           "\"err\":\"not_allowed\",\"latency_us\":12}", buf);
+
+  CommandQueue q;
+  Command c;
+  for (uint8_t i = 0; i < CommandQueue::DEPTH; i++) {
+    c.id = i;
+    TEST_ASSERT_TRUE(q.push(c));
+  }
+  TEST_ASSERT_FALSE(q.push(c));
+  TEST_ASSERT_TRUE(q.pop(c));
+  TEST_ASSERT_EQUAL_UINT32(0, c.id);
+}
+
+void test_bin_status_fields(void) {
+  uint8_t buf[sizeof(BinStatus)];
+  Status st;
+  st.state = ProcState::Running;
+  st.rpm = 23;
+  st.timerActive = true;
+  st.tempC = -1.256f;
+  st.tempAlarm = true;
+  TEST_ASSERT_EQUAL(sizeof(buf), encodeStatus(buf, sizeof(buf), st));
+  TEST_ASSERT_EQUAL(0, encodeStatus(buf, sizeof(buf) - 1, st));
+
+  BinStatus frame;
+  memcpy(&frame, buf, sizeof(frame));
+  TEST_ASSERT_EQUAL(BIN_MSG_STATUS, frame.type);
+  TEST_ASSERT_EQUAL(BIN_VERSION, frame.version);
+  TEST_ASSERT_EQUAL((uint8_t)ProcState::Running, frame.state);
+  TEST_ASSERT_EQUAL(BS_DIR_FWD | BS_TIMER_ACTIVE | BS_TEMP_ALARM, frame.flags);
+  TEST_ASSERT_EQUAL(23, frame.rpm);
+  TEST_ASSERT_EQUAL(-126, frame.tempCenti);
+
+  st.tempC = NAN;
+  encodeStatus(buf, sizeof(buf), st);
+  memcpy(&frame, buf, sizeof(frame));
+  TEST_ASSERT_EQUAL(BIN_TEMP_NONE, frame.tempCenti);
+}
+
+void test_bin_status_delta(void) {
+  Status st;
+  st.state = ProcState::Running;
+  st.stepRemainingSec = 70000;
+  st.tempC = NAN;
+  StatusValues vals;
+  captureStatus(st, vals);
+  uint32_t fields = (1UL << SF_STATE) | (1UL << SF_STEP_LEFT) | (1UL << SF_TEMP);
+  uint8_t buf[32];
+  size_t n = encodeStatusDelta(buf, sizeof(buf), vals, fields, 7, true);
+  TEST_ASSERT_EQUAL(sizeof(BinDelta) + 1 + 4 + 2, n);
+  TEST_ASSERT_EQUAL(0, encodeStatusDelta(buf, n - 1, vals, fields, 7, true));
+
+  BinDelta h;
+  memcpy(&h, buf, sizeof(h));
+  TEST_ASSERT_EQUAL(BIN_MSG_DELTA, h.type);
+  TEST_ASSERT_EQUAL(BD_KEY, h.flags);
+  TEST_ASSERT_EQUAL(7, h.seq);
+  TEST_ASSERT_EQUAL(fields, h.fields);
+  const uint8_t* p = buf + sizeof(h);
+  TEST_ASSERT_EQUAL((uint8_t)ProcState::Running, p[0]);
+  int32_t left;
+  memcpy(&left, p + 1, 4);
+  TEST_ASSERT_EQUAL(70000, left);
+  int16_t temp;
+  memcpy(&temp, p + 5, 2);
+  TEST_ASSERT_EQUAL(BIN_TEMP_NONE, temp);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_status_output);
+  RUN_TEST(test_values_and_escaping);
+  RUN_TEST(test_widest_integers);
+  RUN_TEST(test_overflow_is_flagged);
+  RUN_TEST(test_status_makes_no_allocations);
+  RUN_TEST(test_status_delta);
+  RUN_TEST(test_command_ack);
+  RUN_TEST(test_bin_status_fields);
+  RUN_TEST(test_bin_status_delta);
+  return UNITY_END();
+}
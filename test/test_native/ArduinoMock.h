@@ -7,6 +7,7 @@
 
 // Arduino types
 typedef uint8_t byte;
+using std::isnan;
 
 // Mock millis() - controllable for testing
 static uint32_t _mockMillis = 0;
@@ -16,6 +17,7 @@ inline void advanceMockMillis(uint32_t ms) { _mockMillis += ms; }
 
 // Mock micros()
 inline uint32_t micros() { return _mockMillis * 1000; }
+inline uint64_t micros64() { return (uint64_t)_mockMillis * 1000; }
 
 // Serial mock
 struct SerialMock {
@@ -0,0 +1,100 @@
+// Scheduler: motion first every pass, periodic cadence, slack tasks held
+// back after a slow task and forced once past their deadline, miss/overrun
+// accounting. Task cost is simulated by advancing the mock clock (the host
+// cycle counter runs at 1 per us).
+#include "Arduino.h"
+#include <unity.h>
+#include <string.h>
+struct Print { void println(const char*) {} };
+#include "../../src/Clock.cpp"
+#include "../../src/ModuleProfiler.cpp"
+#include "../../src/Scheduler.cpp"
+
+static ModuleProfiler prof;
+static Scheduler sched;
+static char order[64];
+static uint8_t orderLen;
+static uint32_t uiCostMs;
+
+struct Probe {
+  char tag;
+  uint32_t costMs;
+};
+static Probe motion{'M', 0}, temp{'T', 0}, ui{'U', 0}, net{'N', 0};
+
+static void run(void* ctx) {
+  Probe* p = (Probe*)ctx;
+  if (orderLen < sizeof(order) - 1) order[orderLen++] = p->tag;
+  order[orderLen] = '\0';
+  advanceMockMillis(p == &ui ? uiCostMs : p->costMs);
+}
+
+static void pass() {
+  sysClock.tick();
+  sched.runPass();
+  advanceMockMillis(1);
+}
+
+void setUp(void) {
+  setMockMillis(1000);
+  sysClock.tick();
+  prof = ModuleProfiler();
+  sched = Scheduler();
+  prof.begin();
+  sched.begin(&prof, 4000);
+  // Registered out of order on purpose: priority decides, then registration
+  sched.add(PS_UI, run, &ui, TaskPrio::Slack, 50000, 30000, 50000);
+  sched.add(PS_NET, run, &net, TaskPrio::Slack, 0, 3000, 50000);
+  sched.add(PS_TEMP, run, &temp, TaskPrio::Normal, 10000, 1000, 10000);
+  sched.add(PS_SESSION, run, &motion, TaskPrio::Motion, 0, 500, 20000);
+  orderLen = 0;
+  order[0] = '\0';
+  uiCostMs = 0;
+}
+void tearDown(void) {}
+
+void test_priority_order(void) {
+  pass();
+  TEST_ASSERT_EQUAL_STRING("MTUN", order);
+}
+
+void test_periodic_cadence(void) {
+  for (int i = 0; i < 100; i++) pass();   // 100 ms at 1 ms per pass
+  TEST_ASSERT_EQUAL_UINT32(100, sched.stats(PS_SESSION).runs);
+  TEST_ASSERT_EQUAL_UINT32(10, sched.stats(PS_TEMP).runs);
+  TEST_ASSERT_EQUAL_UINT32(2, sched.stats(PS_UI).runs);
+  TEST_ASSERT_EQUAL_UINT32(0, sched.stats(PS_TEMP).misses);
+  TEST_ASSERT_TRUE(sched.idlePasses() >= 85);
+}
+
+void test_slow_slack_task_defers_the_next(void) {
+  uiCostMs = 25;
+  pass();
+  // The frame push used the pass: network waits for the next one
+  TEST_ASSERT_EQUAL_STRING("MTU", order);
+  TEST_ASSERT_EQUAL_UINT32(1, sched.stats(PS_NET).deferred);
+  TEST_ASSERT_EQUAL_UINT32(0, sched.stats(PS_UI).overruns);
+  pass();
+  TEST_ASSERT_EQUAL_STRING("MTUMTN", order);
+}
+
+void test_overdue_slack_task_runs_anyway(void) {
+  motion.costMs = 5;   // every pass is over the cut-off before slack tasks
+  for (int i = 0; i < 20; i++) pass();
+  const Scheduler::TaskStats& n = sched.stats(PS_NET);
+  TEST_ASSERT_TRUE(n.deferred > 0);
+  TEST_ASSERT_TRUE(n.runs > 0);
+  TEST_ASSERT_TRUE(n.misses > 0);
+  TEST_ASSERT_EQUAL_UINT32(20, sched.stats(PS_SESSION).runs);
+  TEST_ASSERT_EQUAL_UINT32(20, sched.stats(PS_SESSION).overruns);
+  motion.costMs = 0;
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_priority_order);
+  RUN_TEST(test_periodic_cadence);
+  RUN_TEST(test_slow_slack_task_defers_the_next);
+  RUN_TEST(test_overdue_slack_task_runs_anyway);
+  return UNITY_END();
+}
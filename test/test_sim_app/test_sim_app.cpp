@@ -0,0 +1,221 @@
+// Whole firmware on the simulated board: App::begin() against the in-memory
+// flash, a profile sent over the WebSocket like the web UI does, then run
+// to the end on virtual time
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include <memory>
+#include "Sim.h"
+#include "App.h"
+#include "Protocol.h"
+
+static std::unique_ptr<App> app;
+
+static void tickApp(void* a) { ((App*)a)->tick(); }
+
+// Loop passes 5 ms apart - the rate the ESP8266 manages with the UI drawing
+static void runMs(uint32_t ms) { sim::run(ms, 5000, &tickApp, app.get()); }
+
+static void boot() {
+  app.reset(new App());
+  app->begin();
+  runMs(1000);
+}
+
+static bool sentContains(uint8_t num, const char* text) {
+  for (const std::string& f : sim::wsSent(num)) {
+    if (f.find(text) != std::string::npos) return true;
+  }
+  return false;
+}
+
+static void send(const char* json) {
+  sim::wsReceive(0, json);
+  runMs(50);
+}
+
+static void connectClient() {
+  sim::wsConnect(0);
+  runMs(50);
+  send("{\"type\":\"hello\",\"enc\":\"json\"}");
+  TEST_ASSERT_TRUE(sentContains(0, "\"type\":\"hello\""));
+}
+
+// Develop 6 min, stop 1, fix 5, wash 15, rinse 3: 30 minutes
+static void loadDevelopmentProfile() {
+  static const struct { const char* name; int sec; int rpm; } STEPS[] = {
+    {"Dev", 360, 30}, {"Stop", 60, 30}, {"Fix", 300, 25}, {"Wash", 900, 20}, {"Rinse", 180, 20}};
+  char buf[128];
+  for (int i = 0; i < 5; i++) {
+    snprintf(buf, sizeof(buf),
+             "{\"type\":\"cmd\",\"cmd\":\"edit_step\",\"id\":%d,\"step\":%d,\"duration\":%d,\"rpm\":%d,\"name\":\"%s\"}",
+             10 + i, i, STEPS[i].sec, STEPS[i].rpm, STEPS[i].name);
+    send(buf);
+  }
+}
+
+void setUp(void) {
+  sim::reset();
+}
+
+void tearDown(void) {
+  app.reset();
+}
+
+void test_boot_draws_the_status_screen(void) {
+  boot();
+  TEST_ASSERT_GREATER_THAN(10, sim::frames());
+  TEST_ASSERT_TRUE(sim::screenText().find("DIY JOBO") != std::string::npos);
+  TEST_ASSERT_TRUE(sim::serialOutput().find("ProfileStore:") != std::string::npos);
+}
+
+void test_console_answers(void) {
+  boot();
+  sim::clearSerialOutput();
+  sim::serialInput("sched\n");
+  runMs(100);
+  TEST_ASSERT_TRUE(sim::serialOutput().find("session") != std::string::npos);
+}
+
+void test_full_profile_over_websocket(void) {
+  boot();
+  connectClient();
+  loadDevelopmentProfile();
+  TEST_ASSERT_FALSE(sentContains(0, "\"ok\":false"));
+
+  auto t0 = std::chrono::steady_clock::now();
+  send("{\"type\":\"cmd\",\"cmd\":\"start\",\"id\":1}");
+  // Every step ends in a pause; continue like the user would
+  for (int i = 0; i < 4; i++) {
+    uint32_t before = sim::frames();
+    runMs(i == 0 ? 360000 : i == 1 ? 60000 : i == 2 ? 300000 : 900000);
+    TEST_ASSERT_GREATER_THAN(before, sim::frames());
+    send("{\"type\":\"cmd\",\"cmd\":\"start\",\"id\":2}");
+  }
+  runMs(181000);
+  double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+  sim::clearSerialOutput();
+  sim::serialInput("hist\n");
+  runMs(100);
+  std::string out = sim::serialOutput();
+  TEST_ASSERT_TRUE(out.find("1 sessions archived") != std::string::npos);
+  TEST_ASSERT_TRUE(out.find("5 steps") != std::string::npos);
+  TEST_ASSERT_TRUE(out.find("done") != std::string::npos);
+  TEST_ASSERT_TRUE(sentContains(0, "\"cmd\":\"start\",\"ok\":true"));
+  TEST_ASSERT_FALSE(sentContains(0, "\"ok\":false"));
+
+  char msg[64];
+  snprintf(msg, sizeof(msg), "30 min profile simulated in %.0f ms", wallMs);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN(1000.0, wallMs);
+}
+
+void test_step_arguments_are_checked(void) {
+  boot();
+  connectClient();
+  // Boot default is one step: index 1 appends
+  send("{\"type\":\"cmd\",\"cmd\":\"edit_step\",\"id\":5,\"step\":1,\"rpm\":40}");
+  TEST_ASSERT_TRUE(sentContains(0, "\"id\":5,\"cmd\":\"edit_step\",\"ok\":false"));
+  send("{\"type\":\"cmd\",\"cmd\":\"edit_step\",\"id\":6,\"step\":1,\"duration\":60}");
+  TEST_ASSERT_TRUE(sentContains(0, "\"id\":6,\"cmd\":\"edit_step\",\"ok\":true"));
+  // 257 must not wrap around to step 1
+  send("{\"type\":\"cmd\",\"cmd\":\"edit_step\",\"id\":7,\"step\":257,\"duration\":90}");
+  TEST_ASSERT_TRUE(sentContains(0, "\"id\":7,\"cmd\":\"edit_step\",\"ok\":false,\"err\":\"bad_args\""));
+  send("{\"type\":\"cmd\",\"cmd\":\"load_profile\",\"id\":8,\"index\":-255}");
+  TEST_ASSERT_TRUE(sentContains(0, "\"id\":8,\"cmd\":\"load_profile\",\"ok\":false,\"err\":\"bad_args\""));
+}
+
+// "rpm" of the newest full status frame, -1 if none
+static int lastStatusRpm() {
+  std::vector<std::string>& sent = sim::wsSent(0);
+  for (auto it = sent.rbegin(); it != sent.rend(); ++it) {
+    if (it->find("\"type\":\"status\"") == std::string::npos) continue;
+    size_t p = it->find("\"rpm\":");
+    if (p != std::string::npos) return atoi(it->c_str() + p + 6);
+  }
+  return -1;
+}
+
+void test_set_rpm_lasts_for_the_running_step(void) {
+  boot();
+  connectClient();
+  loadDevelopmentProfile();
+  send("{\"type\":\"cmd\",\"cmd\":\"start\",\"id\":1}");
+  send("{\"type\":\"cmd\",\"cmd\":\"set_rpm\",\"id\":2,\"rpm\":45}");
+  runMs(2000);
+  TEST_ASSERT_EQUAL(45, lastStatusRpm());
+
+  // Next step: back to the profile
+  runMs(360000);
+  send("{\"type\":\"cmd\",\"cmd\":\"start\",\"id\":3}");
+  runMs(2000);
+  TEST_ASSERT_EQUAL(30, lastStatusRpm());
+
+  // The step table kept its RPM: a fresh session starts at 30 again
+  send("{\"type\":\"cmd\",\"cmd\":\"stop\",\"id\":4}");
+  send("{\"type\":\"cmd\",\"cmd\":\"start\",\"id\":5}");
+  runMs(2000);
+  TEST_ASSERT_EQUAL(30, lastStatusRpm());
+  TEST_ASSERT_FALSE(sentContains(0, "\"ok\":false"));
+}
+
+void test_binary_client_gets_timer_deltas(void) {
+  boot();
+  sim::wsConnect(0);
+  runMs(50);
+  send("{\"type\":\"hello\",\"enc\":\"bin\"}");
+  loadDevelopmentProfile();
+  send("{\"type\":\"sub\",\"groups\":[\"timer\"],\"max_hz\":2}");
+  send("{\"type\":\"cmd\",\"cmd\":\"start\",\"id\":1}");
+  sim::wsSentBin(0).clear();
+  runMs(5000);
+
+  // Seconds tick: step_left and total_left change, nothing else
+  const uint32_t TICK = (1UL << SF_STEP_LEFT) | (1UL << SF_TOTAL_LEFT);
+  int32_t prev = -1;
+  int ticks = 0;
+  for (const std::string& f : sim::wsSentBin(0)) {
+    TEST_ASSERT_TRUE(f.size() >= sizeof(BinDelta));
+    BinDelta h;
+    memcpy(&h, f.data(), sizeof(h));
+    TEST_ASSERT_EQUAL(BIN_MSG_DELTA, h.type);
+    TEST_ASSERT_EQUAL(0, h.fields & ~groupFields(SG_TIMER));
+    if (h.flags & BD_KEY || h.fields != TICK) continue;
+    TEST_ASSERT_EQUAL(sizeof(BinDelta) + 8, f.size());
+    int32_t left;
+    memcpy(&left, f.data() + sizeof(BinDelta), sizeof(left));
+    if (prev >= 0) TEST_ASSERT_LESS_THAN(prev, left);
+    prev = left;
+    ticks++;
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(3, ticks);
+  TEST_ASSERT_LESS_THAN(360, prev);
+}
+
+void test_reboot_mid_session_offers_resume(void) {
+  boot();
+  connectClient();
+  loadDevelopmentProfile();
+  send("{\"type\":\"cmd\",\"cmd\":\"start\",\"id\":1}");
+  runMs(120000);
+
+  // Watchdog reset: flash and RTC memory survive, everything else restarts
+  app.reset();
+  sim::reset(true);
+  boot();
+  TEST_ASSERT_TRUE(sim::screenText().find("RESUME SESSION?") != std::string::npos);
+  TEST_ASSERT_TRUE(sim::screenText().find("Step 1/5") != std::string::npos);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_draws_the_status_screen);
+  RUN_TEST(test_console_answers);
+  RUN_TEST(test_full_profile_over_websocket);
+  RUN_TEST(test_step_arguments_are_checked);
+  RUN_TEST(test_set_rpm_lasts_for_the_running_step);
+  RUN_TEST(test_binary_client_gets_timer_deltas);
+  RUN_TEST(test_reboot_mid_session_offers_resume);
+  return UNITY_END();
+}
@@ -0,0 +1,177 @@
+// Session history on the in-memory flash: the index left behind by a reset
+// in the middle of a write
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+#include <string.h>
+#include <vector>
+#include "Sim.h"
+#include "Clock.h"
+#include "SessionArchive.h"
+
+static const char* IDX = "/sessions.idx";
+static const char* LOG = "/sessions.log";
+static constexpr size_t IDX_HEADER = 12;
+
+static uint32_t appendSession(SessionArchive& a, const char* name) {
+  SessionSummary s;
+  strlcpy(s.profileName, name, sizeof(s.profileName));
+  s.stepCount = 1;
+  s.stepsDone = 1;
+  return a.append(s);
+}
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+}
+
+void tearDown(void) {}
+
+void test_torn_entry_is_cut_off(void) {
+  {
+    SessionArchive a;
+    TEST_ASSERT_TRUE(a.begin());
+    appendSession(a, "One");
+    appendSession(a, "Two");
+  }
+  // Reset halfway through the next index append
+  File f = LittleFS.open(IDX, "a");
+  f.write((const uint8_t*)"\x03\0\0\0torn", 8);
+  f.close();
+
+  SessionArchive a;
+  TEST_ASSERT_TRUE(a.begin());
+  TEST_ASSERT_EQUAL(2, a.count());
+  TEST_ASSERT_EQUAL(IDX_HEADER + 2 * sizeof(ArchiveEntry), sim::fsSize(IDX));
+  TEST_ASSERT_EQUAL(3, appendSession(a, "Three"));
+
+  SessionSummary s;
+  TEST_ASSERT_TRUE(a.fetch(3, s));
+  TEST_ASSERT_EQUAL_STRING("Three", s.profileName);
+  ArchiveEntry list[4];
+  TEST_ASSERT_EQUAL(3, a.listRecent(list, 4));
+  TEST_ASSERT_EQUAL(3, list[0].id);
+  TEST_ASSERT_EQUAL_STRING("Three", list[0].name);
+  TEST_ASSERT_EQUAL(1, list[2].id);
+}
+
+void test_damaged_row_is_left_out_of_the_list(void) {
+  SessionArchive a;
+  TEST_ASSERT_TRUE(a.begin());
+  appendSession(a, "One");
+  appendSession(a, "Two");
+  appendSession(a, "Three");
+
+  uint32_t bad = 99;
+  File f = LittleFS.open(IDX, "r+");
+  f.seek(IDX_HEADER + sizeof(ArchiveEntry));
+  f.write((const uint8_t*)&bad, sizeof(bad));
+  f.close();
+
+  ArchiveEntry list[4];
+  TEST_ASSERT_EQUAL(2, a.listRecent(list, 4));
+  TEST_ASSERT_EQUAL(3, list[0].id);
+  TEST_ASSERT_EQUAL(1, list[1].id);
+  SessionSummary s;
+  TEST_ASSERT_FALSE(a.fetch(2, s));
+  TEST_ASSERT_TRUE(a.fetch(1, s));
+}
+
+static void appendThree() {
+  SessionArchive a;
+  TEST_ASSERT_TRUE(a.begin());
+  appendSession(a, "One");
+  appendSession(a, "Two");
+  appendSession(a, "Three");
+}
+
+void test_lost_index_is_rebuilt_from_the_log(void) {
+  appendThree();
+  size_t logBytes = sim::fsSize(LOG);
+  // Damaged header, and a record cut short at the end of the log
+  File f = LittleFS.open(IDX, "r+");
+  f.write((const uint8_t*)"XXXX", 4);
+  f.close();
+  f = LittleFS.open(LOG, "a");
+  f.write((const uint8_t*)"JBSR", 4);
+  f.close();
+
+  SessionArchive a;
+  TEST_ASSERT_TRUE(a.begin());
+  TEST_ASSERT_EQUAL(3, a.count());
+  TEST_ASSERT_EQUAL(logBytes + 4, sim::fsSize(LOG));
+  SessionSummary s;
+  TEST_ASSERT_TRUE(a.fetch(2, s));
+  TEST_ASSERT_EQUAL_STRING("Two", s.profileName);
+
+  // The next record lands after the torn one and is still found
+  TEST_ASSERT_EQUAL(4, appendSession(a, "Four"));
+  TEST_ASSERT_TRUE(LittleFS.remove(IDX));
+  SessionArchive again;
+  TEST_ASSERT_TRUE(again.begin());
+  TEST_ASSERT_EQUAL(4, again.count());
+  TEST_ASSERT_TRUE(again.fetch(4, s));
+  TEST_ASSERT_EQUAL_STRING("Four", s.profileName);
+}
+
+void test_rebuild_keeps_the_retried_record(void) {
+  appendThree();
+  size_t idxBytes = sim::fsSize(IDX);
+  {
+    SessionArchive a;
+    TEST_ASSERT_TRUE(a.begin());
+    appendSession(a, "Lost");
+  }
+  // Reset before the index append: id 4 is only in the log
+  File f = LittleFS.open(IDX, "r");
+  std::vector<uint8_t> keep(idxBytes);
+  f.read(keep.data(), idxBytes);
+  f.close();
+  f = LittleFS.open(IDX, "w");
+  f.write(keep.data(), idxBytes);
+  f.close();
+  {
+    SessionArchive a;
+    TEST_ASSERT_TRUE(a.begin());
+    uint32_t id = appendSession(a, "Four");
+    TEST_ASSERT_EQUAL(4, id);
+  }
+
+  TEST_ASSERT_TRUE(LittleFS.remove(IDX));
+  SessionArchive a;
+  TEST_ASSERT_TRUE(a.begin());
+  TEST_ASSERT_EQUAL(4, a.count());
+  SessionSummary s;
+  TEST_ASSERT_TRUE(a.fetch(4, s));
+  TEST_ASSERT_EQUAL_STRING("Four", s.profileName);
+}
+
+void test_reset_during_roll_over_is_finished_at_boot(void) {
+  appendThree();
+  // rollOver() moved the index, then the reset came
+  TEST_ASSERT_TRUE(LittleFS.rename(IDX, "/sessions.old.idx"));
+
+  SessionArchive a;
+  TEST_ASSERT_TRUE(a.begin());
+  TEST_ASSERT_EQUAL(3, a.count());
+  TEST_ASSERT_TRUE(sim::fsExists("/sessions.old.log"));
+  SessionSummary s;
+  TEST_ASSERT_TRUE(a.fetch(3, s));
+  TEST_ASSERT_EQUAL_STRING("Three", s.profileName);
+  TEST_ASSERT_EQUAL(4, appendSession(a, "Four"));
+  ArchiveEntry list[8];
+  TEST_ASSERT_EQUAL(4, a.listRecent(list, 8));
+  TEST_ASSERT_EQUAL(4, list[0].id);
+  TEST_ASSERT_EQUAL(3, list[1].id);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_torn_entry_is_cut_off);
+  RUN_TEST(test_damaged_row_is_left_out_of_the_list);
+  RUN_TEST(test_lost_index_is_rebuilt_from_the_log);
+  RUN_TEST(test_rebuild_keeps_the_retried_record);
+  RUN_TEST(test_reset_during_roll_over_is_finished_at_boot);
+  return UNITY_END();
+}
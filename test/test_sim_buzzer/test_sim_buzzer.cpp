@@ -0,0 +1,60 @@
+// Buzzer on the simulated ESP8266: the duty the passive buzzer pin actually
+// shows, with the target's default backend
+#include <Arduino.h>
+#include <unity.h>
+#include "Sim.h"
+#include "Clock.h"
+#include "Buzzer.h"
+
+static constexpr uint8_t PIN = 3;
+static Buzzer buzzer;
+
+// Loop passes 20 us apart: fine enough for the software tone to keep pitch
+static void runUs(uint32_t us) {
+  for (uint32_t t = 0; t < us; t += 20) {
+    sim::advanceUs(20);
+    sysClock.tick();
+    buzzer.tick();
+  }
+}
+
+// Share of the window the pin was HIGH, in percent
+static float dutyOver(uint32_t us) {
+  uint64_t before = sim::pinHighUs(PIN);
+  runUs(us);
+  return (sim::pinHighUs(PIN) - before) * 100.0f / us;
+}
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+  buzzer = Buzzer();
+  Buzzer::Config cfg;
+  cfg.pin = PIN;
+  buzzer.begin(cfg);
+  buzzer.setSettings(BuzzerSettings());
+}
+
+void tearDown(void) {}
+
+void test_beep_has_the_configured_duty(void) {
+  buzzer.alert(AlertType::StepFinished);
+  runUs(100);   // first tick switches the tone on
+  TEST_ASSERT_FLOAT_WITHIN(5.0f, 50.0f, dutyOver(40000));
+  runUs(20000);
+  TEST_ASSERT_FALSE(buzzer.isAlerting());
+  TEST_ASSERT_EQUAL(LOW, sim::pinOut(PIN));
+}
+
+void test_warning_has_the_thinner_duty(void) {
+  buzzer.alert(AlertType::TempWarning);
+  runUs(100);
+  TEST_ASSERT_FLOAT_WITHIN(5.0f, 25.0f, dutyOver(70000));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_beep_has_the_configured_duty);
+  RUN_TEST(test_warning_has_the_thinner_duty);
+  return UNITY_END();
+}
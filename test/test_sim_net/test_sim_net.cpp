@@ -0,0 +1,102 @@
+// NetService on the simulated board: what parsing a client message costs the
+// heap, with the real ArduinoJson
+#include <Arduino.h>
+#include <unity.h>
+#include <new>
+#include <stdlib.h>
+#include <string>
+#include "Sim.h"
+#include "Clock.h"
+#include "NetService.h"
+
+// Count every allocation while counting is on: C++ new, and on glibc the C
+// allocator too - ArduinoJson allocates with malloc, which new never sees
+static bool counting = false;
+static unsigned long allocations = 0;
+void* operator new(size_t n) {
+  if (counting) allocations++;
+  void* p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* malloc(size_t n) { if (counting) allocations++; return __libc_malloc(n); }
+extern "C" void* calloc(size_t n, size_t size) { if (counting) allocations++; return __libc_calloc(n, size); }
+extern "C" void* realloc(void* p, size_t n) { if (counting) allocations++; return __libc_realloc(p, n); }
+#endif
+
+static NetService* net;
+static uint32_t commands = 0;
+
+// One service pass with the heap watched, then take the commands off the
+// queue like App does (unanswered: the acks would fill the stalled socket)
+static unsigned long serviceCounted() {
+  sim::advanceUs(5000);
+  sysClock.tick();
+  allocations = 0;
+  counting = true;
+  net->service(100000);
+  Command c;
+  while (net->popCommand(c)) commands++;
+  counting = false;
+  return allocations;
+}
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+  net = new NetService();
+  net->begin(WifiConfig(), nullptr);
+  sim::wsConnect(0);
+  sim::setWsWritable(0, 0);  // replies stay queued; only the receive path runs
+  for (int i = 0; i < 20; i++) serviceCounted();
+  commands = 0;
+}
+
+void tearDown(void) {
+  delete net;
+}
+
+void test_commands_are_parsed_without_the_heap(void) {
+  static const char* const MSGS[] = {
+    "{\"type\":\"cmd\",\"cmd\":\"set_rpm\",\"id\":1,\"rpm\":40}",
+    "{\"type\":\"cmd\",\"cmd\":\"edit_step\",\"id\":2,\"step\":3,\"duration\":300,\"rpm\":25,\"name\":\"Fix\"}",
+    "{\"type\":\"cmd\",\"cmd\":\"load_profile\",\"id\":3,\"index\":1,\"extra\":[1,2,{\"x\":\"skipped\"}]}",
+  };
+  unsigned long total = 0;
+  for (int i = 0; i < 30; i++) {
+    sim::wsReceive(0, MSGS[i % 3]);  // the sim's own queue may allocate
+    total += serviceCounted();
+  }
+  TEST_ASSERT_EQUAL(30, commands);
+  TEST_ASSERT_EQUAL_UINT32(0, total);
+}
+
+void test_oversized_message_is_dropped(void) {
+  std::string big = "{\"type\":\"cmd\",\"cmd\":\"edit_step\",\"id\":1,\"step\":0,\"name\":\"";
+  big.append(8000, 'x');
+  big += "\"}";
+  sim::clearSerialOutput();
+  sim::wsReceive(0, big.c_str());
+  unsigned long n = serviceCounted();
+  TEST_ASSERT_EQUAL_UINT32(0, n);
+  TEST_ASSERT_EQUAL(0, commands);
+  TEST_ASSERT_TRUE(sim::serialOutput().find("too large") != std::string::npos);
+
+  // The pool is whole again for the next one
+  sim::wsReceive(0, "{\"type\":\"cmd\",\"cmd\":\"stop\",\"id\":2}");
+  serviceCounted();
+  TEST_ASSERT_EQUAL(1, commands);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_commands_are_parsed_without_the_heap);
+  RUN_TEST(test_oversized_message_is_dropped);
+  return UNITY_END();
+}
@@ -0,0 +1,176 @@
+// Profile library on the in-memory flash: what counts as a changed profile,
+// and an index that no longer matches the slot files
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+#include <string.h>
+#include <vector>
+#include "Sim.h"
+#include "Clock.h"
+#include "Crc32.h"
+#include "ProfileStore.h"
+
+static SessionSettings twoSteps(const char* name) {
+  SessionSettings set;
+  strlcpy(set.profileName, name, sizeof(set.profileName));
+  set.stepCount = 2;
+  set.steps[0].durationSec = 360;
+  strlcpy(set.steps[0].name, "Dev", sizeof(set.steps[0].name));
+  set.steps[1].durationSec = 300;
+  strlcpy(set.steps[1].name, "Fix", sizeof(set.steps[1].name));
+  return set;
+}
+
+static const char* INDEX = "/profiles.idx";
+static constexpr size_t HEADER = 12;       // magic, version, size, CRC32
+static constexpr size_t ENTRY = 26;        // name, slot, steps, duration, CRC32
+
+static std::vector<uint8_t> readAll(const char* path) {
+  File f = LittleFS.open(path, "r");
+  std::vector<uint8_t> data(f.size());
+  f.read(data.data(), data.size());
+  f.close();
+  return data;
+}
+
+static void writeAll(const char* path, const std::vector<uint8_t>& data) {
+  File f = LittleFS.open(path, "w");
+  f.write(data.data(), data.size());
+  f.close();
+}
+
+// Three profiles in slots 0-2, then a fresh store as after a reset
+static void saveThree() {
+  ProfileStore store;
+  TEST_ASSERT_TRUE(store.begin());
+  TEST_ASSERT_EQUAL(0, store.save(twoSteps("C-41")));
+  TEST_ASSERT_EQUAL(1, store.save(twoSteps("E-6")));
+  TEST_ASSERT_EQUAL(2, store.save(twoSteps("B&W")));
+}
+
+// Sets one entry's slot and seals the index again, so only the contents
+// are wrong
+static void setIndexSlot(uint8_t entry, uint8_t slot) {
+  std::vector<uint8_t> idx = readAll(INDEX);
+  idx[HEADER + entry * ENTRY + PROFILE_NAME_LEN] = slot;
+  uint32_t crc = crc32(idx.data() + HEADER, idx.size() - HEADER);
+  memcpy(idx.data() + 8, &crc, sizeof(crc));
+  writeAll(INDEX, idx);
+}
+
+static void assertAllLoad(ProfileStore& store, uint8_t count) {
+  TEST_ASSERT_EQUAL(count, store.count());
+  for (uint8_t i = 0; i < count; i++) {
+    SessionSettings set;
+    TEST_ASSERT_TRUE(store.load(i, set));
+    TEST_ASSERT_EQUAL_STRING(store.header(i).name, set.profileName);
+  }
+}
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+}
+
+void tearDown(void) {}
+
+void test_record_crc_sees_only_saved_fields(void) {
+  SessionSettings a = twoSteps("C-41");
+  SessionSettings same;
+  memset(&same, 0xA5, sizeof(same));  // padding and spare bytes differ
+  same = a;
+  same.steps[5].durationSec = 99;     // past stepCount
+  strlcpy(same.profileName, "C-41 long name", sizeof(same.profileName));
+  strlcpy(same.profileName, "C-41", sizeof(same.profileName));  // old tail stays
+  TEST_ASSERT_EQUAL_HEX32(ProfileStore::recordCrc(a), ProfileStore::recordCrc(same));
+
+  SessionSettings edited = a;
+  edited.steps[1].rpm = 25;
+  TEST_ASSERT_NOT_EQUAL(ProfileStore::recordCrc(a), ProfileStore::recordCrc(edited));
+}
+
+void test_record_crc_matches_the_saved_file(void) {
+  ProfileStore store;
+  TEST_ASSERT_TRUE(store.begin());
+  SessionSettings set = twoSteps("E-6");
+  uint32_t crc = 0;
+  TEST_ASSERT_TRUE(store.saveFile("/snap.bin", set, &crc));
+  TEST_ASSERT_EQUAL_HEX32(crc, ProfileStore::recordCrc(set));
+}
+
+void test_duplicate_or_bad_slot_rebuilds_the_index(void) {
+  saveThree();
+  setIndexSlot(1, 0);
+  ProfileStore store;
+  TEST_ASSERT_TRUE(store.begin());
+  assertAllLoad(store, 3);
+
+  setIndexSlot(2, 200);
+  ProfileStore again;
+  TEST_ASSERT_TRUE(again.begin());
+  assertAllLoad(again, 3);
+}
+
+void test_missing_or_unlisted_slot_file_rebuilds_the_index(void) {
+  saveThree();
+  // Reset after remove() deleted the file, before the index write
+  TEST_ASSERT_TRUE(LittleFS.remove("/profile1.bin"));
+  ProfileStore store;
+  TEST_ASSERT_TRUE(store.begin());
+  assertAllLoad(store, 2);
+
+  // Reset after save() wrote a new slot, before the index write
+  std::vector<uint8_t> idx = readAll(INDEX);
+  TEST_ASSERT_EQUAL(2, store.save(twoSteps("New")));
+  writeAll(INDEX, idx);
+  ProfileStore again;
+  TEST_ASSERT_TRUE(again.begin());
+  assertAllLoad(again, 3);
+}
+
+void test_stale_entry_is_rebuilt_on_load(void) {
+  saveThree();
+  std::vector<uint8_t> idx = readAll(INDEX);
+  {
+    ProfileStore store;
+    TEST_ASSERT_TRUE(store.begin());
+    SessionSettings set = twoSteps("C-41 push");
+    set.steps[0].durationSec = 480;
+    TEST_ASSERT_EQUAL(0, store.save(set, 0));
+  }
+  writeAll(INDEX, idx);  // the overwrite made it, the index did not
+
+  ProfileStore store;
+  TEST_ASSERT_TRUE(store.begin());
+  SessionSettings set;
+  TEST_ASSERT_FALSE(store.load(0, set));
+  TEST_ASSERT_EQUAL(3, store.count());
+  TEST_ASSERT_EQUAL_STRING("C-41 push", store.header(0).name);
+  TEST_ASSERT_TRUE(store.load(0, set));
+  TEST_ASSERT_EQUAL(480, set.steps[0].durationSec);
+}
+
+void test_failed_remove_keeps_the_entry(void) {
+  saveThree();
+  ProfileStore store;
+  TEST_ASSERT_TRUE(store.begin());
+  sim::setFsReadOnly(true);
+  TEST_ASSERT_FALSE(store.remove(1));
+  sim::setFsReadOnly(false);
+  assertAllLoad(store, 3);
+  TEST_ASSERT_EQUAL_STRING("E-6", store.header(1).name);
+
+  TEST_ASSERT_TRUE(store.remove(1));
+  assertAllLoad(store, 2);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_record_crc_sees_only_saved_fields);
+  RUN_TEST(test_record_crc_matches_the_saved_file);
+  RUN_TEST(test_duplicate_or_bad_slot_rebuilds_the_index);
+  RUN_TEST(test_missing_or_unlisted_slot_file_rebuilds_the_index);
+  RUN_TEST(test_stale_entry_is_rebuilt_on_load);
+  RUN_TEST(test_failed_remove_keeps_the_entry);
+  return UNITY_END();
+}
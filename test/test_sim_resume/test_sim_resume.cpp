@@ -0,0 +1,137 @@
+// Power-loss resume on the simulated board: settings edited in the middle of
+// a step must survive a reset, without going past the flash write budget
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+#include "Sim.h"
+#include "Config.h"
+#include "Clock.h"
+#include "StepperISR.h"
+#include "SessionController.h"
+#include "ProfileStore.h"
+#include "ResumeJournal.h"
+
+static MotorController motor;
+static SessionController session;
+static ProfileStore store;
+static ResumeJournal journal;
+
+static void runMs(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += 10) {
+    sim::advanceMs(10);
+    sysClock.tick();
+    session.tick();
+    journal.tick(session, true);
+  }
+}
+
+static void boot() {
+  stepperISR.begin(PIN_STEP, PIN_DIR);
+  motor = MotorController();
+  session = SessionController();
+  journal = ResumeJournal();
+  MotorConfig mcfg;
+  mcfg.stepsPerRev = STEPS_PER_REV;
+  mcfg.microsteps = MICROSTEPS;
+  mcfg.reverseEnabled = false;
+  motor.begin(mcfg);
+  session.begin(&motor);
+  TEST_ASSERT_TRUE(store.begin());
+}
+
+static void editFirstStep(int32_t sec) {
+  session.settings().steps[0].durationSec = sec;
+  session.bumpSettingsVersion();
+}
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+  boot();
+  SessionSettings s;
+  TEST_ASSERT_FALSE(journal.begin(&store, s));
+  auto& set = session.settings();
+  set.reverseEnabled = false;
+  set.stepCount = 2;
+  set.steps[0].durationSec = 600;
+  set.steps[1].durationSec = 60;
+  session.bumpSettingsVersion();
+  session.start();
+}
+
+void tearDown(void) {}
+
+void test_mid_step_edit_survives_a_reset(void) {
+  runMs(20000);
+  editFirstStep(900);
+  runMs(10000);
+
+  sim::reset(true);
+  boot();
+  SessionSettings s;
+  TEST_ASSERT_TRUE(journal.begin(&store, s));
+  TEST_ASSERT_EQUAL(900, s.steps[0].durationSec);
+  TEST_ASSERT_EQUAL(0, journal.pending().step);
+  TEST_ASSERT_GREATER_THAN(25000000, (uint32_t)journal.pending().devUs);
+}
+
+void test_reset_before_the_new_checkpoint(void) {
+  runMs(20000);
+  JournalRecord old;
+  File f = LittleFS.open("/resume.bin", "r");
+  f.read((uint8_t*)&old, sizeof(old));
+  f.close();
+  editFirstStep(900);
+  runMs(10000);
+  // The new snapshot is written, the checkpoint naming it is not
+  f = LittleFS.open("/resume.bin", "w");
+  f.write((const uint8_t*)&old, sizeof(old));
+  f.close();
+
+  sim::reset(true);
+  boot();
+  SessionSettings s;
+  TEST_ASSERT_TRUE(journal.begin(&store, s));
+  TEST_ASSERT_EQUAL(900, s.steps[0].durationSec);
+  TEST_ASSERT_GREATER_THAN(25000000, (uint32_t)journal.pending().devUs);
+}
+
+void test_edits_are_settled_before_writing(void) {
+  runMs(10000);
+  uint16_t before = journal.flashWrites();
+  // A knob turned for a while: one snapshot after the last change
+  for (int i = 0; i < 20; i++) {
+    editFirstStep(600 + i * 10);
+    runMs(500);
+  }
+  runMs(10000);
+  TEST_ASSERT_EQUAL(before + 2, journal.flashWrites());
+}
+
+void test_edits_stay_within_the_write_budget(void) {
+  runMs(10000);
+  for (int i = 0; i < 30; i++) {
+    editFirstStep(700 + i * 10);
+    runMs(6000);
+  }
+  uint16_t midStep = journal.flashWrites();
+  // Past the budget the snapshot waits for the step boundary
+  TEST_ASSERT_LESS_OR_EQUAL(2 * MAX_STEPS + 1 - 2, midStep);
+  // Each step ends in a pause; continue like the user would
+  for (int i = 0; i < 1200 && session.inProgress(); i++) {
+    runMs(1000);
+    if (session.isPaused()) session.toggleRun();
+  }
+  TEST_ASSERT_FALSE(session.inProgress());
+  uint16_t total = journal.flashWrites();
+  TEST_ASSERT_LESS_OR_EQUAL(2 * MAX_STEPS + 1, total);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_mid_step_edit_survives_a_reset);
+  RUN_TEST(test_reset_before_the_new_checkpoint);
+  RUN_TEST(test_edits_are_settled_before_writing);
+  RUN_TEST(test_edits_stay_within_the_write_budget);
+  return UNITY_END();
+}
@@ -0,0 +1,149 @@
+// The real SessionController and MotorController on the simulated board:
+// virtual time, step pulses from the timer1 ISR on the STEP pin
+#include <Arduino.h>
+#include <unity.h>
+#include "Sim.h"
+#include "Config.h"
+#include "Clock.h"
+#include "StepperISR.h"
+#include "SessionController.h"
+
+static MotorController motor;
+static SessionController session;
+
+static void pass() {
+  sysClock.tick();
+  session.tick();
+}
+
+// Loop passes every passMs for ms of virtual time
+static void runMs(uint32_t ms, uint32_t passMs = 10) {
+  for (uint32_t t = 0; t < ms; t += passMs) {
+    sim::advanceMs(passMs);
+    pass();
+  }
+}
+
+static void twoSteps(int32_t firstSec, int32_t secondSec) {
+  auto& set = session.settings();
+  set.reverseEnabled = false;
+  set.stepCount = 2;
+  set.steps[0].durationSec = firstSec;
+  set.steps[1].durationSec = secondSec;
+  session.bumpSettingsVersion();
+}
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+  stepperISR.begin(PIN_STEP, PIN_DIR);
+  motor = MotorController();
+  session = SessionController();
+  MotorConfig mcfg;
+  mcfg.stepsPerRev = STEPS_PER_REV;
+  mcfg.microsteps = MICROSTEPS;
+  mcfg.reverseEnabled = false;
+  motor.begin(mcfg);
+  session.begin(&motor);
+}
+
+void tearDown(void) {}
+
+void test_initial_state(void) {
+  TEST_ASSERT_FALSE(session.isRunning());
+  TEST_ASSERT_FALSE(session.isPaused());
+  TEST_ASSERT_FALSE(session.inProgress());
+  TEST_ASSERT_EQUAL(0, session.currentStep());
+}
+
+void test_pause_mid_step_keeps_the_step(void) {
+  twoSteps(60, 60);
+  session.toggleRun();
+  runMs(5000);
+  session.toggleRun();
+  pass();
+  TEST_ASSERT_FALSE(session.isRunning());
+  TEST_ASSERT_FALSE(session.isPaused());   // mid-step pause, not the end-of-step one
+  TEST_ASSERT_TRUE(session.inProgress());
+  TEST_ASSERT_EQUAL(55, session.stepRemainingSec());
+
+  // Time doesn't count while paused
+  runMs(20000);
+  TEST_ASSERT_EQUAL(55, session.stepRemainingSec());
+}
+
+void test_step_end_waits_then_next_step(void) {
+  twoSteps(10, 20);
+  session.toggleRun();
+  runMs(9900);
+  TEST_ASSERT_TRUE(session.isRunning());
+  runMs(200);
+  TEST_ASSERT_FALSE(session.isRunning());
+  TEST_ASSERT_TRUE(session.isPaused());
+  TEST_ASSERT_EQUAL(0, session.currentStep());
+
+  session.toggleRun();  // continue
+  pass();
+  TEST_ASSERT_TRUE(session.isRunning());
+  TEST_ASSERT_EQUAL(1, session.currentStep());
+  TEST_ASSERT_EQUAL(20, session.totalRemainingSec());
+}
+
+void test_last_step_ends_session(void) {
+  twoSteps(10, 5);
+  session.toggleRun();
+  runMs(10100);
+  session.toggleRun();
+  runMs(5100);
+  TEST_ASSERT_FALSE(session.isRunning());
+  TEST_ASSERT_FALSE(session.isPaused());
+  TEST_ASSERT_FALSE(session.inProgress());
+}
+
+void test_stop_resets_state(void) {
+  twoSteps(10, 20);
+  session.toggleRun();
+  runMs(5000);
+  session.stop();
+  pass();
+  TEST_ASSERT_FALSE(session.isRunning());
+  TEST_ASSERT_FALSE(session.isPaused());
+  TEST_ASSERT_EQUAL(0, session.currentStep());
+}
+
+void test_motor_ramps_and_steps_at_target_rate(void) {
+  twoSteps(60, 60);
+  session.settings().steps[0].rpm = 30;
+  session.toggleRun();
+  runMs(2000);  // well past the ramp
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 30.0f, motor.currentRpm());
+
+  // 30 rpm at 3200 steps/rev = 1600 pulses per second on the STEP pin
+  uint32_t before = sim::pinRises(PIN_STEP);
+  runMs(10000);
+  uint32_t pulses = sim::pinRises(PIN_STEP) - before;
+  TEST_ASSERT_UINT32_WITHIN(160, 16000, pulses);
+}
+
+void test_motor_stops_pulsing_when_paused(void) {
+  twoSteps(60, 60);
+  session.toggleRun();
+  runMs(2000);
+  session.toggleRun();
+  runMs(2000);  // stop ramp
+  uint32_t before = sim::pinRises(PIN_STEP);
+  runMs(5000);
+  TEST_ASSERT_EQUAL_UINT32(before, sim::pinRises(PIN_STEP));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_initial_state);
+  RUN_TEST(test_pause_mid_step_keeps_the_step);
+  RUN_TEST(test_step_end_waits_then_next_step);
+  RUN_TEST(test_last_step_ends_session);
+  RUN_TEST(test_stop_resets_state);
+  RUN_TEST(test_motor_ramps_and_steps_at_target_rate);
+  RUN_TEST(test_motor_stops_pulsing_when_paused);
+  return UNITY_END();
+}
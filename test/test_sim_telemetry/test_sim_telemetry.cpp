@@ -0,0 +1,109 @@
+// Session recorder on virtual time: sample schedule and CSV export
+#include <Arduino.h>
+#include <unity.h>
+#include <string>
+#include "Sim.h"
+#include "Clock.h"
+#include "TelemetryRecorder.h"
+#include "HttpServer.h"
+
+static TelemetryRecorder rec;
+
+// Collects what exportCsv prints
+class StringPrint : public Print {
+public:
+  using Print::write;
+  std::string text;
+  size_t write(uint8_t c) override { text += (char)c; return 1; }
+};
+
+static void at(uint32_t ms) {
+  sim::advanceUs((uint64_t)ms * 1000 - sim::nowUs());
+  sysClock.tick();
+}
+
+static void sample(float tempC) {
+  TelemetrySample s;
+  s.tempC = tempC;
+  s.rpmTarget = 30.0f;
+  s.rpmActual = 30.0f;
+  TEST_ASSERT_TRUE(rec.due());
+  rec.record(s);
+}
+
+static std::string csv() {
+  StringPrint out;
+  TelemetryCursor c;
+  while (!rec.exportCsv(out, c, 4)) {}
+  return out.text;
+}
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+  rec = TelemetryRecorder();
+  rec.setPeriodMs(2000);
+  rec.start();
+}
+
+void tearDown(void) {}
+
+void test_samples_are_stamped_on_the_period(void) {
+  sample(20.0f);
+  at(2000);
+  sample(20.5f);
+  at(4100);   // a little late: still the nominal time
+  sample(21.0f);
+  std::string out = csv();
+  TEST_ASSERT_TRUE(out.find("\n0,1,20.00,") != std::string::npos);
+  TEST_ASSERT_TRUE(out.find("\n2000,1,20.50,") != std::string::npos);
+  TEST_ASSERT_TRUE(out.find("\n4000,1,21.00,") != std::string::npos);
+}
+
+void test_stall_resyncs_to_the_real_time(void) {
+  sample(20.0f);
+  at(2000);
+  sample(20.0f);
+  at(9000);   // loop stalled for several periods
+  sample(21.0f);
+  TEST_ASSERT_FALSE(rec.due());
+  at(11000);
+  sample(21.5f);
+  std::string out = csv();
+  TEST_ASSERT_TRUE(out.find("\n9000,1,21.00,") != std::string::npos);
+  TEST_ASSERT_TRUE(out.find("\n11000,1,21.50,") != std::string::npos);
+  TEST_ASSERT_EQUAL(4, rec.sampleCount());
+}
+
+void test_csv_is_served_over_http(void) {
+  for (uint32_t i = 0; i < 200; i++) {
+    at(i * 2000);
+    sample(20.0f + i * 0.01f);
+  }
+  HttpServer http(80);
+  http.setTelemetry(&rec);
+  http.begin();
+  sim::httpRequest("GET /telemetry.csv HTTP/1.1\r\nHost: diy-jobo.local\r\n\r\n");
+  int passes = 0;
+  do {
+    http.service();
+    passes++;
+  } while (sim::httpOpen() && passes < 1000);
+  TEST_ASSERT_FALSE(sim::httpOpen());
+  TEST_ASSERT_TRUE(passes > 10);   // streamed, not written in one go
+
+  const std::string& resp = sim::httpResponse();
+  TEST_ASSERT_EQUAL(0, resp.find("HTTP/1.1 200 OK\r\n"));
+  TEST_ASSERT_TRUE(resp.find("Content-Type: text/csv\r\n") != std::string::npos);
+  size_t body = resp.find("\r\n\r\n");
+  TEST_ASSERT_TRUE(body != std::string::npos);
+  TEST_ASSERT_EQUAL_STRING(csv().c_str(), resp.c_str() + body + 4);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_samples_are_stamped_on_the_period);
+  RUN_TEST(test_stall_resyncs_to_the_real_time);
+  RUN_TEST(test_csv_is_served_over_http);
+  return UNITY_END();
+}
@@ -0,0 +1,87 @@
+// DS18B20 alarm registers on the simulated sensor: an alarm search that stays
+// quiet inside the limits, and breaches that still get a full read
+#include <Arduino.h>
+#include <unity.h>
+#include "Sim.h"
+#include "Clock.h"
+#include "Config.h"
+#include "TempSensor.h"
+
+static TempSensor sensor;
+
+static void runMs(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += 10) {
+    sim::advanceMs(10);
+    sysClock.tick();
+    sensor.tick();
+  }
+}
+
+// Full scratchpad reads over the window; at 12 bit there is a conversion a
+// second, and a quiet alarm search skips two reads in three
+static uint32_t fullReadsIn(uint32_t ms) {
+  uint32_t reads = sensor.fullReads();
+  runMs(ms);
+  return sensor.fullReads() - reads;
+}
+
+static void settleAt(float c, float minC, float maxC, float offset = 0.0f) {
+  sim::setTempC(c);
+  sensor = TempSensor();
+  sensor.begin(PIN_DS18B20);
+  sensor.setOffset(offset);
+  sensor.setAlarmLimits(true, minC, maxC);
+  runMs(20000);
+  TEST_ASSERT_EQUAL(12, sensor.resolution());
+}
+
+void setUp(void) {
+  sim::reset();
+  sysClock.tick();
+}
+
+void tearDown(void) {}
+
+void test_no_alarm_just_below_the_high_limit(void) {
+  settleAt(24.5f, 20.0f, 25.0f);
+  uint32_t reads = fullReadsIn(30000);
+  TEST_ASSERT_LESS_OR_EQUAL(12, reads);
+  TEST_ASSERT_FALSE(sensor.alarmHigh());
+}
+
+void test_no_alarm_just_above_the_low_limit(void) {
+  settleAt(20.5f, 20.0f, 25.0f);
+  uint32_t reads = fullReadsIn(30000);
+  TEST_ASSERT_LESS_OR_EQUAL(12, reads);
+  TEST_ASSERT_FALSE(sensor.alarmLow());
+}
+
+void test_breaches_are_read_at_once(void) {
+  settleAt(22.0f, 20.0f, 25.0f);
+  sim::setTempC(25.25f);
+  runMs(2000);
+  TEST_ASSERT_TRUE(sensor.alarmHigh());
+  sim::setTempC(19.75f);
+  runMs(2000);
+  TEST_ASSERT_FALSE(sensor.alarmHigh());
+  TEST_ASSERT_TRUE(sensor.alarmLow());
+}
+
+void test_fractional_limits_with_offset(void) {
+  // Raw limits 20.0 .. 24.8: TL 19, TH 24
+  settleAt(23.5f, 20.5f, 25.3f, 0.5f);
+  uint32_t reads = fullReadsIn(30000);
+  TEST_ASSERT_LESS_OR_EQUAL(12, reads);
+  sim::setTempC(24.9f);
+  runMs(2000);
+  TEST_ASSERT_TRUE(sensor.alarmHigh());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_no_alarm_just_below_the_high_limit);
+  RUN_TEST(test_no_alarm_just_above_the_low_limit);
+  RUN_TEST(test_breaches_are_read_at_once);
+  RUN_TEST(test_fractional_limits_with_offset);
+  return UNITY_END();
+}
@@ -0,0 +1,60 @@
+// Status via field-group deltas, control via the command channel
+(function () {
+  const $ = (id) => document.getElementById(id);
+  const view = {};
+  let ws = null;
+  let nextId = 1;
+
+  const fmtTime = (s) => s < 0 ? '-' : Math.floor(s / 60) + ':' + String(s % 60).padStart(2, '0');
+
+  function render() {
+    $('state').textContent = view.state ?? '-';
+    $('rpm').textContent = view.rpm_actual != null ? view.rpm_actual.toFixed(1) : '-';
+    $('temp').textContent = view.temp != null ? view.temp.toFixed(2) + ' °C' : '-';
+    $('step').textContent = view.steps ? (view.step + 1) + ' / ' + view.steps : '-';
+    $('step_left').textContent = view.step_left != null ? fmtTime(view.step_left) : '-';
+    $('total_left').textContent = view.total_left != null ? fmtTime(view.total_left) : '-';
+    $('alarm').hidden = !view.temp_alarm;
+  }
+
+  function send(obj) {
+    if (ws && ws.readyState === WebSocket.OPEN) ws.send(JSON.stringify(obj));
+  }
+
+  function command(cmd, args) {
+    send(Object.assign({ type: 'cmd', id: nextId++, cmd }, args || {}));
+  }
+
+  function connect() {
+    ws = new WebSocket('ws://' + location.hostname + ':81/');
+    ws.onopen = () => {
+      $('conn').textContent = 'online';
+      $('conn').className = 'up';
+      send({ type: 'sub', groups: ['motor', 'timer', 'temp', 'alarms'], max_hz: 2 });
+    };
+    ws.onclose = () => {
+      $('conn').textContent = 'offline';
+      $('conn').className = '';
+      setTimeout(connect, 2000);
+    };
+    ws.onmessage = (ev) => {
+      if (typeof ev.data !== 'string') return;
+      const m = JSON.parse(ev.data);
+      if (m.type === 'delta') {
+        Object.assign(view, m);
+        render();
+      } else if (m.type === 'ack') {
+        $('msg').textContent = m.cmd + (m.ok ? ' ok' : ' refused: ' + m.err) + ' (' + m.latency_us + ' us)';
+      }
+    };
+  }
+
+  document.querySelectorAll('[data-cmd]').forEach((b) => {
+    b.onclick = () => command(b.dataset.cmd);
+  });
+  $('rpmForm').onsubmit = (e) => {
+    e.preventDefault();
+    command('set_rpm', { rpm: parseInt($('rpmIn').value, 10) });
+  };
+  connect();
+})();